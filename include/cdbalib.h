@@ -51,7 +51,13 @@ typedef double db_flt;
 #define CDBA_TYPE_INT   ((db_int)1)      /**< integer number type */
 #define CDBA_TYPE_FLOAT ((db_int)2)      /**< floating point number type */
 #define CDBA_TYPE_TEXT  ((db_int)3)      /**< text type */
-//#define CDBA_TYPE_BLOB  ((db_int)4)      /**< binary large object type type */
+#define CDBA_TYPE_BLOB  ((db_int)4)      /**< binary large object type */
+/*! @} */
+
+/*! \brief length value indicating text is zero-terminated
+ * \sa     cdba_prep_bind_text()
+ */
+#define CDBA_NTS ((size_t)-1)
 
 
 
@@ -63,6 +69,14 @@ typedef double db_flt;
 typedef struct cdba_library_handle_struct* cdba_library_handle;
 
 /*! \brief initialize library (must be called once at the beginning of the program)
+ * \details Can be called more than once and from any thread, the database client library is initialized
+ *          by the first call and cleaned up when the last library handle is passed to cdba_library_cleanup().
+ *          Threading model: a library handle can be shared by all threads, a database handle and its
+ *          prepared statements must only be used by one thread at a time (use one connection per thread
+ *          or a connection pool instead of sharing a connection between threads).
+ *          For SQLite3 the nomutex=1 setting opens connections without the SQLite3 connection mutexes.
+ *          Threads other than the one that called cdba_library_initialize() should call cdba_library_thread_init()
+ *          before and cdba_library_thread_end() after using the library.
  * \return database library handle on success or NULL on error
  * \sa     cdba_library_cleanup()
  * \sa     cdba_open()
@@ -75,6 +89,21 @@ DLL_EXPORT_CDBALIB cdba_library_handle cdba_library_initialize ();
  */
 DLL_EXPORT_CDBALIB void cdba_library_cleanup (cdba_library_handle dblib);
 
+/*! \brief initialize thread specific data of the database client library for the calling thread
+ * \details Only needed by MySQL, where it calls mysql_thread_init(), does nothing for the other drivers.
+ * \param  dblib                 database library handle
+ * \return zero on success, non-zero on error
+ * \sa     cdba_library_initialize()
+ * \sa     cdba_library_thread_end()
+ */
+DLL_EXPORT_CDBALIB int cdba_library_thread_init (cdba_library_handle dblib);
+
+/*! \brief clean up thread specific data of the database client library for the calling thread (must be called before a thread that used the library exits)
+ * \param  dblib                 database library handle
+ * \sa     cdba_library_thread_init()
+ */
+DLL_EXPORT_CDBALIB void cdba_library_thread_end (cdba_library_handle dblib);
+
 /*! \brief get name of database driver
  * \param  dblib                 database library handle
  * \return name of database driver
@@ -101,12 +130,13 @@ DLL_EXPORT_CDBALIB char* cdba_library_get_version (cdba_library_handle dblib);
  * \sa     cdba_commit_transaction()
  * \sa     cdba_rollback_transaction()
  * \sa     cdba_create_preparedstatement()
+ * \sa     cdba_prepare_cached()
  */
 typedef struct cdba_handle_struct* cdba_handle;
 
 /*! \brief open new database connection
  * \param  dblib                 database library handle
- * \param  configtext            database settings (key=value pairs separated by spaces or semicolons, double quotes are supported and backslash can be used inside double quotes to escape characters)
+ * \param  configtext            database settings (key=value pairs separated by spaces or semicolons, double quotes are supported and backslash can be used inside double quotes to escape characters), statementcache=n sets the statement cache size for all drivers, resultcache=n enables the result cache using at most n bytes and resultcachettl=n sets the time in milliseconds results stay in it (see cdba_set_result_cache()), stats=0 disables latency measurement for statistics, for SQLite3 busytimeout (or busy_timeout)/busywaitmin/busywaitmax set the lock wait policy in milliseconds, nomutex=1 opens the connection without the SQLite3 connection mutexes (it must then only be used by one thread at a time), journal_mode, synchronous, cache_size, mmap_size, page_size, temp_store and wal_autocheckpoint are applied as PRAGMA statements after opening (invalid values make opening fail), readonly=1, immutable=1 and shared_cache=1 set the open mode and uri=1 allows file to be an URI filename, driver=name selects the driver (sqlite3, mysql, odbc or the name of a cdba-driver-<name> plugin) when using the multi-driver library libcdba and is ignored otherwise
  * \return database handle on success or NULL on error
  * \sa     cdba_close()
  * \sa     cdba_set_error()
@@ -125,6 +155,83 @@ DLL_EXPORT_CDBALIB cdba_handle cdba_open (cdba_library_handle dblib, const char*
  */
 DLL_EXPORT_CDBALIB void cdba_close (cdba_handle db);
 
+/*! \brief default total time in milliseconds to wait for a locked SQLite3 database before failing
+ * \details Can be changed with the busytimeout setting passed to cdba_open().
+ * \sa     cdba_get_busy_stats()
+ */
+#define CDBA_BUSY_TIMEOUT_DEFAULT 3000
+
+/*! \brief default first wait in milliseconds when a SQLite3 database is locked, doubled on every retry
+ * \details Can be changed with the busywaitmin setting passed to cdba_open().
+ * \sa     cdba_get_busy_stats()
+ */
+#define CDBA_BUSY_WAIT_MIN_DEFAULT 1
+
+/*! \brief default maximum single wait in milliseconds when a SQLite3 database is locked
+ * \details Can be changed with the busywaitmax setting passed to cdba_open().
+ * \sa     cdba_get_busy_stats()
+ */
+#define CDBA_BUSY_WAIT_MAX_DEFAULT 100
+
+/*! \brief statistics about waiting for a busy or locked database
+ * \sa     cdba_get_busy_stats()
+ */
+typedef struct cdba_busy_stats_struct {
+  uint64_t events;              /**< number of times the database was found busy or locked */
+  uint64_t retries;             /**< number of waits before retrying */
+  uint64_t timeouts;            /**< number of times waiting was given up because the total wait time was exceeded */
+  uint64_t wait_us;             /**< total time spent waiting in microseconds */
+} cdba_busy_stats;
+
+/*! \brief get statistics about waiting for a busy or locked database (only SQLite3 waits, other drivers report zeros)
+ * \param  db                    database handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_open()
+ */
+DLL_EXPORT_CDBALIB void cdba_get_busy_stats (cdba_handle db, cdba_busy_stats* stats);
+
+/*! \brief number of buckets in the latency histogram of execution statistics
+ * \details Bucket 0 counts executions that took less than 1 microsecond,
+ *          bucket n counts executions that took from 2^(n-1) up to 2^n microseconds,
+ *          the last bucket also counts all slower executions.
+ * \sa     cdba_stats
+ */
+#define CDBA_STATS_HISTOGRAM_BUCKETS 24
+
+/*! \brief execution statistics of a database connection or prepared statement
+ * \details Counters are updated without locking by the thread using the connection.
+ *          Latencies are only measured when the connection was opened without stats=0.
+ * \sa     cdba_get_stats()
+ * \sa     cdba_prep_get_stats()
+ */
+typedef struct cdba_stats_struct {
+  uint64_t prepares;            /**< number of statements prepared (statements reused from the statement cache are not counted) */
+  uint64_t executions;          /**< number of executions (SQL statements, prepared statements and rows of batches) */
+  uint64_t rows_fetched;        /**< number of rows fetched */
+  uint64_t rows_affected;       /**< number of rows inserted, updated or deleted */
+  uint64_t errors;              /**< number of failed prepares, executions and fetches */
+  uint64_t busy_retries;        /**< number of retries because the database was busy or locked */
+  uint64_t execute_us;          /**< total execution time in microseconds */
+  uint64_t execute_max_us;      /**< longest execution time in microseconds */
+  uint64_t fetch_us;            /**< total time spent fetching rows in microseconds */
+  uint64_t fetch_max_us;        /**< longest time spent on a single fetch in microseconds */
+  uint64_t histogram[CDBA_STATS_HISTOGRAM_BUCKETS];   /**< number of executions by execution time, a batch counts as one execution */
+} cdba_stats;
+
+/*! \brief get execution statistics of a database connection (including all its prepared statements)
+ * \param  db                    database handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_reset_stats()
+ * \sa     cdba_prep_get_stats()
+ */
+DLL_EXPORT_CDBALIB void cdba_get_stats (cdba_handle db, cdba_stats* stats);
+
+/*! \brief reset execution statistics of a database connection (statistics of prepared statements are not reset)
+ * \param  db                    database handle
+ * \sa     cdba_get_stats()
+ */
+DLL_EXPORT_CDBALIB void cdba_reset_stats (cdba_handle db);
+
 /*! \brief set database error message (normally only for internal use)
  * \param  db                    database handle
  * \param  errmsg                database handle
@@ -144,6 +251,9 @@ DLL_EXPORT_CDBALIB void cdba_set_error (cdba_handle db, const char* errmsg);
 DLL_EXPORT_CDBALIB const char* cdba_get_error (cdba_handle db);
 
 /*! \brief execute a database SQL statement
+ * \details With MySQL the connection allows multiple statements, so when sql contains several statements separated by
+ *          semicolons they are all executed (up to the first one that fails) and their results are discarded.
+ *          With SQLite3 only a single statement is allowed, use cdba_multiple_sql() for multiple statements.
  * \param  db                    database handle
  * \param  sql                   SQL statement
  * \return zero on success, non-zero on error
@@ -156,6 +266,7 @@ DLL_EXPORT_CDBALIB const char* cdba_get_error (cdba_handle db);
 DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql);
 
 /*! \brief execute a database SQL statement
+ * \details Like cdba_sql(), with MySQL multiple statements separated by semicolons are all executed and their results are discarded.
  * \param  db                    database handle
  * \param  sql                   SQL statement
  * \param  sqllen                length of SQL statement
@@ -169,11 +280,13 @@ DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql);
 DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, size_t sqllen);
 
 /*! \brief execute a database SQL statement
+ * \details The results are discarded, with MySQL all statements are sent to the server in one round trip.
  * \param  db                    database handle
  * \param  sql                   SQL statements (can be multiple separated by semicolon)
  * \return zero on success, non-zero on error
  * \sa     cdba_sql()
  * \sa     cdba_sql_with_length()
+ * \sa     cdba_multiple_sql_open()
  * \sa     cdba_open()
  * \sa     cdba_close()
  * \sa     cdba_get_error()
@@ -220,15 +333,20 @@ DLL_EXPORT_CDBALIB void cdba_rollback_transaction (cdba_handle db);
  * \sa     cdba_prep_set_error()
  * \sa     cdba_prep_get_error()
  * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_execute_batch()
  * \sa     cdba_prep_get_rows_affected()
  * \sa     cdba_prep_get_insert_id()
  * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_fetch_batch()
  * \sa     cdba_prep_get_column_count()
  * \sa     cdba_prep_get_column_type()
  * \sa     cdba_prep_get_column_name()
  * \sa     cdba_prep_get_column_int()
  * \sa     cdba_prep_get_column_float()
  * \sa     cdba_prep_get_column_text()
+ * \sa     cdba_prep_get_column_text_ref()
+ * \sa     cdba_prep_get_column_name_ref()
  */
 typedef struct cdba_prep_handle_struct* cdba_prep_handle;
 
@@ -255,6 +373,110 @@ typedef struct cdba_prep_handle_struct* cdba_prep_handle;
  */
 DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle db, const char* sql);
 
+/*! \brief default number of prepared statements kept in the statement cache of each database connection
+ * \details Can be changed with the statementcache setting passed to cdba_open() or with cdba_set_statement_cache_size().
+ * \sa     cdba_prepare_cached()
+ */
+#define CDBA_STATEMENT_CACHE_DEFAULT_SIZE 16
+
+/*! \brief get a prepared statement from the statement cache of the database connection or prepare and cache it if needed
+ * \details The cache is looked up using the exact SQL text. The statement is returned reset with no arguments bound.
+ *          Calling cdba_prep_close() on the returned statement returns it to the cache instead of closing it.
+ *          If the same SQL is requested again while the cached statement is still in use another statement is prepared.
+ *          When the cache is full the least recently used statement that is not in use is closed.
+ * \param  db                    database handle
+ * \param  sql                   SQL statement
+ * \return prepared statement handle on success or NULL on error
+ * \sa     cdba_create_preparedstatement()
+ * \sa     cdba_prep_close()
+ * \sa     cdba_set_statement_cache_size()
+ * \sa     cdba_get_statement_cache_stats()
+ */
+DLL_EXPORT_CDBALIB cdba_prep_handle cdba_prepare_cached (cdba_handle db, const char* sql);
+
+/*! \brief set maximum number of prepared statements in the statement cache of the database connection
+ * \param  db                    database handle
+ * \param  capacity              maximum number of cached statements, 0 to disable caching
+ * \sa     cdba_prepare_cached()
+ * \sa     CDBA_STATEMENT_CACHE_DEFAULT_SIZE
+ */
+DLL_EXPORT_CDBALIB void cdba_set_statement_cache_size (cdba_handle db, size_t capacity);
+
+/*! \brief statement cache statistics
+ * \sa     cdba_get_statement_cache_stats()
+ */
+typedef struct cdba_statement_cache_stats_struct {
+  size_t capacity;              /**< maximum number of cached statements */
+  size_t count;                 /**< current number of cached statements */
+  uint64_t hits;                /**< number of times a cached statement was reused */
+  uint64_t misses;              /**< number of times a statement had to be prepared */
+  uint64_t evictions;           /**< number of cached statements closed to make room */
+} cdba_statement_cache_stats;
+
+/*! \brief get statement cache statistics of the database connection
+ * \param  db                    database handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_prepare_cached()
+ */
+DLL_EXPORT_CDBALIB void cdba_get_statement_cache_stats (cdba_handle db, cdba_statement_cache_stats* stats);
+
+/*! \brief default time in milliseconds results are kept in the result cache of a database connection
+ * \details Can be changed with the resultcachettl setting passed to cdba_open() or with cdba_set_result_cache().
+ * \sa     cdba_set_result_cache()
+ */
+#define CDBA_RESULT_CACHE_DEFAULT_TTL 1000
+
+/*! \brief enable or disable the result cache of the database connection
+ * \details When enabled, the rows of queries run with cdba_prep_foreach() or cdba_query_foreach() are kept in memory
+ *          and passed to the callback again when the same SQL is run with the same arguments, without querying the database.
+ *          Only complete results are cached, so results are not cached when the callback stops the iteration.
+ *          Statements executed through the same connection that write to a table remove the cached results read from that table,
+ *          statements whose effects can't be determined from the SQL text (like ROLLBACK or CALL) remove all cached results.
+ *          With SQLite3 results read through a view are removed when the tables underlying the view are written and
+ *          writes done by triggers and foreign key actions remove cached results as well (except for WITHOUT ROWID tables).
+ *          With other databases changes made by triggers, foreign key actions or to tables underlying a view are only picked up
+ *          when the cached results expire, so results always expire there.
+ *          Changes made by other connections are only picked up when the cached results expire, so ttl should be set accordingly.
+ *          Queries without tables, locking reads and queries using functions like NOW() or RAND() are not cached.
+ *          When the cache is full the least recently used results are removed.
+ *          The cache is disabled by default.
+ * \param  db                    database handle
+ * \param  capacity              maximum memory used by cached results in bytes, 0 to disable the cache and remove all cached results
+ * \param  ttl                   time in milliseconds results stay in the cache, 0 to only remove them when they are invalidated or evicted (SQLite3 only, other databases use CDBA_RESULT_CACHE_DEFAULT_TTL instead)
+ * \sa     cdba_clear_result_cache()
+ * \sa     cdba_get_result_cache_stats()
+ * \sa     CDBA_RESULT_CACHE_DEFAULT_TTL
+ */
+DLL_EXPORT_CDBALIB void cdba_set_result_cache (cdba_handle db, size_t capacity, unsigned int ttl);
+
+/*! \brief remove all results from the result cache of the database connection
+ * \param  db                    database handle
+ * \sa     cdba_set_result_cache()
+ */
+DLL_EXPORT_CDBALIB void cdba_clear_result_cache (cdba_handle db);
+
+/*! \brief result cache statistics
+ * \details The hit ratio is hits / (hits + misses).
+ * \sa     cdba_get_result_cache_stats()
+ */
+typedef struct cdba_result_cache_stats_struct {
+  size_t capacity;              /**< maximum memory used by cached results in bytes */
+  size_t size;                  /**< current memory used by cached results in bytes */
+  size_t count;                 /**< current number of cached results */
+  uint64_t hits;                /**< number of queries served from the cache */
+  uint64_t misses;              /**< number of cacheable queries that were run on the database */
+  uint64_t evictions;           /**< number of results removed to make room */
+  uint64_t expirations;         /**< number of results removed because they were too old */
+  uint64_t invalidations;       /**< number of results removed because a statement changed their tables */
+} cdba_result_cache_stats;
+
+/*! \brief get result cache statistics of the database connection
+ * \param  db                    database handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_set_result_cache()
+ */
+DLL_EXPORT_CDBALIB void cdba_get_result_cache_stats (cdba_handle db, cdba_result_cache_stats* stats);
+
 /*! \brief get number of arguments in prepared statement
  * \param  stmt                  prepared statement handle
  * \return number of arguments in prepared statement or < 0 if not supported
@@ -263,6 +485,7 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
 DLL_EXPORT_CDBALIB int cdba_prep_get_argument_count (cdba_prep_handle stmt);
 
 /*! \brief reset prepared statement so it can be reused
+ * \details Arguments bound with cdba_prep_bind_*() keep their values and are used again by the next cdba_prep_execute_bound().
  * \param  stmt                  prepared statement handle
  * \sa     cdba_create_preparedstatement()
  * \sa     cdba_prep_execute()
@@ -270,9 +493,10 @@ DLL_EXPORT_CDBALIB int cdba_prep_get_argument_count (cdba_prep_handle stmt);
  */
 DLL_EXPORT_CDBALIB void cdba_prep_reset (cdba_prep_handle stmt);
 
-/*! \brief close prepared statement
+/*! \brief close prepared statement (or return it to the statement cache if it was obtained with cdba_prepare_cached())
  * \param  stmt                  prepared statement handle
  * \sa     cdba_create_preparedstatement()
+ * \sa     cdba_prepare_cached()
  */
 DLL_EXPORT_CDBALIB void cdba_prep_close (cdba_prep_handle stmt);
 
@@ -293,12 +517,58 @@ DLL_EXPORT_CDBALIB void cdba_prep_set_error (cdba_prep_handle stmt, const char*
  */
 DLL_EXPORT_CDBALIB const char* cdba_prep_get_error (cdba_prep_handle stmt);
 
+/*! \brief get execution statistics of a prepared statement
+ * \param  stmt                  prepared statement handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_get_stats()
+ */
+DLL_EXPORT_CDBALIB void cdba_prep_get_stats (cdba_prep_handle stmt, cdba_stats* stats);
+
+/*! \brief default block size for the arena of a prepared statement
+ * \sa     cdba_prep_set_arena()
+ */
+#define CDBA_ARENA_DEFAULT_BLOCK_SIZE 4096
+
+/*! \brief statistics about the arena of a prepared statement
+ * \sa     cdba_prep_get_arena_stats()
+ */
+typedef struct cdba_arena_stats_struct {
+  size_t capacity;              /**< total size of the allocated blocks in bytes */
+  size_t used;                  /**< number of bytes currently in use */
+  size_t highwater;             /**< highest number of bytes in use at the same time */
+  uint64_t allocations;         /**< number of values allocated from the arena */
+  uint64_t blocks;              /**< number of blocks allocated */
+  uint64_t resets;              /**< number of times the arena was recycled */
+} cdba_arena_stats;
+
+/*! \brief enable or disable the arena allocator of a prepared statement
+ * \details When enabled, cdba_prep_get_column_text() returns values allocated from an arena that is recycled in one go
+ *          when the next row is fetched, when the statement is executed again and by cdba_prep_reset(),
+ *          and cdba_prep_get_column_name() returns names allocated from the same arena.
+ *          These results must not be passed to cdba_free() while the arena is enabled.
+ *          Blocks are kept when the arena is recycled, so after the first rows no more memory is allocated.
+ *          The arena of a statement obtained with cdba_prepare_cached() is disabled when it is returned to the cache with cdba_prep_close().
+ * \param  stmt                  prepared statement handle
+ * \param  blocksize             minimum size of the blocks allocated by the arena in bytes (e.g. CDBA_ARENA_DEFAULT_BLOCK_SIZE), or 0 to disable the arena and free its memory
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_get_arena_stats()
+ * \sa     cdba_prep_get_column_text()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_set_arena (cdba_prep_handle stmt, size_t blocksize);
+
+/*! \brief get statistics about the arena of a prepared statement (all zeros when the arena is not enabled)
+ * \param  stmt                  prepared statement handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_prep_set_arena()
+ */
+DLL_EXPORT_CDBALIB void cdba_prep_get_arena_stats (cdba_prep_handle stmt, cdba_arena_stats* stats);
+
 /*! \brief execute a database SQL prepared statement
  * \param  stmt                  prepared statement handle
- * \param  ...                   arguments defined as pairs of CDBALIB_VERSION_* and a value of the corresponding type
+ * \param  ...                   arguments defined as pairs of CDBA_TYPE_* and a value of the corresponding type (CDBA_TYPE_BLOB is followed by a const void* value and a size_t length)
  * \return zero on success, non-zero on error
  * \sa     cdba_create_preparedstatement()
- * \sa     CDBALIB_VERSION_*
+ * \sa     CDBA_TYPE_*
  * \sa     cdba_prep_get_error()
  * \sa     cdba_prep_get_argument_count()
  * \sa     cdba_prep_get_rows_affected()
@@ -306,9 +576,232 @@ DLL_EXPORT_CDBALIB const char* cdba_prep_get_error (cdba_prep_handle stmt);
  * \sa     cdba_prep_get_column_count()
  * \sa     cdba_prep_get_column_name()
  * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_execute_va()
  */
 DLL_EXPORT_CDBALIB int cdba_prep_execute (cdba_prep_handle stmt, ...);
 
+/*! \brief execute a database SQL prepared statement with arguments passed as a variable argument list
+ * \param  stmt                  prepared statement handle
+ * \param  args                  arguments defined as pairs of CDBALIB_VERSION_* and a value of the corresponding type
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_va (cdba_prep_handle stmt, va_list args);
+
+/*! \brief bind NULL to an argument of a prepared statement, the binding is kept for subsequent calls to cdba_prep_execute_bound()
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_int()
+ * \sa     cdba_prep_bind_float()
+ * \sa     cdba_prep_bind_text()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_null (cdba_prep_handle stmt, int index);
+
+/*! \brief bind an integer value to an argument of a prepared statement, the binding is kept for subsequent calls to cdba_prep_execute_bound()
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \param  value                 integer value
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_null()
+ * \sa     cdba_prep_bind_float()
+ * \sa     cdba_prep_bind_text()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_int (cdba_prep_handle stmt, int index, db_int value);
+
+/*! \brief bind a floating point value to an argument of a prepared statement, the binding is kept for subsequent calls to cdba_prep_execute_bound()
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \param  value                 floating point value
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_null()
+ * \sa     cdba_prep_bind_int()
+ * \sa     cdba_prep_bind_text()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_float (cdba_prep_handle stmt, int index, db_flt value);
+
+/*! \brief bind a text value to an argument of a prepared statement, the binding is kept for subsequent calls to cdba_prep_execute_bound()
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \param  value                 text value (copied into a buffer kept by the prepared statement), NULL binds a NULL value
+ * \param  len                   length of value in bytes or CDBA_NTS if value is zero-terminated
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_null()
+ * \sa     cdba_prep_bind_int()
+ * \sa     cdba_prep_bind_float()
+ * \sa     CDBA_NTS
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_text (cdba_prep_handle stmt, int index, const char* value, size_t len);
+
+/*! \brief bind a binary value to an argument of a prepared statement, the binding is kept for subsequent calls to cdba_prep_execute_bound()
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \param  value                 binary value (copied into a buffer kept by the prepared statement), NULL binds a NULL value
+ * \param  len                   length of value in bytes
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_null()
+ * \sa     cdba_prep_bind_text()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_blob (cdba_prep_handle stmt, int index, const void* value, size_t len);
+
+/*! \brief type of function called to read the next chunk of a streamed argument
+ * \param  streamdata            stream data passed to cdba_prep_bind_stream()
+ * \param  buf                   buffer that will receive the data
+ * \param  buflen                size of buffer in bytes
+ * \return number of bytes written to buffer, zero at the end of the data
+ * \sa     cdba_prep_bind_stream()
+ */
+typedef size_t (*cdba_stream_read_fn) (void* streamdata, char* buf, size_t buflen);
+
+/*! \brief bind a text value that is read in chunks while executing to an argument of a prepared statement
+ * \details The value is never held in memory as a whole by MySQL (mysql_stmt_send_long_data()) and ODBC (data at execution with SQLPutData()).
+ *          SQLite3 needs the complete value when binding, so it is read into a buffer kept by the prepared statement (allocated once when len is given).
+ *          The reader is called again on every following execution, so it must be able to provide the data again or the argument must be bound again.
+ * \param  stmt                  prepared statement handle
+ * \param  index                 argument number (first argument is 0)
+ * \param  len                   total length of value in bytes if known, otherwise CDBA_NTS
+ * \param  reader                function called to read the next chunk of the value
+ * \param  streamdata            data passed to the reader function
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_prep_bind_text()
+ * \sa     cdba_stream_read_fn
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_bind_stream (cdba_prep_handle stmt, int index, size_t len, cdba_stream_read_fn reader, void* streamdata);
+
+/*! \brief execute a database SQL prepared statement using the arguments bound with cdba_prep_bind_*()
+ * \details Arguments that were not bound are NULL, including those of a statement obtained with cdba_prepare_cached() that a previous user bound before returning it to the cache. Arguments are only bound to the database driver again when their type or buffer changed, so executing repeatedly with some changed values only costs updating those values.
+ *          A previous execution of the statement is reset automatically.
+ * \param  stmt                  prepared statement handle
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_bind_null()
+ * \sa     cdba_prep_bind_int()
+ * \sa     cdba_prep_bind_float()
+ * \sa     cdba_prep_bind_text()
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_get_error()
+ * \sa     cdba_prep_fetch_row()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_bound (cdba_prep_handle stmt);
+
+/*! \brief column of parameter values used to execute a prepared statement for multiple rows at once
+ * \sa     cdba_prep_execute_batch()
+ */
+typedef struct cdba_param_column_struct {
+  db_int type;                  /**< type of the values (one of CDBA_TYPE_*) */
+  const void* values;           /**< array with one value per row: db_int for CDBA_TYPE_INT, db_flt for CDBA_TYPE_FLOAT, const char* for CDBA_TYPE_TEXT, const void* for CDBA_TYPE_BLOB (NULL pointer for NULL values), ignored for CDBA_TYPE_NULL */
+  const size_t* lengths;        /**< array with the length of each text or binary value, or NULL if text values are zero-terminated (only used for CDBA_TYPE_TEXT and CDBA_TYPE_BLOB, required for CDBA_TYPE_BLOB) */
+  const char* nulls;            /**< array with a non-zero value for each row where the value is NULL, or NULL if there are no NULL values */
+} cdba_param_column;
+
+/*! \brief execute a database SQL prepared statement for multiple rows of arguments at once
+ * \details Uses array binding on ODBC, bulk execution on MariaDB (with fallback to executing row by row) and a single transaction on SQLite3 (unless a transaction was already started).
+ *          The statement should not return a result set.
+ *          MariaDB bulk execution only reports the first generated row ID, so when insertids is requested it is only used if auto_increment_increment is 1.
+ *          When the SQLite3 transaction can't be committed all rows are reported as failed.
+ * \param  stmt                  prepared statement handle
+ * \param  rows                  number of rows of arguments
+ * \param  params                array with one column of values for each argument of the prepared statement
+ * \param  rowstatus             array that will receive zero for each row that succeeded and non-zero for each row that failed, may be NULL
+ * \param  rowsaffected          pointer that will receive the total number of rows affected, may be NULL
+ * \param  insertids             array that will receive the automatically assigned row ID for each row (not supported by ODBC), may be NULL
+ * \return zero when all rows succeeded, the number of failed rows, or negative on error
+ * \sa     cdba_create_preparedstatement()
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_get_error()
+ * \sa     cdba_param_column
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_batch (cdba_prep_handle stmt, size_t rows, const cdba_param_column* params, int* rowstatus, db_int* rowsaffected, db_int* insertids);
+
+/*! \brief bulk loader handle type
+ * \sa     cdba_bulk_load_open()
+ */
+typedef struct cdba_bulk_load_handle_struct* cdba_bulk_handle;
+
+/*! \brief default number of rows buffered by a bulk loader before they are sent to the database
+ * \sa     cdba_bulk_load_set_chunk_size()
+ */
+#define CDBA_BULK_DEFAULT_CHUNK_ROWS 10000
+
+/*! \brief bulk loader statistics
+ * \sa     cdba_bulk_load_get_stats()
+ * \sa     cdba_bulk_load_finish()
+ */
+typedef struct cdba_bulk_stats_struct {
+  uint64_t rows;                /**< number of rows loaded */
+  uint64_t chunks;              /**< number of chunks sent to the database */
+  uint64_t elapsed_us;          /**< time since the bulk loader was opened in microseconds */
+  double rows_per_second;       /**< average number of rows loaded per second */
+  const char* method;           /**< loading method used for the last chunk: "load data local infile", "multi-row insert" or "array insert" */
+} cdba_bulk_stats;
+
+/*! \brief open a bulk loader to insert a large number of rows into a table
+ * \details Rows are buffered and sent to the database in chunks using the fastest method of the database driver:
+ *          LOAD DATA LOCAL INFILE fed from memory on MySQL (falling back to batch execution when the server doesn't allow it),
+ *          multi-row INSERT statements on SQLite3 and array-bound INSERT statements on ODBC.
+ * \param  db                    database handle
+ * \param  table                 name of the table (used in SQL statements as is)
+ * \param  numcolumns            number of columns
+ * \param  columns               names of the columns (used in SQL statements as is)
+ * \param  types                 type of each column (CDBA_TYPE_INT, CDBA_TYPE_FLOAT, CDBA_TYPE_TEXT or CDBA_TYPE_BLOB)
+ * \return bulk loader handle or NULL on error, cdba_bulk_load_finish() must be called when done
+ * \sa     cdba_bulk_load_set_chunk_size()
+ * \sa     cdba_bulk_load_append()
+ * \sa     cdba_bulk_load_finish()
+ */
+DLL_EXPORT_CDBALIB cdba_bulk_handle cdba_bulk_load_open (cdba_handle db, const char* table, int numcolumns, const char* const* columns, const db_int* types);
+
+/*! \brief set the number of rows sent to the database at once by a bulk loader and whether each chunk is committed
+ * \details Rows that are already buffered are sent first.
+ * \param  bulk                  bulk loader handle
+ * \param  rows                  number of rows per chunk (default: CDBA_BULK_DEFAULT_CHUNK_ROWS)
+ * \param  commit                non-zero to run each chunk in its own transaction (default), zero when the rows are loaded as part of a transaction started by the caller
+ * \return zero on success, non-zero on error
+ * \sa     cdba_bulk_load_open()
+ * \sa     CDBA_BULK_DEFAULT_CHUNK_ROWS
+ */
+DLL_EXPORT_CDBALIB int cdba_bulk_load_set_chunk_size (cdba_bulk_handle bulk, size_t rows, int commit);
+
+/*! \brief append a row to a bulk loader, the buffered rows are sent to the database when a chunk is full
+ * \details When sending a chunk fails all its buffered rows are discarded (and rolled back if each chunk runs in its own transaction), later rows start a new chunk.
+ * \param  bulk                  bulk loader handle
+ * \param  ...                   one value for each column defined as pair of CDBA_TYPE_* and a value of the corresponding type like cdba_prep_execute(), the type must be the column type or CDBA_TYPE_NULL
+ * \return zero on success, non-zero on error (the error message is available with cdba_get_error())
+ * \sa     cdba_bulk_load_open()
+ * \sa     cdba_bulk_load_append_va()
+ * \sa     cdba_bulk_load_finish()
+ */
+DLL_EXPORT_CDBALIB int cdba_bulk_load_append (cdba_bulk_handle bulk, ...);
+
+/*! \brief append a row to a bulk loader, the buffered rows are sent to the database when a chunk is full
+ * \param  bulk                  bulk loader handle
+ * \param  args                  values as described for cdba_bulk_load_append()
+ * \return zero on success, non-zero on error (the error message is available with cdba_get_error())
+ * \sa     cdba_bulk_load_append()
+ */
+DLL_EXPORT_CDBALIB int cdba_bulk_load_append_va (cdba_bulk_handle bulk, va_list args);
+
+/*! \brief get statistics of a bulk loader
+ * \param  bulk                  bulk loader handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_bulk_load_finish()
+ */
+DLL_EXPORT_CDBALIB void cdba_bulk_load_get_stats (cdba_bulk_handle bulk, cdba_bulk_stats* stats);
+
+/*! \brief send the remaining rows of a bulk loader to the database and close it
+ * \details The bulk loader is closed even when sending the remaining rows fails, in which case those rows are discarded.
+ * \param  bulk                  bulk loader handle
+ * \param  stats                 pointer to structure that will receive the final statistics, may be NULL
+ * \return zero on success, non-zero on error (the error message is available with cdba_get_error())
+ * \sa     cdba_bulk_load_open()
+ */
+DLL_EXPORT_CDBALIB int cdba_bulk_load_finish (cdba_bulk_handle bulk, cdba_bulk_stats* stats);
+
 /*! \brief get number of rows affected after prepared statement was executed
  * \param  stmt                  prepared statement handle
  * \return number of rows affected
@@ -323,6 +816,35 @@ DLL_EXPORT_CDBALIB db_int cdba_prep_get_rows_affected (cdba_prep_handle stmt);
  */
 DLL_EXPORT_CDBALIB db_int cdba_prep_get_insert_id (cdba_prep_handle stmt);
 
+/*! \brief fetch modes for results of prepared statements
+ * \sa     cdba_prep_set_fetch_mode()
+ * \name   CDBA_FETCH_MODE_*
+ * \{
+ */
+#define CDBA_FETCH_MODE_STREAM   0      /**< rows are read from the connection while fetching, the connection stays busy until all rows are fetched (default) */
+#define CDBA_FETCH_MODE_BUFFERED 1      /**< the complete result is read into client memory when executing, which releases the connection early and makes the row count known */
+#define CDBA_FETCH_MODE_CURSOR   2      /**< the result is kept on the server in a read-only cursor and rows are retrieved in groups of prefetch rows */
+/*! \} */
+
+/*! \brief set how the results of a prepared statement are fetched
+ * \details Takes effect on the next execution. Only used by MySQL, other drivers accept all modes and keep fetching the way they always do.
+ *          A statement obtained with cdba_prepare_cached() is set back to CDBA_FETCH_MODE_STREAM when it is returned to the cache with cdba_prep_close().
+ * \param  stmt                  prepared statement handle
+ * \param  mode                  fetch mode (one of CDBA_FETCH_MODE_*)
+ * \param  prefetchrows          number of rows retrieved from the server at once for CDBA_FETCH_MODE_CURSOR (0 for the default of 1)
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_get_row_count()
+ * \sa     CDBA_FETCH_MODE_*
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_set_fetch_mode (cdba_prep_handle stmt, int mode, unsigned long prefetchrows);
+
+/*! \brief get number of rows in result of executed prepared statement
+ * \param  stmt                  prepared statement handle
+ * \return number of rows in the result, or -1 if not known (only known for MySQL with CDBA_FETCH_MODE_BUFFERED)
+ * \sa     cdba_prep_set_fetch_mode()
+ */
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_row_count (cdba_prep_handle stmt);
+
 /*! \brief fetch next row of data from executed prepared statement
  * \param  stmt                  prepared statement handle
  * \return 0 on success but no more data to fetch, positive when data was fetched or negative on error
@@ -330,6 +852,34 @@ DLL_EXPORT_CDBALIB db_int cdba_prep_get_insert_id (cdba_prep_handle stmt);
  */
 DLL_EXPORT_CDBALIB int cdba_prep_fetch_row (cdba_prep_handle stmt);
 
+/*! \brief column of result values fetched for multiple rows at once
+ * \sa     cdba_prep_fetch_batch()
+ */
+typedef struct cdba_result_column_struct {
+  db_int type;                  /**< type to fetch the values as: CDBA_TYPE_INT, CDBA_TYPE_FLOAT, CDBA_TYPE_TEXT or CDBA_TYPE_BLOB, or CDBA_TYPE_NULL to skip the column */
+  void* values;                 /**< array with room for maxrows values: db_int for CDBA_TYPE_INT, db_flt for CDBA_TYPE_FLOAT, or buffer of textsize bytes receiving the values one after another (not zero-terminated) for CDBA_TYPE_TEXT and CDBA_TYPE_BLOB */
+  size_t textsize;              /**< size of the text buffer in bytes (only used for CDBA_TYPE_TEXT and CDBA_TYPE_BLOB) */
+  size_t* offsets;              /**< array with room for maxrows + 1 offsets, value of row i is stored from offsets[i] up to offsets[i + 1] (only used for CDBA_TYPE_TEXT and CDBA_TYPE_BLOB) */
+  uint8_t* nulls;               /**< bitmap of (maxrows + 7) / 8 bytes where bit (i % 8) of byte (i / 8) is set if the value of row i is NULL, or NULL if not needed */
+} cdba_result_column;
+
+/*! \brief fetch multiple rows of data from executed prepared statement into one array per column
+ * \details Uses a rowset on ODBC (when the column sizes allow it), result buffers bound at prepare time on MySQL and a tight step loop on SQLite3.
+ *          NULL values are returned as 0 or as an empty text value.
+ *          When a text value doesn't fit in the remaining text buffer the batch ends before that row, and that row is returned first by the next call.
+ *          Don't mix calls to cdba_prep_fetch_row() and cdba_prep_fetch_batch() for the same result.
+ * \param  stmt                  prepared statement handle
+ * \param  maxrows               maximum number of rows to fetch
+ * \param  columns               array with one entry for each result column
+ * \return number of rows fetched, 0 when there are no more rows, or negative on error (including when the first row doesn't fit in a text buffer)
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_get_column_count()
+ * \sa     cdba_prep_get_column_type()
+ * \sa     cdba_result_column
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_batch (cdba_prep_handle stmt, size_t maxrows, cdba_result_column* columns);
+
 /*! \brief get number of columns in result of executed prepared statement
  * \param  stmt                  prepared statement handle
  * \return number of columns
@@ -345,19 +895,20 @@ DLL_EXPORT_CDBALIB int cdba_prep_get_column_count (cdba_prep_handle stmt);
 /*! \brief get column type in result of executed prepared statement
  * \param  stmt                  prepared statement handle
  * \param  col                   column number (first column is 0)
- * \return column type (one of CDBALIB_VERSION_*)
+ * \return column type (one of CDBA_TYPE_*)
  * \sa     cdba_prep_execute()
  * \sa     cdba_prep_get_column_count()
- * \sa     CDBALIB_VERSION_*
+ * \sa     CDBA_TYPE_*
  */
 DLL_EXPORT_CDBALIB db_int cdba_prep_get_column_type (cdba_prep_handle stmt, int col);
 
 /*! \brief get column name in result of executed prepared statement
  * \param  stmt                  prepared statement handle
  * \param  col                   column number (first column is 0)
- * \return column name, the caller must call cdba_free() on the result when it is no longer needed
+ * \return column name, the caller must call cdba_free() on the result when it is no longer needed (unless the arena is enabled with cdba_prep_set_arena())
  * \sa     cdba_prep_execute()
  * \sa     cdba_prep_get_column_count()
+ * \sa     cdba_prep_get_column_index()
  */
 DLL_EXPORT_CDBALIB char* cdba_prep_get_column_name (cdba_prep_handle stmt, int col);
 
@@ -388,7 +939,7 @@ DLL_EXPORT_CDBALIB double cdba_prep_get_column_float (cdba_prep_handle stmt, int
 /*! \brief get text value of column from result of executed prepared statement
  * \param  stmt                  prepared statement handle
  * \param  col                   column number (first column is 0)
- * \return text column value, the caller must call cdba_free() on the result when it is no longer needed
+ * \return text column value, the caller must call cdba_free() on the result when it is no longer needed (unless the arena is enabled with cdba_prep_set_arena())
  * \sa     cdba_prep_execute()
  * \sa     cdba_prep_get_column_count()
  * \sa     cdba_prep_get_column_type()
@@ -397,6 +948,469 @@ DLL_EXPORT_CDBALIB double cdba_prep_get_column_float (cdba_prep_handle stmt, int
  */
 DLL_EXPORT_CDBALIB char* cdba_prep_get_column_text (cdba_prep_handle stmt, int col);
 
+/*! \brief get text value of column from result of executed prepared statement without making a copy
+ * \param  stmt                  prepared statement handle
+ * \param  col                   column number (first column is 0)
+ * \param  len                   pointer that will receive the length of the value in bytes (not including the terminating zero), may be NULL
+ * \return text column value or NULL if the value is NULL, the result is owned by the prepared statement and is only valid until the next call to cdba_prep_fetch_row() or cdba_prep_reset()
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_get_column_text()
+ */
+DLL_EXPORT_CDBALIB const char* cdba_prep_get_column_text_ref (cdba_prep_handle stmt, int col, size_t* len);
+
+/*! \brief get binary value of column from result of executed prepared statement without making a copy
+ * \param  stmt                  prepared statement handle
+ * \param  col                   column number (first column is 0)
+ * \param  len                   pointer that will receive the length of the value in bytes, may be NULL
+ * \return binary column value or NULL if the value is NULL, the result is owned by the prepared statement and is only valid until the next call to cdba_prep_fetch_row() or cdba_prep_reset()
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_get_column_text_ref()
+ * \sa     cdba_prep_get_column_chunk()
+ */
+DLL_EXPORT_CDBALIB const void* cdba_prep_get_column_blob (cdba_prep_handle stmt, int col, size_t* len);
+
+/*! \brief read part of the value of a column from result of executed prepared statement into a buffer
+ * \details Large values can be read in chunks this way without the complete value being held in memory by CDBALIB.
+ *          With ODBC chunks must be read in order of increasing offset and the other column getters must not be used for the same column of the current row.
+ * \param  stmt                  prepared statement handle
+ * \param  col                   column number (first column is 0)
+ * \param  offset                offset in bytes in the value to start reading from
+ * \param  buf                   buffer that will receive the data (not zero-terminated)
+ * \param  buflen                size of buffer in bytes
+ * \param  len                   pointer that will receive the number of bytes written to the buffer, zero when offset is at the end of the value or the value is NULL
+ * \return zero on success, non-zero on error
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_prep_get_column_text_ref()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_get_column_chunk (cdba_prep_handle stmt, int col, size_t offset, char* buf, size_t buflen, size_t* len);
+
+/*! \brief get column name in result of executed prepared statement without making a copy
+ * \param  stmt                  prepared statement handle
+ * \param  col                   column number (first column is 0)
+ * \param  len                   pointer that will receive the length of the name in bytes (not including the terminating zero), may be NULL
+ * \return column name, the result is owned by the prepared statement and is only valid until cdba_prep_close() is called
+ * \sa     cdba_prep_execute()
+ * \sa     cdba_prep_get_column_count()
+ * \sa     cdba_prep_get_column_name()
+ */
+DLL_EXPORT_CDBALIB const char* cdba_prep_get_column_name_ref (cdba_prep_handle stmt, int col, size_t* len);
+
+/*! \brief description of a column in the result of a prepared statement
+ * \sa     cdba_prep_get_column_info()
+ */
+typedef struct cdba_column_info_struct {
+  const char* name;             /**< column name */
+  size_t namelen;               /**< length of the column name in bytes (not including the terminating zero) */
+  db_int type;                  /**< column type (one of CDBA_TYPE_*), for SQLite3 derived from the declared type as each value can have a different type (the type of the value in the current row for NUMERIC affinity) */
+  int nativetype;               /**< type used by the database (MySQL enum_field_types, SQLite3 SQLITE_* datatype of the column affinity or SQLITE_NULL for NUMERIC affinity and expressions, ODBC SQL data type) */
+  size_t size;                  /**< declared column size (maximum length or precision), 0 if unknown */
+  int nullable;                 /**< 1 if the column can contain NULL values, 0 if it can't, -1 if unknown */
+} cdba_column_info;
+
+/*! \brief get description of column in result of prepared statement
+ * \details The descriptions of all columns are determined once when first needed and kept with the prepared statement.
+ * \param  stmt                  prepared statement handle
+ * \param  col                   column number (first column is 0)
+ * \return column description or NULL on error, the result is owned by the prepared statement and is only valid until cdba_prep_close() is called
+ * \sa     cdba_prep_get_column_count()
+ * \sa     cdba_prep_get_column_index()
+ * \sa     cdba_column_info
+ */
+DLL_EXPORT_CDBALIB const cdba_column_info* cdba_prep_get_column_info (cdba_prep_handle stmt, int col);
+
+/*! \brief get column number from column name in result of prepared statement
+ * \details Names are compared case sensitive, when more than one column has the same name the first one is returned.
+ * \param  stmt                  prepared statement handle
+ * \param  name                  column name
+ * \return column number (first column is 0) or -1 if there is no column with that name
+ * \sa     cdba_prep_get_column_name()
+ * \sa     cdba_prep_get_column_info()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_get_column_index (cdba_prep_handle stmt, const char* name);
+
+/*! \brief view of the current row of a result passed to a row callback
+ * \details Only valid during the callback. The accessors read the values from the buffers of the prepared statement
+ *          and don't check the state of the statement, col must be a valid column number.
+ * \sa     cdba_prep_foreach()
+ * \sa     cdba_query_foreach()
+ */
+typedef struct cdba_row_struct* cdba_row;
+
+/*! \brief function called for each row of a result
+ * \param  row                   view of the current row
+ * \param  callbackdata          data passed to cdba_prep_foreach() or cdba_query_foreach()
+ * \return zero to continue with the next row or non-zero to stop
+ * \sa     cdba_prep_foreach()
+ * \sa     cdba_query_foreach()
+ */
+typedef int (*cdba_row_callback_fn) (cdba_row row, void* callbackdata);
+
+/*! \brief execute prepared statement with the arguments bound with cdba_prep_bind_*() and call a function for each row of the result
+ * \details The callback must not fetch, reset, execute or close the prepared statement.
+ *          When the callback stops the iteration the remaining rows are discarded with cdba_prep_reset().
+ *          When the result cache is enabled the rows of queries may come from the cache, in which case the statement is not executed.
+ * \param  stmt                  prepared statement handle
+ * \param  callback              function called for each row
+ * \param  callbackdata          data passed to the callback
+ * \return number of rows passed to the callback, or negative on error
+ * \sa     cdba_query_foreach()
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_set_result_cache()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_foreach (cdba_prep_handle stmt, cdba_row_callback_fn callback, void* callbackdata);
+
+/*! \brief execute SQL query and call a function for each row of the result
+ * \details The query is prepared using the statement cache (see cdba_prepare_cached()).
+ * \param  db                    database handle
+ * \param  sql                   SQL query without arguments
+ * \param  callback              function called for each row
+ * \param  callbackdata          data passed to the callback
+ * \return number of rows passed to the callback, or negative on error (the error message is available with cdba_get_error())
+ * \sa     cdba_prep_foreach()
+ */
+DLL_EXPORT_CDBALIB int cdba_query_foreach (cdba_handle db, const char* sql, cdba_row_callback_fn callback, void* callbackdata);
+
+/*! \brief get number of columns of a row
+ * \param  row                   row passed to the callback
+ * \return number of columns
+ */
+DLL_EXPORT_CDBALIB int cdba_row_get_column_count (cdba_row row);
+
+/*! \brief get type of column of a row
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \return column type (one of CDBA_TYPE_*)
+ * \sa     cdba_prep_get_column_type()
+ */
+DLL_EXPORT_CDBALIB db_int cdba_row_get_type (cdba_row row, int col);
+
+/*! \brief check if value of column of a row is NULL
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \return non-zero if the value is NULL
+ */
+DLL_EXPORT_CDBALIB int cdba_row_is_null (cdba_row row, int col);
+
+/*! \brief get integer value of column of a row
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \return integer column value (0 for NULL)
+ */
+DLL_EXPORT_CDBALIB db_int cdba_row_get_int (cdba_row row, int col);
+
+/*! \brief get floating point value of column of a row
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \return floating point column value (0 for NULL)
+ */
+DLL_EXPORT_CDBALIB db_flt cdba_row_get_float (cdba_row row, int col);
+
+/*! \brief get text value of column of a row without making a copy
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \param  len                   pointer that will receive the length of the value in bytes (not including the terminating zero), may be NULL
+ * \return text column value or NULL if the value is NULL, only valid during the callback
+ * \sa     cdba_prep_get_column_text_ref()
+ */
+DLL_EXPORT_CDBALIB const char* cdba_row_get_text (cdba_row row, int col, size_t* len);
+
+/*! \brief get binary value of column of a row without making a copy
+ * \param  row                   row passed to the callback
+ * \param  col                   column number (first column is 0)
+ * \param  len                   pointer that will receive the length of the value in bytes, may be NULL
+ * \return binary column value or NULL if the value is NULL, only valid during the callback
+ * \sa     cdba_prep_get_column_blob()
+ */
+DLL_EXPORT_CDBALIB const void* cdba_row_get_blob (cdba_row row, int col, size_t* len);
+
+/*! \brief handle for the results of multiple SQL statements
+ * \sa     cdba_multiple_sql_open()
+ */
+typedef struct cdba_multi_struct* cdba_multi_handle;
+
+/*! \brief execute multiple SQL statements and keep the result of each statement
+ * \details With MySQL all statements are sent to the server in one round trip (multiple statements are enabled
+ *          when connecting) and the results are read in order, the connection can't be used for anything else until
+ *          cdba_multi_close() is called. Other databases prepare and execute each statement when its result is requested.
+ *          No statements are executed after a statement failed.
+ * \param  db                    database handle
+ * \param  sql                   SQL statements separated by semicolon, without arguments
+ * \return handle for the results or NULL on error (the error message is available with cdba_get_error())
+ * \sa     cdba_multi_next_result()
+ * \sa     cdba_multi_close()
+ * \sa     cdba_multiple_sql()
+ */
+DLL_EXPORT_CDBALIB cdba_multi_handle cdba_multiple_sql_open (cdba_handle db, const char* sql);
+
+/*! \brief move to the result of the next statement
+ * \details Must be called before the result of the first statement can be accessed, rows not fetched from the previous result are discarded.
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return 1 if positioned on the result of the next statement (check cdba_multi_get_status() to see if it succeeded) or 0 if there are no more results
+ * \sa     cdba_multi_get_status()
+ * \sa     cdba_multi_fetch_row()
+ */
+DLL_EXPORT_CDBALIB int cdba_multi_next_result (cdba_multi_handle multi);
+
+/*! \brief get status of the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return zero on success or negative if the statement failed
+ * \sa     cdba_multi_get_error()
+ */
+DLL_EXPORT_CDBALIB int cdba_multi_get_status (cdba_multi_handle multi);
+
+/*! \brief get error message of the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return error message or NULL if there was no error, only valid until the next call on the handle
+ * \sa     cdba_multi_get_status()
+ */
+DLL_EXPORT_CDBALIB const char* cdba_multi_get_error (cdba_multi_handle multi);
+
+/*! \brief get number of columns in the result of the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return number of columns, 0 for statements that don't return rows
+ */
+DLL_EXPORT_CDBALIB int cdba_multi_get_column_count (cdba_multi_handle multi);
+
+/*! \brief get name of column in the result of the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \param  col                   column number (first column is 0)
+ * \return column name or NULL on error, only valid until cdba_multi_next_result() or cdba_multi_close() is called
+ */
+DLL_EXPORT_CDBALIB const char* cdba_multi_get_column_name (cdba_multi_handle multi, int col);
+
+/*! \brief get number of rows affected by the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return number of rows inserted, updated or deleted, 0 for statements that return rows
+ */
+DLL_EXPORT_CDBALIB db_int cdba_multi_get_rows_affected (cdba_multi_handle multi);
+
+/*! \brief fetch the next row of the result of the current statement
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return 1 if a row was fetched, 0 if there are no more rows, or negative on error
+ * \sa     cdba_multi_get_row()
+ */
+DLL_EXPORT_CDBALIB int cdba_multi_fetch_row (cdba_multi_handle multi);
+
+/*! \brief get the row fetched with cdba_multi_fetch_row()
+ * \details The values are read with the cdba_row_get_*() functions, MySQL returns all values as text which is converted when needed.
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ * \return row valid until the next call to cdba_multi_fetch_row(), cdba_multi_next_result() or cdba_multi_close()
+ * \sa     cdba_row_get_int()
+ * \sa     cdba_row_get_text()
+ */
+DLL_EXPORT_CDBALIB cdba_row cdba_multi_get_row (cdba_multi_handle multi);
+
+/*! \brief close the results of multiple SQL statements
+ * \details Remaining results are discarded, statements that were not executed yet are skipped (except with MySQL where all were sent to the server).
+ * \param  multi                 handle returned by cdba_multiple_sql_open()
+ */
+DLL_EXPORT_CDBALIB void cdba_multi_close (cdba_multi_handle multi);
+
+/*! \brief description of how a column or argument maps to a member of a C struct
+ * \details A mapping is an array of entries ending with an entry with type CDBA_TYPE_NULL, the members are located with offsetof().
+ *          Member types: db_int for CDBA_TYPE_INT, db_flt for CDBA_TYPE_FLOAT, for CDBA_TYPE_TEXT a char array of size bytes
+ *          or a const char* when size is 0. When fetching NULL values are stored as 0 or as empty string (NULL pointer if size is 0).
+ * \sa     cdba_prep_fetch_into()
+ * \sa     cdba_prep_execute_from()
+ */
+typedef struct cdba_field_mapping_struct {
+  const char* name;             /**< column name, NULL to use col */
+  int col;                      /**< column or argument number (first is 0), ignored when name is set */
+  size_t offset;                /**< offset of the member in the struct */
+  db_int type;                  /**< CDBA_TYPE_INT, CDBA_TYPE_FLOAT or CDBA_TYPE_TEXT, CDBA_TYPE_NULL for the terminating entry */
+  size_t size;                  /**< size of the char array member in bytes (including the terminating zero) for CDBA_TYPE_TEXT, 0 for a pointer member */
+} cdba_field_mapping;
+
+/*! \brief fetch the next row of the result of a prepared statement into a struct
+ * \details Text values longer than the char array member are truncated.
+ *          Pointer members (size 0) reference values kept by the prepared statement and are only valid until the next row is fetched.
+ * \param  stmt                  prepared statement handle
+ * \param  data                  pointer to the struct that will receive the values
+ * \param  mapping               description of the struct members (terminated by an entry with type CDBA_TYPE_NULL)
+ * \return 1 if a row was fetched, 0 if there are no more rows, or negative on error
+ * \sa     cdba_field_mapping
+ * \sa     cdba_prep_fetch_into_array()
+ * \sa     cdba_prep_fetch_row()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_into (cdba_prep_handle stmt, void* data, const cdba_field_mapping* mapping);
+
+/*! \brief fetch rows of the result of a prepared statement into an array of structs
+ * \details Only char array members should be used for text, pointer members are only valid until the next row is fetched.
+ * \param  stmt                  prepared statement handle
+ * \param  data                  pointer to the first struct in the array
+ * \param  rowsize               size of each struct in bytes (distance between array elements)
+ * \param  maxrows               maximum number of rows to fetch
+ * \param  mapping               description of the struct members (terminated by an entry with type CDBA_TYPE_NULL)
+ * \return number of rows fetched (less than maxrows when there are no more rows), or negative on error
+ * \sa     cdba_field_mapping
+ * \sa     cdba_prep_fetch_into()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_into_array (cdba_prep_handle stmt, void* data, size_t rowsize, size_t maxrows, const cdba_field_mapping* mapping);
+
+/*! \brief bind the arguments of a prepared statement from a struct and execute it
+ * \details Arguments are mapped by number (name must be NULL), a NULL pointer member binds a NULL value.
+ *          The bindings are kept for subsequent calls to cdba_prep_execute_bound().
+ * \param  stmt                  prepared statement handle
+ * \param  data                  pointer to the struct with the values
+ * \param  mapping               description of the struct members (terminated by an entry with type CDBA_TYPE_NULL)
+ * \return zero on success, non-zero on error
+ * \sa     cdba_field_mapping
+ * \sa     cdba_prep_execute_bound()
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_from (cdba_prep_handle stmt, const void* data, const cdba_field_mapping* mapping);
+
+
+
+/*! \brief wait flags returned by the asynchronous functions
+ * \details When a function returns a combination of these flags the caller must wait until the descriptor
+ *          returned by cdba_get_async_fd() is ready (or the timeout expires) and then call the matching
+ *          continue function passing the flags of the events that occurred.
+ *          The values are the same as the MYSQL_WAIT_* values of the MariaDB non-blocking client library.
+ * \sa     cdba_sql_start()
+ * \sa     cdba_prep_execute_start()
+ * \sa     cdba_prep_fetch_row_start()
+ * \name   CDBA_ASYNC_*
+ * \{
+ */
+#define CDBA_ASYNC_DONE    0x00     /**< operation finished, the status is available */
+#define CDBA_ASYNC_READ    0x01     /**< wait until the descriptor is readable */
+#define CDBA_ASYNC_WRITE   0x02     /**< wait until the descriptor is writable */
+#define CDBA_ASYNC_EXCEPT  0x04     /**< wait for an exception on the descriptor */
+#define CDBA_ASYNC_TIMEOUT 0x08     /**< wait no longer than cdba_get_async_timeout() milliseconds */
+/*! @} */
+
+/*! \brief get descriptor to poll while an asynchronous operation is in progress
+ * \details For MySQL built against the MariaDB client library this is the connection socket,
+ *          for other drivers this is the read end of a pipe signaled by the worker thread running the operation.
+ * \param  db                    database handle
+ * \return descriptor to poll or -1 if none is available (on Windows when no MariaDB socket is used, rely on CDBA_ASYNC_TIMEOUT instead)
+ * \sa     cdba_get_async_timeout()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_get_async_fd (cdba_handle db);
+
+/*! \brief get maximum time to wait before calling the continue function again when CDBA_ASYNC_TIMEOUT was returned
+ * \param  db                    database handle
+ * \return timeout in milliseconds
+ * \sa     cdba_get_async_fd()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB unsigned int cdba_get_async_timeout (cdba_handle db);
+
+/*! \brief start executing a database SQL statement without blocking
+ * \details Only one asynchronous operation can be in progress per database connection,
+ *          the connection and its prepared statements must not be used until the operation finished.
+ *          MySQL built against the MariaDB client library uses its non-blocking API,
+ *          other drivers run the operation on a worker thread owned by the connection.
+ * \param  db                    database handle
+ * \param  status                pointer that will receive the result (same as cdba_sql()) when the operation finished
+ * \param  sql                   SQL statement (copied when the operation runs on a worker thread)
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_sql_cont()
+ * \sa     cdba_sql()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_sql_start (cdba_handle db, int* status, const char* sql);
+
+/*! \brief continue executing a database SQL statement without blocking
+ * \param  db                    database handle
+ * \param  status                pointer that will receive the result (same as cdba_sql()) when the operation finished
+ * \param  ready                 wait flags of the events that occurred
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_sql_start()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_sql_cont (cdba_handle db, int* status, int ready);
+
+/*! \brief start executing a prepared statement with the arguments bound with cdba_prep_bind_*() without blocking
+ * \param  stmt                  prepared statement handle
+ * \param  status                pointer that will receive the result (same as cdba_prep_execute_bound()) when the operation finished
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_prep_execute_cont()
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_sql_start()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_start (cdba_prep_handle stmt, int* status);
+
+/*! \brief continue executing a prepared statement without blocking
+ * \param  stmt                  prepared statement handle
+ * \param  status                pointer that will receive the result (same as cdba_prep_execute_bound()) when the operation finished
+ * \param  ready                 wait flags of the events that occurred
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_prep_execute_start()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_cont (cdba_prep_handle stmt, int* status, int ready);
+
+/*! \brief start fetching the next row of an executed prepared statement without blocking
+ * \param  stmt                  prepared statement handle
+ * \param  status                pointer that will receive the result (same as cdba_prep_fetch_row()) when the operation finished
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_prep_fetch_row_cont()
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_sql_start()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_start (cdba_prep_handle stmt, int* status);
+
+/*! \brief continue fetching the next row of an executed prepared statement without blocking
+ * \param  stmt                  prepared statement handle
+ * \param  status                pointer that will receive the result (same as cdba_prep_fetch_row()) when the operation finished
+ * \param  ready                 wait flags of the events that occurred
+ * \return CDBA_ASYNC_DONE if finished, otherwise the wait flags
+ * \sa     cdba_prep_fetch_row_start()
+ * \sa     CDBA_ASYNC_*
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_cont (cdba_prep_handle stmt, int* status, int ready);
+
+/*! \brief type of function called when an asynchronous operation finished
+ * \param  status                result of the operation (same as the matching blocking function)
+ * \param  callbackdata          callback data passed when starting the operation
+ * \sa     cdba_sql_async()
+ * \sa     cdba_prep_execute_async()
+ * \sa     cdba_prep_fetch_row_async()
+ */
+typedef void (*cdba_async_callback_fn) (int status, void* callbackdata);
+
+/*! \brief execute a database SQL statement on the worker thread of the connection and call a function when finished
+ * \details The callback is called from the worker thread, it may start the next asynchronous operation.
+ *          The connection and its prepared statements must not be used by other threads until the callback is called.
+ * \param  db                    database handle
+ * \param  sql                   SQL statement (copied)
+ * \param  callback              function called when the operation finished
+ * \param  callbackdata          data passed to the callback function
+ * \return zero if the operation was started, non-zero on error (e.g. when another asynchronous operation is in progress)
+ * \sa     cdba_sql()
+ * \sa     cdba_sql_start()
+ * \sa     cdba_async_callback_fn
+ */
+DLL_EXPORT_CDBALIB int cdba_sql_async (cdba_handle db, const char* sql, cdba_async_callback_fn callback, void* callbackdata);
+
+/*! \brief execute a prepared statement with the arguments bound with cdba_prep_bind_*() on the worker thread of the connection and call a function when finished
+ * \param  stmt                  prepared statement handle
+ * \param  callback              function called when the operation finished
+ * \param  callbackdata          data passed to the callback function
+ * \return zero if the operation was started, non-zero on error
+ * \sa     cdba_prep_execute_bound()
+ * \sa     cdba_sql_async()
+ * \sa     cdba_async_callback_fn
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_execute_async (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata);
+
+/*! \brief fetch the next row of an executed prepared statement on the worker thread of the connection and call a function when finished
+ * \param  stmt                  prepared statement handle
+ * \param  callback              function called when the operation finished, the column values can be read from the callback
+ * \param  callbackdata          data passed to the callback function
+ * \return zero if the operation was started, non-zero on error
+ * \sa     cdba_prep_fetch_row()
+ * \sa     cdba_sql_async()
+ * \sa     cdba_async_callback_fn
+ */
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_async (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata);
+
 
 
 /*! \brief free memory allocated by DCBALIB
@@ -418,7 +1432,7 @@ DLL_EXPORT_CDBALIB void cdba_free (void* data);
 /*! \brief major version number */
 #define CDBALIB_VERSION_MAJOR 0
 /*! \brief minor version number */
-#define CDBALIB_VERSION_MINOR 2
+#define CDBALIB_VERSION_MINOR 3
 /*! \brief micro version number */
 #define CDBALIB_VERSION_MICRO 0
 /*! @} */
@@ -0,0 +1,147 @@
+/*!
+ * \file cdbapool.h
+ * \brief CDBALIB - C database abstraction library with support for prepared statements - header file with connection pool functions
+ * \details CDBALIB is a C database abstraction library with support for prepared statements. This is the header file with the thread-safe connection pool functions.
+ * \author Brecht Sanders
+ * \copyright LGPL License
+ *
+ * Header file for the connection pool of the C database abstraction library with support for prepared statements (CDBALIB)
+ */
+
+#ifndef INCLUDED_CDBAPOOL_H
+#define INCLUDED_CDBAPOOL_H
+
+#include "cdbalib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+/*! \brief value to wait indefinitely for a connection
+ * \sa     cdba_pool_checkout()
+ */
+#define CDBA_POOL_WAIT_FOREVER (-1)
+
+/*! \brief connection pool handle type
+ * \details All functions taking a connection pool handle can be called from multiple threads at the same time.
+ *          A connection that was checked out must only be used by one thread at a time until it is checked in again.
+ * \sa     cdba_pool_create()
+ * \sa     cdba_pool_destroy()
+ * \sa     cdba_pool_checkout()
+ * \sa     cdba_pool_checkin()
+ * \sa     cdba_pool_discard()
+ * \sa     cdba_pool_get_stats()
+ */
+typedef struct cdba_pool_struct* cdba_pool;
+
+/*! \brief create a connection pool
+ * \param  dblib                 database library handle
+ * \param  configtext            database settings passed to cdba_open() for each new connection
+ * \param  minsize               number of connections opened immediately and never closed because of being idle
+ * \param  maxsize               maximum number of connections (idle and checked out), must be at least 1
+ * \return connection pool handle on success or NULL on error
+ * \sa     cdba_library_initialize()
+ * \sa     cdba_open()
+ * \sa     cdba_pool_destroy()
+ * \sa     cdba_pool_set_idle_timeout()
+ * \sa     cdba_pool_set_validation()
+ * \sa     cdba_pool_checkout()
+ */
+DLL_EXPORT_CDBALIB cdba_pool cdba_pool_create (cdba_library_handle dblib, const char* configtext, unsigned int minsize, unsigned int maxsize);
+
+/*! \brief close all connections and destroy connection pool
+ * \details Connections that are still checked out are closed as well, so all threads must be done using them
+ *          and they must not be checked in or discarded afterwards.
+ * \param  pool                  connection pool handle
+ * \sa     cdba_pool_create()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_destroy (cdba_pool pool);
+
+/*! \brief set how long connections above the minimum pool size may stay idle before being closed
+ * \param  pool                  connection pool handle
+ * \param  idle_ms               idle time in milliseconds, 0 to never close idle connections (default)
+ * \sa     cdba_pool_create()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_set_idle_timeout (cdba_pool pool, unsigned int idle_ms);
+
+/*! \brief set SQL statement used to validate idle connections when they are checked out
+ * \param  pool                  connection pool handle
+ * \param  sql                   SQL statement (e.g. "SELECT 1") or NULL to disable validation (default)
+ * \param  idle_ms               only validate connections that have been idle for at least this number of milliseconds
+ * \return zero on success, non-zero on error
+ * \sa     cdba_pool_checkout()
+ */
+DLL_EXPORT_CDBALIB int cdba_pool_set_validation (cdba_pool pool, const char* sql, unsigned int idle_ms);
+
+/*! \brief check out a connection from the pool, opening a new connection if none is idle and the maximum size was not reached
+ * \param  pool                  connection pool handle
+ * \param  timeout_ms            maximum time to wait for a connection in milliseconds, 0 to not wait or CDBA_POOL_WAIT_FOREVER
+ * \return database handle on success or NULL on error or timeout
+ * \sa     cdba_pool_checkin()
+ * \sa     cdba_pool_discard()
+ * \sa     CDBA_POOL_WAIT_FOREVER
+ */
+DLL_EXPORT_CDBALIB cdba_handle cdba_pool_checkout (cdba_pool pool, int timeout_ms);
+
+/*! \brief return a connection to the pool
+ * \details Connections that are not checked out from this pool (e.g. when checked in twice) are ignored.
+ * \param  pool                  connection pool handle
+ * \param  db                    database handle obtained with cdba_pool_checkout()
+ * \sa     cdba_pool_checkout()
+ * \sa     cdba_pool_discard()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_checkin (cdba_pool pool, cdba_handle db);
+
+/*! \brief close a connection that was checked out instead of returning it to the pool (e.g. after a connection error)
+ * \details Connections that are not checked out from this pool are ignored and not closed.
+ * \param  pool                  connection pool handle
+ * \param  db                    database handle obtained with cdba_pool_checkout()
+ * \sa     cdba_pool_checkout()
+ * \sa     cdba_pool_checkin()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_discard (cdba_pool pool, cdba_handle db);
+
+/*! \brief connection pool statistics
+ * \sa     cdba_pool_get_stats()
+ */
+typedef struct cdba_pool_stats_struct {
+  unsigned int size;            /**< current number of connections (idle and checked out) */
+  unsigned int idle;            /**< current number of idle connections */
+  uint64_t checkouts;           /**< number of successful checkouts */
+  uint64_t waits;               /**< number of checkouts that had to wait for a connection */
+  uint64_t timeouts;            /**< number of checkouts that failed because no connection became available in time */
+  uint64_t opened;              /**< number of connections opened */
+  uint64_t closed;              /**< number of connections closed */
+  uint64_t evicted;             /**< number of idle connections closed because of the idle timeout */
+  uint64_t validation_failures; /**< number of connections closed because validation failed */
+  uint64_t total_wait_us;       /**< total time spent waiting for a connection in microseconds */
+  uint64_t max_wait_us;         /**< longest time spent waiting for a connection in microseconds */
+} cdba_pool_stats;
+
+/*! \brief get connection pool statistics
+ * \param  pool                  connection pool handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_pool_create()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_get_stats (cdba_pool pool, cdba_pool_stats* stats);
+
+/*! \brief get execution statistics of all connections of a connection pool
+ * \details Each connection keeps its own statistics without locking while it is checked out.
+ *          They are added to the pool totals and reset when the connection is checked in or discarded,
+ *          so the totals don't include connections that are currently checked out.
+ * \param  pool                  connection pool handle
+ * \param  stats                 pointer to structure that will receive the statistics
+ * \sa     cdba_pool_checkin()
+ * \sa     cdba_get_stats()
+ */
+DLL_EXPORT_CDBALIB void cdba_pool_get_db_stats (cdba_pool pool, cdba_stats* stats);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
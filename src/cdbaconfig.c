@@ -76,10 +76,12 @@ const char* cdba_config_parse (void* settings, const char* config, struct cdba_c
         break;
       cfgmap++;
     }
-    if (!cfgmap->config_name)
+    if (!cfgmap->config_name && cfgmap->type != cfg_skip) {
+      free(rawvalue);
       return varname;
+    }
     //store value in structure member
-    switch (cfgmap->type) {
+    switch (cfgmap->config_name ? cfgmap->type : cfg_skip) {
       case cfg_txt:
         if (*(char**)&(((int8_t*)settings)[cfgmap->settings_offset]))
           free(*(char**)&(((int8_t*)settings)[cfgmap->settings_offset]));
@@ -10,7 +10,8 @@ extern "C" {
 enum cdba_config_settings_type {
   cfg_int,
   cfg_flt,
-  cfg_txt
+  cfg_txt,
+  cfg_skip    //value is ignored, as terminating entry any unknown names are ignored instead of reported
 };
 
 struct cdba_config_settings_mapping_struct {
@@ -0,0 +1,345 @@
+#include "cdbadriver.h"
+#include "cdbaconfig.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#ifdef _WIN32
+#include <windows.h>
+#define DRIVER_MODULE HMODULE
+#define DRIVER_MODULE_LOAD(filename) LoadLibraryA(filename)
+#define DRIVER_MODULE_SYMBOL(module, name) (void*)GetProcAddress(module, name)
+#define DRIVER_MODULE_UNLOAD(module) FreeLibrary(module)
+#define DRIVER_MODULE_EXT ".dll"
+#define DRIVER_MUTEX CRITICAL_SECTION
+#define DRIVER_MUTEX_INIT(m) InitializeCriticalSection(m)
+#define DRIVER_MUTEX_DESTROY(m) DeleteCriticalSection(m)
+#define DRIVER_MUTEX_LOCK(m) EnterCriticalSection(m)
+#define DRIVER_MUTEX_UNLOCK(m) LeaveCriticalSection(m)
+#else
+#include <dlfcn.h>
+#include <pthread.h>
+#define DRIVER_MODULE void*
+#define DRIVER_MODULE_LOAD(filename) dlopen(filename, RTLD_NOW | RTLD_LOCAL)
+#define DRIVER_MODULE_SYMBOL(module, name) dlsym(module, name)
+#define DRIVER_MODULE_UNLOAD(module) dlclose(module)
+#ifdef __APPLE__
+#define DRIVER_MODULE_EXT ".dylib"
+#else
+#define DRIVER_MODULE_EXT ".so"
+#endif
+#define DRIVER_MUTEX pthread_mutex_t
+#define DRIVER_MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+#define DRIVER_MUTEX_DESTROY(m) pthread_mutex_destroy(m)
+#define DRIVER_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#define DRIVER_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#endif
+
+//drivers built into the library
+#ifdef CDBA_DRIVER_SQLITE3
+extern const struct cdba_driver_struct cdba_driver_sqlite3;
+#endif
+#ifdef CDBA_DRIVER_MYSQL
+extern const struct cdba_driver_struct cdba_driver_mysql;
+#endif
+#ifdef CDBA_DRIVER_ODBC
+extern const struct cdba_driver_struct cdba_driver_odbc;
+#endif
+#ifdef CDBA_DRIVER_FREETDS
+extern const struct cdba_driver_struct cdba_driver_freetds;
+#endif
+
+static const struct cdba_driver_struct* cdba_builtin_drivers[] = {
+#ifdef CDBA_DRIVER_SQLITE3
+  &cdba_driver_sqlite3,
+#endif
+#ifdef CDBA_DRIVER_MYSQL
+  &cdba_driver_mysql,
+#endif
+#ifdef CDBA_DRIVER_ODBC
+  &cdba_driver_odbc,
+#endif
+#ifdef CDBA_DRIVER_FREETDS
+  &cdba_driver_freetds,
+#endif
+  NULL
+};
+
+////////////////////////////////////////////////////////////////////////
+
+struct cdba_loaded_driver_struct {
+  const struct cdba_driver_struct* driver;
+  cdba_library_handle driverlib;
+  DRIVER_MODULE module;                       //NULL for built-in drivers
+  struct cdba_loaded_driver_struct* next;
+};
+
+struct cdba_library_handle_struct {
+  struct cdba_loaded_driver_struct* drivers;
+  char* drivernames;
+  DRIVER_MUTEX lock;                          //protects loading of driver plugins
+};
+
+static struct cdba_loaded_driver_struct* cdba_driver_add (struct cdba_library_handle_struct* dblib, const struct cdba_driver_struct* driver, DRIVER_MODULE module)
+{
+  struct cdba_loaded_driver_struct* entry;
+  struct cdba_loaded_driver_struct** last;
+  if ((entry = (struct cdba_loaded_driver_struct*)malloc(sizeof(struct cdba_loaded_driver_struct))) == NULL)
+    return NULL;
+  if ((entry->driverlib = driver->cdba_library_initialize()) == NULL) {
+    free(entry);
+    return NULL;
+  }
+  entry->driver = driver;
+  entry->module = module;
+  entry->next = NULL;
+  last = &dblib->drivers;
+  while (*last)
+    last = &(*last)->next;
+  *last = entry;
+  return entry;
+}
+
+static struct cdba_loaded_driver_struct* cdba_driver_find (struct cdba_library_handle_struct* dblib, const char* name)
+{
+  struct cdba_loaded_driver_struct* entry;
+  for (entry = dblib->drivers; entry; entry = entry->next) {
+    if (!name || strcmp(entry->driver->name, name) == 0)
+      return entry;
+  }
+  return NULL;
+}
+
+//load driver plugin cdba-driver-<name> exporting the table cdba_driver_<name>
+static struct cdba_loaded_driver_struct* cdba_driver_load_plugin (struct cdba_library_handle_struct* dblib, const char* name)
+{
+  const char* p;
+  char* filename;
+  char* symbolname;
+  DRIVER_MODULE module;
+  const struct cdba_driver_struct* driver;
+  struct cdba_loaded_driver_struct* entry;
+  //only allow simple names as they are used in file and symbol names
+  for (p = name; *p; p++) {
+    if (!isalnum(*p) && *p != '_')
+      return NULL;
+  }
+  if (p == name)
+    return NULL;
+  filename = (char*)malloc(strlen(CDBA_DRIVER_PLUGIN_PREFIX) + strlen(name) + strlen(DRIVER_MODULE_EXT) + 1);
+  symbolname = (char*)malloc(strlen(CDBA_DRIVER_SYMBOL_PREFIX) + strlen(name) + 1);
+  if (!filename || !symbolname) {
+    free(filename);
+    free(symbolname);
+    return NULL;
+  }
+  strcpy(filename, CDBA_DRIVER_PLUGIN_PREFIX);
+  strcat(filename, name);
+  strcat(filename, DRIVER_MODULE_EXT);
+  strcpy(symbolname, CDBA_DRIVER_SYMBOL_PREFIX);
+  strcat(symbolname, name);
+  entry = NULL;
+  if ((module = DRIVER_MODULE_LOAD(filename)) != NULL) {
+    if ((driver = (const struct cdba_driver_struct*)DRIVER_MODULE_SYMBOL(module, symbolname)) != NULL && strcmp(driver->name, name) == 0)
+      entry = cdba_driver_add(dblib, driver, module);
+    if (!entry)
+      DRIVER_MODULE_UNLOAD(module);
+  }
+  free(filename);
+  free(symbolname);
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+DLL_EXPORT_CDBALIB cdba_library_handle cdba_library_initialize ()
+{
+  struct cdba_library_handle_struct* dblib;
+  const struct cdba_driver_struct** builtin;
+  size_t len;
+  if ((dblib = (struct cdba_library_handle_struct*)malloc(sizeof(struct cdba_library_handle_struct))) == NULL)
+    return NULL;
+  dblib->drivers = NULL;
+  dblib->drivernames = NULL;
+  DRIVER_MUTEX_INIT(&dblib->lock);
+  //initialize built-in drivers, skip the ones that fail to initialize
+  len = 0;
+  for (builtin = cdba_builtin_drivers; *builtin; builtin++) {
+    if (cdba_driver_add(dblib, *builtin, NULL))
+      len += strlen((*builtin)->name) + 1;
+  }
+  //list of available built-in drivers
+  if ((dblib->drivernames = (char*)malloc(len + 1)) == NULL) {
+    cdba_library_cleanup(dblib);
+    return NULL;
+  }
+  dblib->drivernames[0] = 0;
+  for (builtin = cdba_builtin_drivers; *builtin; builtin++) {
+    if (cdba_driver_find(dblib, (*builtin)->name)) {
+      if (dblib->drivernames[0])
+        strcat(dblib->drivernames, ",");
+      strcat(dblib->drivernames, (*builtin)->name);
+    }
+  }
+  return dblib;
+}
+
+DLL_EXPORT_CDBALIB void cdba_library_cleanup (cdba_library_handle dblib)
+{
+  struct cdba_loaded_driver_struct* entry;
+  if (!dblib)
+    return;
+  while ((entry = dblib->drivers) != NULL) {
+    dblib->drivers = entry->next;
+    entry->driver->cdba_library_cleanup(entry->driverlib);
+    if (entry->module)
+      DRIVER_MODULE_UNLOAD(entry->module);
+    free(entry);
+  }
+  DRIVER_MUTEX_DESTROY(&dblib->lock);
+  free(dblib->drivernames);
+  free(dblib);
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_library_get_name (cdba_library_handle dblib)
+{
+  if (!dblib)
+    return NULL;
+  return dblib->drivernames;
+}
+
+DLL_EXPORT_CDBALIB char* cdba_library_get_version (cdba_library_handle dblib)
+{
+  struct cdba_loaded_driver_struct* entry;
+  char* version;
+  char* result;
+  char* p;
+  size_t len;
+  if (!dblib)
+    return NULL;
+  //list driver versions as name=version separated by commas
+  result = NULL;
+  len = 0;
+  DRIVER_MUTEX_LOCK(&dblib->lock);
+  for (entry = dblib->drivers; entry; entry = entry->next) {
+    if ((version = entry->driver->cdba_library_get_version(entry->driverlib)) == NULL)
+      continue;
+    if ((p = (char*)realloc(result, len + strlen(entry->driver->name) + strlen(version) + 3)) != NULL) {
+      result = p;
+      len += sprintf(result + len, "%s%s=%s", (len ? "," : ""), entry->driver->name, version);
+    }
+    entry->driver->cdba_free(version);
+  }
+  DRIVER_MUTEX_UNLOCK(&dblib->lock);
+  return result;
+}
+
+DLL_EXPORT_CDBALIB int cdba_library_thread_init (cdba_library_handle dblib)
+{
+  struct cdba_loaded_driver_struct* entry;
+  int result = 0;
+  if (!dblib)
+    return -1;
+  DRIVER_MUTEX_LOCK(&dblib->lock);
+  for (entry = dblib->drivers; entry; entry = entry->next) {
+    if (entry->driver->cdba_library_thread_init(entry->driverlib) != 0)
+      result = -1;
+  }
+  DRIVER_MUTEX_UNLOCK(&dblib->lock);
+  return result;
+}
+
+DLL_EXPORT_CDBALIB void cdba_library_thread_end (cdba_library_handle dblib)
+{
+  struct cdba_loaded_driver_struct* entry;
+  if (!dblib)
+    return;
+  DRIVER_MUTEX_LOCK(&dblib->lock);
+  for (entry = dblib->drivers; entry; entry = entry->next)
+    entry->driver->cdba_library_thread_end(entry->driverlib);
+  DRIVER_MUTEX_UNLOCK(&dblib->lock);
+}
+
+DLL_EXPORT_CDBALIB cdba_handle cdba_open (cdba_library_handle dblib, const char* configtext)
+{
+  struct {
+    char* driver;
+  } settings = {NULL};
+  struct cdba_config_settings_mapping_struct mapping[] = {
+    {"driver", 0, cfg_txt},
+    {NULL, 0, cfg_skip}
+  };
+  struct cdba_loaded_driver_struct* entry;
+  if (!dblib)
+    return NULL;
+  //determine driver, the first available driver is used if none is specified
+  if (cdba_config_parse(&settings, configtext, mapping) != NULL) {
+    free(settings.driver);
+    return NULL;
+  }
+  DRIVER_MUTEX_LOCK(&dblib->lock);
+  if ((entry = cdba_driver_find(dblib, settings.driver)) == NULL && settings.driver)
+    entry = cdba_driver_load_plugin(dblib, settings.driver);
+  DRIVER_MUTEX_UNLOCK(&dblib->lock);
+  free(settings.driver);
+  if (!entry)
+    return NULL;
+  return entry->driver->cdba_open(entry->driverlib, configtext);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#define CDBA_DRIVER_DISPATCH(ret, name, params, handle, args) \
+  DLL_EXPORT_CDBALIB ret name params \
+  { \
+    return CDBA_DRIVER_OF(handle)->name args; \
+  }
+
+#define CDBA_DRIVER_DISPATCH_VOID(name, params, handle, args) \
+  DLL_EXPORT_CDBALIB void name params \
+  { \
+    if (handle) \
+      CDBA_DRIVER_OF(handle)->name args; \
+  }
+
+CDBA_DRIVER_FUNCTIONS(CDBA_DRIVER_DISPATCH, CDBA_DRIVER_DISPATCH_VOID)
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute (cdba_prep_handle stmt, ...)
+{
+  int status;
+  va_list argp;
+  va_start(argp, stmt);
+  status = CDBA_DRIVER_OF(stmt)->cdba_prep_execute_va(stmt, argp);
+  va_end(argp);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB int cdba_bulk_load_append (cdba_bulk_handle bulk, ...)
+{
+  int status;
+  va_list argp;
+  va_start(argp, bulk);
+  status = CDBA_DRIVER_OF(bulk)->cdba_bulk_load_append_va(bulk, argp);
+  va_end(argp);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB void cdba_free (void* data)
+{
+  free(data);
+}
+
+DLL_EXPORT_CDBALIB void cdba_get_version (int* pmajor, int* pminor, int* pmicro)
+{
+  if (pmajor)
+    *pmajor = CDBALIB_VERSION_MAJOR;
+  if (pminor)
+    *pminor = CDBALIB_VERSION_MINOR;
+  if (pmicro)
+    *pmicro = CDBALIB_VERSION_MICRO;
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_get_version_string ()
+{
+  return CDBALIB_VERSION_STRING;
+}
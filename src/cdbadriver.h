@@ -0,0 +1,152 @@
+#ifndef INCLUDED_CDBADRIVER_H
+#define INCLUDED_CDBADRIVER_H
+
+//when building a driver for the multi-driver library the public functions are kept private to the driver and only the driver table is exported
+#if defined(CDBA_DRIVER) && !defined(DLL_EXPORT_CDBALIB)
+# if defined(__GNUC__)
+#  define DLL_EXPORT_CDBALIB static __attribute__((unused))
+# else
+#  define DLL_EXPORT_CDBALIB static
+# endif
+#endif
+
+#include "cdbalib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(BUILD_CDBALIB_DLL)
+# define DLL_EXPORT_CDBA_DRIVER __declspec(dllexport)
+#else
+# define DLL_EXPORT_CDBA_DRIVER
+#endif
+
+//name of the driver table symbol for a driver name (e.g. cdba_driver_sqlite3)
+#define CDBA_DRIVER_SYMBOL_PREFIX "cdba_driver_"
+
+//file name prefix of a driver plugin (e.g. cdba-driver-sqlite3.so)
+#define CDBA_DRIVER_PLUGIN_PREFIX "cdba-driver-"
+
+//functions dispatched on the database, prepared statement, bulk loader, row or multiple result handle passed as first argument
+//FN(return type, function name, parameter list, dispatch handle, argument list) for functions returning a value
+//VFN(function name, parameter list, dispatch handle, argument list) for functions without return value
+#define CDBA_DRIVER_FUNCTIONS(FN, VFN) \
+  VFN(cdba_close, (cdba_handle db), db, (db)) \
+  VFN(cdba_get_busy_stats, (cdba_handle db, cdba_busy_stats* stats), db, (db, stats)) \
+  VFN(cdba_get_stats, (cdba_handle db, cdba_stats* stats), db, (db, stats)) \
+  VFN(cdba_reset_stats, (cdba_handle db), db, (db)) \
+  VFN(cdba_set_error, (cdba_handle db, const char* errmsg), db, (db, errmsg)) \
+  FN(const char*, cdba_get_error, (cdba_handle db), db, (db)) \
+  FN(int, cdba_sql, (cdba_handle db, const char* sql), db, (db, sql)) \
+  FN(int, cdba_sql_with_length, (cdba_handle db, const char* sql, size_t sqllen), db, (db, sql, sqllen)) \
+  FN(int, cdba_multiple_sql, (cdba_handle db, const char* sql), db, (db, sql)) \
+  VFN(cdba_begin_transaction, (cdba_handle db), db, (db)) \
+  VFN(cdba_commit_transaction, (cdba_handle db), db, (db)) \
+  VFN(cdba_rollback_transaction, (cdba_handle db), db, (db)) \
+  FN(cdba_prep_handle, cdba_create_preparedstatement, (cdba_handle db, const char* sql), db, (db, sql)) \
+  FN(cdba_prep_handle, cdba_prepare_cached, (cdba_handle db, const char* sql), db, (db, sql)) \
+  VFN(cdba_set_statement_cache_size, (cdba_handle db, size_t capacity), db, (db, capacity)) \
+  VFN(cdba_get_statement_cache_stats, (cdba_handle db, cdba_statement_cache_stats* stats), db, (db, stats)) \
+  VFN(cdba_set_result_cache, (cdba_handle db, size_t capacity, unsigned int ttl), db, (db, capacity, ttl)) \
+  VFN(cdba_clear_result_cache, (cdba_handle db), db, (db)) \
+  VFN(cdba_get_result_cache_stats, (cdba_handle db, cdba_result_cache_stats* stats), db, (db, stats)) \
+  FN(int, cdba_prep_get_argument_count, (cdba_prep_handle stmt), stmt, (stmt)) \
+  VFN(cdba_prep_reset, (cdba_prep_handle stmt), stmt, (stmt)) \
+  VFN(cdba_prep_close, (cdba_prep_handle stmt), stmt, (stmt)) \
+  VFN(cdba_prep_set_error, (cdba_prep_handle stmt, const char* errmsg), stmt, (stmt, errmsg)) \
+  FN(const char*, cdba_prep_get_error, (cdba_prep_handle stmt), stmt, (stmt)) \
+  VFN(cdba_prep_get_stats, (cdba_prep_handle stmt, cdba_stats* stats), stmt, (stmt, stats)) \
+  FN(int, cdba_prep_set_arena, (cdba_prep_handle stmt, size_t blocksize), stmt, (stmt, blocksize)) \
+  VFN(cdba_prep_get_arena_stats, (cdba_prep_handle stmt, cdba_arena_stats* stats), stmt, (stmt, stats)) \
+  FN(int, cdba_prep_execute_va, (cdba_prep_handle stmt, va_list args), stmt, (stmt, args)) \
+  FN(int, cdba_prep_bind_null, (cdba_prep_handle stmt, int index), stmt, (stmt, index)) \
+  FN(int, cdba_prep_bind_int, (cdba_prep_handle stmt, int index, db_int value), stmt, (stmt, index, value)) \
+  FN(int, cdba_prep_bind_float, (cdba_prep_handle stmt, int index, db_flt value), stmt, (stmt, index, value)) \
+  FN(int, cdba_prep_bind_text, (cdba_prep_handle stmt, int index, const char* value, size_t len), stmt, (stmt, index, value, len)) \
+  FN(int, cdba_prep_bind_blob, (cdba_prep_handle stmt, int index, const void* value, size_t len), stmt, (stmt, index, value, len)) \
+  FN(int, cdba_prep_bind_stream, (cdba_prep_handle stmt, int index, size_t len, cdba_stream_read_fn reader, void* streamdata), stmt, (stmt, index, len, reader, streamdata)) \
+  FN(int, cdba_prep_execute_bound, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(int, cdba_prep_execute_batch, (cdba_prep_handle stmt, size_t rows, const cdba_param_column* params, int* rowstatus, db_int* rowsaffected, db_int* insertids), stmt, (stmt, rows, params, rowstatus, rowsaffected, insertids)) \
+  FN(cdba_bulk_handle, cdba_bulk_load_open, (cdba_handle db, const char* table, int numcolumns, const char* const* columns, const db_int* types), db, (db, table, numcolumns, columns, types)) \
+  FN(int, cdba_bulk_load_set_chunk_size, (cdba_bulk_handle bulk, size_t rows, int commit), bulk, (bulk, rows, commit)) \
+  FN(int, cdba_bulk_load_append_va, (cdba_bulk_handle bulk, va_list args), bulk, (bulk, args)) \
+  VFN(cdba_bulk_load_get_stats, (cdba_bulk_handle bulk, cdba_bulk_stats* stats), bulk, (bulk, stats)) \
+  FN(int, cdba_bulk_load_finish, (cdba_bulk_handle bulk, cdba_bulk_stats* stats), bulk, (bulk, stats)) \
+  FN(db_int, cdba_prep_get_rows_affected, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(db_int, cdba_prep_get_insert_id, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(int, cdba_prep_set_fetch_mode, (cdba_prep_handle stmt, int mode, unsigned long prefetchrows), stmt, (stmt, mode, prefetchrows)) \
+  FN(db_int, cdba_prep_get_row_count, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(int, cdba_prep_fetch_row, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(int, cdba_prep_fetch_batch, (cdba_prep_handle stmt, size_t maxrows, cdba_result_column* columns), stmt, (stmt, maxrows, columns)) \
+  FN(int, cdba_prep_get_column_count, (cdba_prep_handle stmt), stmt, (stmt)) \
+  FN(db_int, cdba_prep_get_column_type, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(char*, cdba_prep_get_column_name, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(db_int, cdba_prep_get_column_int, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(double, cdba_prep_get_column_float, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(char*, cdba_prep_get_column_text, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(const char*, cdba_prep_get_column_text_ref, (cdba_prep_handle stmt, int col, size_t* len), stmt, (stmt, col, len)) \
+  FN(const void*, cdba_prep_get_column_blob, (cdba_prep_handle stmt, int col, size_t* len), stmt, (stmt, col, len)) \
+  FN(int, cdba_prep_get_column_chunk, (cdba_prep_handle stmt, int col, size_t offset, char* buf, size_t buflen, size_t* len), stmt, (stmt, col, offset, buf, buflen, len)) \
+  FN(const char*, cdba_prep_get_column_name_ref, (cdba_prep_handle stmt, int col, size_t* len), stmt, (stmt, col, len)) \
+  FN(const cdba_column_info*, cdba_prep_get_column_info, (cdba_prep_handle stmt, int col), stmt, (stmt, col)) \
+  FN(int, cdba_prep_get_column_index, (cdba_prep_handle stmt, const char* name), stmt, (stmt, name)) \
+  FN(int, cdba_prep_foreach, (cdba_prep_handle stmt, cdba_row_callback_fn callback, void* callbackdata), stmt, (stmt, callback, callbackdata)) \
+  FN(int, cdba_query_foreach, (cdba_handle db, const char* sql, cdba_row_callback_fn callback, void* callbackdata), db, (db, sql, callback, callbackdata)) \
+  FN(int, cdba_row_get_column_count, (cdba_row row), row, (row)) \
+  FN(db_int, cdba_row_get_type, (cdba_row row, int col), row, (row, col)) \
+  FN(int, cdba_row_is_null, (cdba_row row, int col), row, (row, col)) \
+  FN(db_int, cdba_row_get_int, (cdba_row row, int col), row, (row, col)) \
+  FN(db_flt, cdba_row_get_float, (cdba_row row, int col), row, (row, col)) \
+  FN(const char*, cdba_row_get_text, (cdba_row row, int col, size_t* len), row, (row, col, len)) \
+  FN(const void*, cdba_row_get_blob, (cdba_row row, int col, size_t* len), row, (row, col, len)) \
+  FN(cdba_multi_handle, cdba_multiple_sql_open, (cdba_handle db, const char* sql), db, (db, sql)) \
+  FN(int, cdba_multi_next_result, (cdba_multi_handle multi), multi, (multi)) \
+  FN(int, cdba_multi_get_status, (cdba_multi_handle multi), multi, (multi)) \
+  FN(const char*, cdba_multi_get_error, (cdba_multi_handle multi), multi, (multi)) \
+  FN(int, cdba_multi_get_column_count, (cdba_multi_handle multi), multi, (multi)) \
+  FN(const char*, cdba_multi_get_column_name, (cdba_multi_handle multi, int col), multi, (multi, col)) \
+  FN(db_int, cdba_multi_get_rows_affected, (cdba_multi_handle multi), multi, (multi)) \
+  FN(int, cdba_multi_fetch_row, (cdba_multi_handle multi), multi, (multi)) \
+  FN(cdba_row, cdba_multi_get_row, (cdba_multi_handle multi), multi, (multi)) \
+  VFN(cdba_multi_close, (cdba_multi_handle multi), multi, (multi)) \
+  FN(int, cdba_prep_fetch_into, (cdba_prep_handle stmt, void* data, const cdba_field_mapping* mapping), stmt, (stmt, data, mapping)) \
+  FN(int, cdba_prep_fetch_into_array, (cdba_prep_handle stmt, void* data, size_t rowsize, size_t maxrows, const cdba_field_mapping* mapping), stmt, (stmt, data, rowsize, maxrows, mapping)) \
+  FN(int, cdba_prep_execute_from, (cdba_prep_handle stmt, const void* data, const cdba_field_mapping* mapping), stmt, (stmt, data, mapping)) \
+  FN(int, cdba_get_async_fd, (cdba_handle db), db, (db)) \
+  FN(unsigned int, cdba_get_async_timeout, (cdba_handle db), db, (db)) \
+  FN(int, cdba_sql_start, (cdba_handle db, int* status, const char* sql), db, (db, status, sql)) \
+  FN(int, cdba_sql_cont, (cdba_handle db, int* status, int ready), db, (db, status, ready)) \
+  FN(int, cdba_prep_execute_start, (cdba_prep_handle stmt, int* status), stmt, (stmt, status)) \
+  FN(int, cdba_prep_execute_cont, (cdba_prep_handle stmt, int* status, int ready), stmt, (stmt, status, ready)) \
+  FN(int, cdba_prep_fetch_row_start, (cdba_prep_handle stmt, int* status), stmt, (stmt, status)) \
+  FN(int, cdba_prep_fetch_row_cont, (cdba_prep_handle stmt, int* status, int ready), stmt, (stmt, status, ready)) \
+  FN(int, cdba_sql_async, (cdba_handle db, const char* sql, cdba_async_callback_fn callback, void* callbackdata), db, (db, sql, callback, callbackdata)) \
+  FN(int, cdba_prep_execute_async, (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata), stmt, (stmt, callback, callbackdata)) \
+  FN(int, cdba_prep_fetch_row_async, (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata), stmt, (stmt, callback, callbackdata))
+
+#define CDBA_DRIVER_MEMBER(ret, name, params, handle, args) ret (*name) params;
+#define CDBA_DRIVER_MEMBER_VOID(name, params, handle, args) void (*name) params;
+
+//driver function table, database, prepared statement, bulk loader, row and multiple result handles created by a driver start with a pointer to it
+struct cdba_driver_struct {
+  const char* name;
+  cdba_library_handle (*cdba_library_initialize) ();
+  void (*cdba_library_cleanup) (cdba_library_handle dblib);
+  const char* (*cdba_library_get_name) (cdba_library_handle dblib);
+  char* (*cdba_library_get_version) (cdba_library_handle dblib);
+  int (*cdba_library_thread_init) (cdba_library_handle dblib);
+  void (*cdba_library_thread_end) (cdba_library_handle dblib);
+  cdba_handle (*cdba_open) (cdba_library_handle dblib, const char* configtext);
+  void (*cdba_free) (void* data);
+  CDBA_DRIVER_FUNCTIONS(CDBA_DRIVER_MEMBER, CDBA_DRIVER_MEMBER_VOID)
+};
+
+//get the driver function table of a database or prepared statement handle
+#define CDBA_DRIVER_OF(handle) (*(const struct cdba_driver_struct* const*)(handle))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
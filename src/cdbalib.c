@@ -1,9 +1,11 @@
-#include "cdbalib.h"
+#include "cdbadriver.h"
 #include "cdbaconfig.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
+#include <ctype.h>
 #if defined(DB_MYSQL)
 #ifdef _WIN32
 #include <mariadb/mysql.h>
@@ -17,6 +19,12 @@
 #define my_bool int
 #endif
 #endif
+//MariaDB Connector/C provides a non-blocking API
+#if defined(MYSQL_WAIT_READ)
+#define CDBA_MYSQL_NONBLOCK
+#endif
+//character set number of binary strings
+#define MYSQL_BINARY_CHARSETNR 63
 #elif defined(DB_FREETDS)
 #include <cspublic.h>
 #include <ctpublic.h>
@@ -27,15 +35,83 @@
 #else
 #endif
 
-#define RETRY_ATTEMPTS 12
-#define RETRY_WAIT_TIME 250
 #ifdef _WIN32
 #include <windows.h>
-#define WAIT_BEFORE_RETRY(ms) Sleep(ms);
+#define SLEEP_MICROSECONDS(us) Sleep((DWORD)((us) / 1000));
+#define ASYNC_THREAD HANDLE
+#define ASYNC_THREAD_FUNCTION(name, arg) DWORD WINAPI name (LPVOID arg)
+#define ASYNC_THREAD_CREATE(t, fn, arg) ((*(t) = CreateThread(NULL, 0, fn, arg, 0, NULL)) != NULL ? 0 : -1)
+#define ASYNC_THREAD_JOIN(t) (WaitForSingleObject(t, INFINITE), CloseHandle(t))
+#define ASYNC_MUTEX CRITICAL_SECTION
+#define ASYNC_MUTEX_INIT(m) InitializeCriticalSection(m)
+#define ASYNC_MUTEX_DESTROY(m) DeleteCriticalSection(m)
+#define ASYNC_MUTEX_LOCK(m) EnterCriticalSection(m)
+#define ASYNC_MUTEX_UNLOCK(m) LeaveCriticalSection(m)
+#define ASYNC_COND CONDITION_VARIABLE
+#define ASYNC_COND_INIT(c) InitializeConditionVariable(c)
+#define ASYNC_COND_DESTROY(c)
+#define ASYNC_COND_BROADCAST(c) WakeAllConditionVariable(c)
+#define ASYNC_COND_WAIT(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define LIBRARY_MUTEX SRWLOCK
+#define LIBRARY_MUTEX_INITIALIZER SRWLOCK_INIT
+#define LIBRARY_MUTEX_LOCK(m) AcquireSRWLockExclusive(m)
+#define LIBRARY_MUTEX_UNLOCK(m) ReleaseSRWLockExclusive(m)
 #else
 #include <unistd.h>
-#define WAIT_BEFORE_RETRY(ms) usleep(ms * 1000);
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#define SLEEP_MICROSECONDS(us) usleep(us);
+#define ASYNC_THREAD pthread_t
+#define ASYNC_THREAD_FUNCTION(name, arg) void* name (void* arg)
+#define ASYNC_THREAD_CREATE(t, fn, arg) pthread_create(t, NULL, fn, arg)
+#define ASYNC_THREAD_JOIN(t) pthread_join(t, NULL)
+#define ASYNC_MUTEX pthread_mutex_t
+#define ASYNC_MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+#define ASYNC_MUTEX_DESTROY(m) pthread_mutex_destroy(m)
+#define ASYNC_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#define ASYNC_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#define ASYNC_COND pthread_cond_t
+#define ASYNC_COND_INIT(c) pthread_cond_init(c, NULL)
+#define ASYNC_COND_DESTROY(c) pthread_cond_destroy(c)
+#define ASYNC_COND_BROADCAST(c) pthread_cond_broadcast(c)
+#define ASYNC_COND_WAIT(c, m) pthread_cond_wait(c, m)
+#define LIBRARY_MUTEX pthread_mutex_t
+#define LIBRARY_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define LIBRARY_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#define LIBRARY_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#endif
+
+#ifdef CDBA_DRIVER
+#if defined(DB_MYSQL)
+#define CDBA_DRIVER_NAME "mysql"
+#define CDBA_DRIVER_TABLE cdba_driver_mysql
+#elif defined(DB_FREETDS)
+#define CDBA_DRIVER_NAME "freetds"
+#define CDBA_DRIVER_TABLE cdba_driver_freetds
+#elif defined(DB_SQLITE3)
+#define CDBA_DRIVER_NAME "sqlite3"
+#define CDBA_DRIVER_TABLE cdba_driver_sqlite3
+#elif defined(DB_ODBC)
+#define CDBA_DRIVER_NAME "odbc"
+#define CDBA_DRIVER_TABLE cdba_driver_odbc
+#else
+#error No database driver selected
 #endif
+DLL_EXPORT_CDBA_DRIVER extern const struct cdba_driver_struct CDBA_DRIVER_TABLE;
+#endif
+
+//get monotonic time in microseconds
+static uint64_t cdba_get_time_us ()
+{
+#ifdef _WIN32
+  return (uint64_t)GetTickCount64() * 1000;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
 
 ////////////////////////////////////////////////////////////////////////
 
@@ -51,36 +127,74 @@ struct cdba_library_handle_struct {
 #endif
 };
 
+//the database client library is initialized by the first library handle and cleaned up with the last one
+static LIBRARY_MUTEX cdba_library_lock = LIBRARY_MUTEX_INITIALIZER;
+static unsigned int cdba_library_refcount = 0;
+
+//release reference to the database client library and clean it up when it was the last one
+static void cdba_library_release ()
+{
+  LIBRARY_MUTEX_LOCK(&cdba_library_lock);
+  if (cdba_library_refcount > 0 && --cdba_library_refcount == 0) {
+#if defined(DB_MYSQL)
+    mysql_library_end();
+#elif defined(DB_SQLITE3)
+    sqlite3_shutdown();
+#endif
+  }
+  LIBRARY_MUTEX_UNLOCK(&cdba_library_lock);
+}
+
 DLL_EXPORT_CDBALIB cdba_library_handle cdba_library_initialize ()
 {
   struct cdba_library_handle_struct* dblib;
   if ((dblib = (struct cdba_library_handle_struct*)malloc(sizeof(struct cdba_library_handle_struct))) == NULL)
     return NULL;
+  LIBRARY_MUTEX_LOCK(&cdba_library_lock);
+  if (cdba_library_refcount == 0) {
+#if defined(DB_MYSQL)
+    if (mysql_library_init(0, NULL, NULL) != 0) {
+      LIBRARY_MUTEX_UNLOCK(&cdba_library_lock);
+      free(dblib);
+      return NULL;
+    }
+#elif defined(DB_SQLITE3)
+    if (sqlite3_initialize() != SQLITE_OK) {
+      LIBRARY_MUTEX_UNLOCK(&cdba_library_lock);
+      free(dblib);
+      return NULL;
+    }
+#endif
+  }
+  cdba_library_refcount++;
+  LIBRARY_MUTEX_UNLOCK(&cdba_library_lock);
 #if defined(DB_MYSQL)
-  mysql_library_init(0, NULL, NULL);
   dblib->drivername = "MySQL";
 #elif defined(DB_FREETDS)
   if (cs_ctx_alloc(CS_VERSION_100, &dblib->freetds_context) != CS_SUCCEED) {
+    cdba_library_release();
     free(dblib);
     return NULL;
   }
   if (ct_init(dblib->freetds_context, CS_VERSION_100) != CS_SUCCEED) {
+    cdba_library_release();
     free(dblib);
     return NULL;
   }
   dblib->drivername = "FreeTDS";
 #elif defined(DB_SQLITE3)
-  sqlite3_initialize();
   dblib->drivername = "SQLite3";
 #elif defined(DB_ODBC)
   if (SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &dblib->odbc_env) == SQL_ERROR) {
+    cdba_library_release();
     free(dblib);
     return NULL;
   }
-  SQLSetEnvAttr(dblib->odbc_env, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC2, 0);
-  //SQLSetEnvAttr(dblib->odbc_env, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC3, 0);
+  //ODBC 3 is needed for 64-bit integer arguments (SQL_C_SBIGINT)
+  SQLSetEnvAttr(dblib->odbc_env, SQL_ATTR_ODBC_VERSION, (SQLPOINTER)SQL_OV_ODBC3, 0);
   dblib->drivername = "ODBC";
 #else
+  cdba_library_release();
   free(dblib);
   dblib = NULL;
 #endif
@@ -92,16 +206,46 @@ DLL_EXPORT_CDBALIB void cdba_library_cleanup (cdba_library_handle dblib)
   if (!dblib)
     return;
 #if defined(DB_MYSQL)
-  mysql_library_end();
 #elif defined(DB_FREETDS)
   ct_exit(dblib->freetds_context, CS_UNUSED);
   cs_ctx_drop(dblib->freetds_context);
 #elif defined(DB_SQLITE3)
-  sqlite3_shutdown();
 #elif defined(DB_ODBC)
   if (dblib->odbc_env)
     SQLFreeHandle(SQL_HANDLE_ENV, dblib->odbc_env);
 #else
+#endif
+  cdba_library_release();
+  free(dblib);
+}
+
+DLL_EXPORT_CDBALIB int cdba_library_thread_init (cdba_library_handle dblib)
+{
+  (void)dblib;
+#if defined(DB_MYSQL)
+  if (mysql_thread_init() != 0)
+    return -1;
+  return 0;
+#elif defined(DB_FREETDS)
+  return 0;
+#elif defined(DB_SQLITE3)
+  return 0;
+#elif defined(DB_ODBC)
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+DLL_EXPORT_CDBALIB void cdba_library_thread_end (cdba_library_handle dblib)
+{
+  (void)dblib;
+#if defined(DB_MYSQL)
+  mysql_thread_end();
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+#elif defined(DB_ODBC)
+#else
 #endif
 }
 
@@ -160,6 +304,11 @@ DLL_EXPORT_CDBALIB void cdba_config_cleanup (cdba_config cfg);
 
 ////////////////////////////////////////////////////////////////////////
 
+#if defined(DB_SQLITE3)
+//value of integer SQLite3 settings that are not set (the SQLite3 default is kept)
+#define CDBA_SQLITE3_SETTING_DEFAULT INT64_MIN
+#endif
+
 struct cdba_config_struct {
 #if defined(DB_MYSQL)
   char* host;
@@ -171,13 +320,32 @@ struct cdba_config_struct {
   /////TO DO
 #elif defined(DB_SQLITE3)
   char* file;
+  db_int busytimeout;
+  db_int busywaitmin;
+  db_int busywaitmax;
+  db_int nomutex;
+  char* journalmode;
+  char* synchronous;
+  char* tempstore;
+  db_int cachesize;
+  db_int mmapsize;
+  db_int pagesize;
+  db_int walautocheckpoint;
+  db_int readonly;
+  db_int immutable;
+  db_int sharedcache;
+  db_int uri;
 #elif defined(DB_ODBC)
   char* dsn;
 #else
 #endif
+  db_int statementcache;
+  db_int resultcache;
+  db_int resultcachettl;
+  db_int stats;
 };
 
-struct cdba_config_settings_mapping_struct cdba_config_mapping[] = {
+static struct cdba_config_settings_mapping_struct cdba_config_mapping[] = {
 #if defined(DB_MYSQL)
   {"host",     offsetof(struct cdba_config_struct, host),     cfg_txt},
   {"port",     offsetof(struct cdba_config_struct, port),     cfg_int},
@@ -186,14 +354,35 @@ struct cdba_config_settings_mapping_struct cdba_config_mapping[] = {
   {"database", offsetof(struct cdba_config_struct, database), cfg_txt},
 #elif defined(DB_SQLITE3)
   {"file",     offsetof(struct cdba_config_struct, file),     cfg_txt},
+  {"busytimeout", offsetof(struct cdba_config_struct, busytimeout), cfg_int},
+  {"busywaitmin", offsetof(struct cdba_config_struct, busywaitmin), cfg_int},
+  {"busywaitmax", offsetof(struct cdba_config_struct, busywaitmax), cfg_int},
+  {"nomutex",  offsetof(struct cdba_config_struct, nomutex),  cfg_int},
+  {"busy_timeout", offsetof(struct cdba_config_struct, busytimeout), cfg_int},
+  {"journal_mode", offsetof(struct cdba_config_struct, journalmode), cfg_txt},
+  {"synchronous", offsetof(struct cdba_config_struct, synchronous), cfg_txt},
+  {"temp_store", offsetof(struct cdba_config_struct, tempstore), cfg_txt},
+  {"cache_size", offsetof(struct cdba_config_struct, cachesize), cfg_int},
+  {"mmap_size", offsetof(struct cdba_config_struct, mmapsize), cfg_int},
+  {"page_size", offsetof(struct cdba_config_struct, pagesize), cfg_int},
+  {"wal_autocheckpoint", offsetof(struct cdba_config_struct, walautocheckpoint), cfg_int},
+  {"readonly", offsetof(struct cdba_config_struct, readonly), cfg_int},
+  {"immutable", offsetof(struct cdba_config_struct, immutable), cfg_int},
+  {"shared_cache", offsetof(struct cdba_config_struct, sharedcache), cfg_int},
+  {"uri",      offsetof(struct cdba_config_struct, uri),      cfg_int},
 #elif defined(DB_ODBC)
   {"dsn",      offsetof(struct cdba_config_struct, dsn),      cfg_txt},
 #else
 #endif
+  {"statementcache", offsetof(struct cdba_config_struct, statementcache), cfg_int},
+  {"resultcache", offsetof(struct cdba_config_struct, resultcache), cfg_int},
+  {"resultcachettl", offsetof(struct cdba_config_struct, resultcachettl), cfg_int},
+  {"stats",    offsetof(struct cdba_config_struct, stats),    cfg_int},
+  {"driver",   0,                                             cfg_skip},
   {NULL, 0, 0}
 };
 
-cdba_config cdba_config_initialize ()
+static cdba_config cdba_config_initialize ()
 {
   struct cdba_config_struct* cfg;
   if ((cfg = (struct cdba_config_struct*)malloc(sizeof(struct cdba_config_struct))) == NULL)
@@ -208,10 +397,29 @@ cdba_config cdba_config_initialize ()
   /////TO DO
 #elif defined(DB_SQLITE3)
   cfg->file = NULL;
+  cfg->busytimeout = CDBA_BUSY_TIMEOUT_DEFAULT;
+  cfg->busywaitmin = CDBA_BUSY_WAIT_MIN_DEFAULT;
+  cfg->busywaitmax = CDBA_BUSY_WAIT_MAX_DEFAULT;
+  cfg->nomutex = 0;
+  cfg->journalmode = NULL;
+  cfg->synchronous = NULL;
+  cfg->tempstore = NULL;
+  cfg->cachesize = CDBA_SQLITE3_SETTING_DEFAULT;
+  cfg->mmapsize = CDBA_SQLITE3_SETTING_DEFAULT;
+  cfg->pagesize = CDBA_SQLITE3_SETTING_DEFAULT;
+  cfg->walautocheckpoint = CDBA_SQLITE3_SETTING_DEFAULT;
+  cfg->readonly = 0;
+  cfg->immutable = 0;
+  cfg->sharedcache = 0;
+  cfg->uri = 0;
 #elif defined(DB_ODBC)
   cfg->dsn = NULL;
 #else
 #endif
+  cfg->statementcache = CDBA_STATEMENT_CACHE_DEFAULT_SIZE;
+  cfg->resultcache = 0;
+  cfg->resultcachettl = CDBA_RESULT_CACHE_DEFAULT_TTL;
+  cfg->stats = 1;
   return cfg;
 }
 
@@ -238,6 +446,9 @@ DLL_EXPORT_CDBALIB void cdba_config_cleanup (cdba_config cfg)
   /////TO DO
 #elif defined(DB_SQLITE3)
   free(cfg->file);
+  free(cfg->journalmode);
+  free(cfg->synchronous);
+  free(cfg->tempstore);
 #elif defined(DB_ODBC)
   free(cfg->dsn);
 #else
@@ -246,22 +457,273 @@ DLL_EXPORT_CDBALIB void cdba_config_cleanup (cdba_config cfg)
 
 ////////////////////////////////////////////////////////////////////////
 
+struct cdba_statement_cache_entry_struct {
+  char* sql;
+  size_t sqllen;
+  uint32_t hash;
+  cdba_prep_handle stmt;
+  int inuse;
+  struct cdba_statement_cache_entry_struct* hashnext;
+  struct cdba_statement_cache_entry_struct* lruprev;   //more recently used entry
+  struct cdba_statement_cache_entry_struct* lrunext;   //less recently used entry
+};
+
+static void cdba_statement_cache_flush (cdba_handle db);
+static void cdba_statement_cache_release (cdba_prep_handle stmt);
+
+//asynchronous operations
+#define CDBA_ASYNC_OP_NONE       0
+#define CDBA_ASYNC_OP_SQL        1
+#define CDBA_ASYNC_OP_SQL_RESULT 2      //discarding the result set of a SQL statement
+#define CDBA_ASYNC_OP_EXECUTE    3
+#define CDBA_ASYNC_OP_FETCH      4
+#define CDBA_ASYNC_OP_STORE      5      //buffering the result set of a prepared statement on the client
+#define CDBA_ASYNC_OP_SQL_NEXT   6      //moving to the next result of a SQL string with multiple statements
+
+struct cdba_async_worker_struct;
+static void cdba_async_worker_stop (cdba_handle db);
+static void cdba_result_cache_flush (cdba_handle db);
+static void cdba_result_cache_sql_executed (cdba_handle db, const char* sql, size_t sqllen);
+
+#if defined(DB_MYSQL)
+static void cdba_mysql_set_local_infile_handler (cdba_handle db);
+static void cdba_mysql_sql_executed (cdba_handle db, const char* sql, size_t sqllen);
+#elif defined(DB_SQLITE3)
+static void cdba_sqlite3_update_hook (void* data, int op, const char* dbname, const char* table, sqlite3_int64 rowid);
+#endif
+
 struct cdba_handle_struct
 {
+#ifdef CDBA_DRIVER
+  const struct cdba_driver_struct* driver;   //must be the first member
+#endif
 #if defined(DB_MYSQL)
   MYSQL* mysql_conn;
+  struct cdba_bulk_load_handle_struct* mysql_bulk;  //bulk loader whose data is served to LOAD DATA LOCAL INFILE
+  unsigned long mysql_autoinc_increment;            //auto_increment_increment setting of the session, 0 if not known yet
+  unsigned long mysql_autoinc_thread;               //connection the setting was read on, it is reset when reconnecting
 #elif defined(DB_FREETDS)
   CS_CONNECTION* freetds_conn;
 #elif defined(DB_SQLITE3)
   sqlite3* sqlite3_conn;
+  uint64_t busy_timeout_us;
+  uint64_t busy_wait_min_us;
+  uint64_t busy_wait_max_us;
+  uint64_t busy_start;
+  uint32_t busy_rng;
+  struct cdba_sql_tables_struct* sqlite3_written;   //tables reported by the update hook that weren't removed from the result cache yet
 #elif defined(DB_ODBC)
   SQLHDBC odbc_conn;
   cdba_library_handle dblib;
 #else
 #endif
   char* errmsg;
+  struct cdba_statement_cache_entry_struct** stmtcache_buckets;
+  size_t stmtcache_numbuckets;
+  struct cdba_statement_cache_entry_struct* stmtcache_mru;
+  struct cdba_statement_cache_entry_struct* stmtcache_lru;
+  cdba_statement_cache_stats stmtcache_stats;
+  struct cdba_result_cache_entry_struct** rescache_buckets;
+  size_t rescache_numbuckets;
+  struct cdba_result_cache_entry_struct* rescache_mru;
+  struct cdba_result_cache_entry_struct* rescache_lru;
+  uint64_t rescache_ttl_us;                         //time cached results stay valid, 0 if they don't expire
+  uint64_t rescache_generation;                     //incremented by each invalidation, results read meanwhile are not cached
+  char* rescache_key;                               //buffer for building cache keys
+  size_t rescache_keysize;
+  cdba_result_cache_stats rescache_stats;
+  cdba_busy_stats busystats;
+  cdba_stats stats;
+  int statstiming;
+  struct cdba_async_worker_struct* async_worker;    //worker thread running asynchronous operations, started on first use
+#ifdef CDBA_MYSQL_NONBLOCK
+  int mysql_async_op;                               //non-blocking operation in progress (CDBA_ASYNC_OP_*)
+  cdba_prep_handle mysql_async_stmt;
+  MYSQL_RES* mysql_async_result;
+  uint64_t mysql_async_start;
+#endif
 };
 
+#if defined(DB_SQLITE3)
+//wait before retrying when the database is busy or locked, returns non-zero to retry or zero to give up
+static int cdba_busy_wait (cdba_handle db, int count)
+{
+  uint64_t now;
+  uint64_t elapsed;
+  uint64_t wait;
+  now = cdba_get_time_us();
+  if (count == 0) {
+    db->busy_start = now;
+    db->busystats.events++;
+  }
+  elapsed = now - db->busy_start;
+  if (elapsed >= db->busy_timeout_us) {
+    db->busystats.timeouts++;
+    return 0;
+  }
+  //exponential backoff with random jitter between half and the full wait time, without waiting past the deadline
+  wait = db->busy_wait_min_us << (count < 20 ? count : 20);
+  if (wait > db->busy_wait_max_us)
+    wait = db->busy_wait_max_us;
+  db->busy_rng ^= db->busy_rng << 13;
+  db->busy_rng ^= db->busy_rng >> 17;
+  db->busy_rng ^= db->busy_rng << 5;
+  wait = wait / 2 + db->busy_rng % (wait / 2 + 1);
+  if (wait > db->busy_timeout_us - elapsed)
+    wait = db->busy_timeout_us - elapsed;
+  SLEEP_MICROSECONDS(wait)
+  db->busystats.retries++;
+  db->busystats.wait_us += cdba_get_time_us() - now;
+  return 1;
+}
+
+static int cdba_sqlite3_busy_handler (void* data, int count)
+{
+  return cdba_busy_wait((cdba_handle)data, count);
+}
+
+//step SQLite statement, retrying when a table is locked (busy database files are handled by the busy handler)
+static int cdba_sqlite3_step (cdba_handle db, sqlite3_stmt* stmt)
+{
+  int status;
+  int count = 0;
+  while ((status = sqlite3_step(stmt)) == SQLITE_LOCKED && cdba_busy_wait(db, count++))
+    ;
+  return status;
+}
+
+//execute SQL statement without results, retrying when a table is locked
+static int cdba_sqlite3_exec (cdba_handle db, const char* sql)
+{
+  int status;
+  int count = 0;
+  while ((status = sqlite3_exec(db->sqlite3_conn, sql, NULL, NULL, NULL)) == SQLITE_LOCKED && cdba_busy_wait(db, count++))
+    ;
+  return status;
+}
+
+//check if setting value is one of the allowed values (case insensitive)
+static int cdba_sqlite3_setting_allowed (const char* value, const char* const* allowed)
+{
+  const char* p;
+  const char* q;
+  for (; *allowed; allowed++) {
+    for (p = value, q = *allowed; *p && toupper((unsigned char)*p) == *q; p++, q++)
+      ;
+    if (!*p && !*q)
+      return 1;
+  }
+  return 0;
+}
+
+//validate the settings that are applied with PRAGMA statements before opening the database
+static int cdba_sqlite3_check_settings (struct cdba_config_struct* cfg)
+{
+  static const char* const journalmodes[] = {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF", NULL};
+  static const char* const synchronousmodes[] = {"OFF", "NORMAL", "FULL", "EXTRA", "0", "1", "2", "3", NULL};
+  static const char* const tempstores[] = {"DEFAULT", "FILE", "MEMORY", "0", "1", "2", NULL};
+  if (cfg->journalmode && !cdba_sqlite3_setting_allowed(cfg->journalmode, journalmodes))
+    return -1;
+  if (cfg->synchronous && !cdba_sqlite3_setting_allowed(cfg->synchronous, synchronousmodes))
+    return -1;
+  if (cfg->tempstore && !cdba_sqlite3_setting_allowed(cfg->tempstore, tempstores))
+    return -1;
+  //page size must be a power of two between 512 and 65536
+  if (cfg->pagesize != CDBA_SQLITE3_SETTING_DEFAULT && (cfg->pagesize < 512 || cfg->pagesize > 65536 || (cfg->pagesize & (cfg->pagesize - 1)) != 0))
+    return -1;
+  if (cfg->mmapsize != CDBA_SQLITE3_SETTING_DEFAULT && cfg->mmapsize < 0)
+    return -1;
+  return 0;
+}
+
+//get file name to open, immutable databases are opened with an URI filename
+static char* cdba_sqlite3_get_filename (struct cdba_config_struct* cfg)
+{
+  static const char* hexdigits = "0123456789ABCDEF";
+  const char* p;
+  char* result;
+  char* q;
+  if (!cfg->file)
+    return NULL;
+  if (!cfg->immutable)
+    return strdup(cfg->file);
+  if ((result = (char*)malloc(strlen(cfg->file) * 3 + 20)) == NULL)
+    return NULL;
+  //append the parameter to filenames that already are URIs, otherwise escape the characters that have a meaning in URIs
+  if (cfg->uri && strncmp(cfg->file, "file:", 5) == 0) {
+    sprintf(result, "%s%cimmutable=1", cfg->file, (strchr(cfg->file, '?') ? '&' : '?'));
+    return result;
+  }
+  strcpy(result, "file:");
+  q = result + 5;
+  for (p = cfg->file; *p; p++) {
+    if (*p == '%' || *p == '?' || *p == '#') {
+      *q++ = '%';
+      *q++ = hexdigits[(unsigned char)*p >> 4];
+      *q++ = hexdigits[(unsigned char)*p & 0x0F];
+    } else {
+      *q++ = *p;
+    }
+  }
+  strcpy(q, "?immutable=1");
+  return result;
+}
+
+//apply the settings that are set with PRAGMA statements after opening the database
+static int cdba_sqlite3_apply_settings (cdba_handle db, struct cdba_config_struct* cfg)
+{
+  char sql[64];
+  //the page size must be set before switching to WAL mode
+  if (cfg->pagesize != CDBA_SQLITE3_SETTING_DEFAULT) {
+    snprintf(sql, sizeof(sql), "PRAGMA page_size=%lld", (long long)cfg->pagesize);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->journalmode) {
+    snprintf(sql, sizeof(sql), "PRAGMA journal_mode=%s", cfg->journalmode);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->synchronous) {
+    snprintf(sql, sizeof(sql), "PRAGMA synchronous=%s", cfg->synchronous);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->cachesize != CDBA_SQLITE3_SETTING_DEFAULT) {
+    snprintf(sql, sizeof(sql), "PRAGMA cache_size=%lld", (long long)cfg->cachesize);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->mmapsize != CDBA_SQLITE3_SETTING_DEFAULT) {
+    snprintf(sql, sizeof(sql), "PRAGMA mmap_size=%lld", (long long)cfg->mmapsize);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->tempstore) {
+    snprintf(sql, sizeof(sql), "PRAGMA temp_store=%s", cfg->tempstore);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  if (cfg->walautocheckpoint != CDBA_SQLITE3_SETTING_DEFAULT) {
+    snprintf(sql, sizeof(sql), "PRAGMA wal_autocheckpoint=%lld", (long long)cfg->walautocheckpoint);
+    if (cdba_sqlite3_exec(db, sql) != SQLITE_OK)
+      return -1;
+  }
+  return 0;
+}
+#endif
+
+//get the time in microseconds results stay in the result cache for a ttl in milliseconds, 0 if they don't expire
+static uint64_t cdba_result_cache_ttl_us (db_int ttl)
+{
+#if !defined(DB_SQLITE3)
+  //only SQLite3 reports writes done by triggers or to the tables underlying a view, so cached results must expire on other databases
+  if (ttl <= 0)
+    ttl = CDBA_RESULT_CACHE_DEFAULT_TTL;
+#endif
+  return (ttl > 0 ? (uint64_t)ttl * 1000 : 0);
+}
+
 DLL_EXPORT_CDBALIB cdba_handle cdba_open (cdba_library_handle dblib, const char* configtext)
 {
   struct cdba_config_struct* cfg;
@@ -274,20 +736,59 @@ DLL_EXPORT_CDBALIB cdba_handle cdba_open (cdba_library_handle dblib, const char*
     cdba_config_cleanup(cfg);
     return NULL;
   }
+#ifdef CDBA_DRIVER
+  db->driver = &CDBA_DRIVER_TABLE;
+#endif
   db->errmsg = NULL;
+  db->stmtcache_buckets = NULL;
+  db->stmtcache_numbuckets = 0;
+  db->stmtcache_mru = NULL;
+  db->stmtcache_lru = NULL;
+  memset(&db->stmtcache_stats, 0, sizeof(db->stmtcache_stats));
+  db->rescache_buckets = NULL;
+  db->rescache_numbuckets = 0;
+  db->rescache_mru = NULL;
+  db->rescache_lru = NULL;
+  db->rescache_ttl_us = cdba_result_cache_ttl_us(cfg->resultcachettl);
+  db->rescache_generation = 0;
+  db->rescache_key = NULL;
+  db->rescache_keysize = 0;
+  memset(&db->rescache_stats, 0, sizeof(db->rescache_stats));
+  db->rescache_stats.capacity = (cfg->resultcache > 0 ? (size_t)cfg->resultcache : 0);
+  memset(&db->busystats, 0, sizeof(db->busystats));
+  memset(&db->stats, 0, sizeof(db->stats));
+  db->statstiming = (cfg->stats != 0);
+  db->async_worker = NULL;
+  db->stmtcache_stats.capacity = (cfg->statementcache > 0 ? (size_t)cfg->statementcache : 0);
 #if defined(DB_MYSQL)
   my_bool reconnect = 1;
+  unsigned int localinfile = 1;
   if ((db->mysql_conn = mysql_init(NULL)) == NULL) {
     free(db);
     return NULL;
   }
   mysql_set_character_set(db->mysql_conn, "utf8");
   mysql_options(db->mysql_conn, MYSQL_OPT_RECONNECT, &reconnect);
+  //LOAD DATA LOCAL INFILE is used by the bulk loader, the handler installed after connecting never reads local files
+  mysql_options(db->mysql_conn, MYSQL_OPT_LOCAL_INFILE, &localinfile);
+  db->mysql_bulk = NULL;
+  db->mysql_autoinc_increment = 0;
+  db->mysql_autoinc_thread = 0;
+#ifdef CDBA_MYSQL_NONBLOCK
+  //allow the non-blocking API to be used on this connection (blocking calls keep working)
+  mysql_options(db->mysql_conn, MYSQL_OPT_NONBLOCK, 0);
+  db->mysql_async_op = CDBA_ASYNC_OP_NONE;
+  db->mysql_async_stmt = NULL;
+  db->mysql_async_result = NULL;
+  db->mysql_async_start = 0;
+#endif
   //mysql_options(db->mysql_conn, SSL_MODE_PREFERRED, );
-  if (mysql_real_connect(db->mysql_conn, cfg->host, cfg->login, cfg->password, cfg->database, cfg->port, NULL, 0) == NULL) {
+  //multiple statements are allowed once for the connection instead of switching the server option on and off for each cdba_multiple_sql()
+  if (mysql_real_connect(db->mysql_conn, cfg->host, cfg->login, cfg->password, cfg->database, cfg->port, NULL, CLIENT_MULTI_STATEMENTS) == NULL) {
     free(db);
     return NULL;
   }
+  cdba_mysql_set_local_infile_handler(db);
 #elif defined(DB_FREETDS)
 #define FREETDS_HOST "10.0.0.232"
 //#define FREETDS_INST "SQL2016P001"
@@ -348,7 +849,45 @@ DLL_EXPORT_CDBALIB cdba_handle cdba_open (cdba_library_handle dblib, const char*
   free(dbhostinstance);
 #endif
 #elif defined(DB_SQLITE3)
-  if (sqlite3_open(cfg->file, &db->sqlite3_conn) != SQLITE_OK) {
+  char* filename;
+  int flags;
+  if (cdba_sqlite3_check_settings(cfg) != 0 || (filename = cdba_sqlite3_get_filename(cfg)) == NULL) {
+    cdba_config_cleanup(cfg);
+    free(db);
+    return NULL;
+  }
+  flags = (cfg->readonly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+  if (cfg->uri || cfg->immutable)
+    flags |= SQLITE_OPEN_URI;
+  if (cfg->sharedcache)
+    flags |= SQLITE_OPEN_SHAREDCACHE;
+  //connections owned by a single thread at a time don't need the SQLite3 connection mutexes
+  if (cfg->nomutex)
+    flags |= SQLITE_OPEN_NOMUTEX;
+  if (sqlite3_open_v2(filename, &db->sqlite3_conn, flags, NULL) != SQLITE_OK) {
+    sqlite3_close(db->sqlite3_conn);
+    cdba_config_cleanup(cfg);
+    free(filename);
+    free(db);
+    return NULL;
+  }
+  free(filename);
+  //wait for locks with exponential backoff instead of failing immediately
+  db->busy_timeout_us = (cfg->busytimeout > 0 ? (uint64_t)cfg->busytimeout * 1000 : 0);
+  db->busy_wait_min_us = (cfg->busywaitmin > 0 ? (uint64_t)cfg->busywaitmin * 1000 : 1000);
+  db->busy_wait_max_us = (cfg->busywaitmax > 0 ? (uint64_t)cfg->busywaitmax * 1000 : db->busy_wait_min_us);
+  db->busy_start = 0;
+  db->busy_rng = (uint32_t)(uintptr_t)db ^ (uint32_t)cdba_get_time_us();
+  if (!db->busy_rng)
+    db->busy_rng = 1;
+  sqlite3_busy_handler(db->sqlite3_conn, cdba_sqlite3_busy_handler, db);
+  //writes to tables (including those done by triggers and foreign key actions) invalidate cached results
+  db->sqlite3_written = NULL;
+  if (db->rescache_stats.capacity > 0)
+    sqlite3_update_hook(db->sqlite3_conn, cdba_sqlite3_update_hook, db);
+  if (cdba_sqlite3_apply_settings(db, cfg) != 0) {
+    sqlite3_close(db->sqlite3_conn);
+    cdba_config_cleanup(cfg);
     free(db);
     return NULL;
   }
@@ -384,6 +923,10 @@ DLL_EXPORT_CDBALIB void cdba_close (cdba_handle db)
 {
   if (!db)
     return;
+  cdba_async_worker_stop(db);
+  cdba_statement_cache_flush(db);
+  cdba_set_result_cache(db, 0, 0);
+  free(db->rescache_key);
   if (db->errmsg)
     free(db->errmsg);
 #if defined(DB_MYSQL)
@@ -402,6 +945,110 @@ DLL_EXPORT_CDBALIB void cdba_close (cdba_handle db)
   free(db);
 }
 
+DLL_EXPORT_CDBALIB void cdba_get_busy_stats (cdba_handle db, cdba_busy_stats* stats)
+{
+  *stats = db->busystats;
+}
+
+DLL_EXPORT_CDBALIB void cdba_get_stats (cdba_handle db, cdba_stats* stats)
+{
+  *stats = db->stats;
+}
+
+DLL_EXPORT_CDBALIB void cdba_reset_stats (cdba_handle db)
+{
+  memset(&db->stats, 0, sizeof(db->stats));
+}
+
+//start time of an operation for statistics, 0 when latency is not measured
+#define CDBA_STATS_START(db) ((db)->statstiming ? cdba_get_time_us() : 0)
+
+//latency histogram bucket for a duration in microseconds
+static unsigned int cdba_stats_histogram_bucket (uint64_t us)
+{
+  unsigned int bucket = 0;
+  while (us > 0 && bucket < CDBA_STATS_HISTOGRAM_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+//number of rows changed through the connection so far including changes made by triggers, a difference before and after an operation means it changed rows (SQLite3 only)
+static uint64_t cdba_stats_total_changes (cdba_handle db)
+{
+#if defined(DB_SQLITE3)
+  return (uint64_t)sqlite3_total_changes(db->sqlite3_conn);
+#else
+  (void)db;
+  return 0;
+#endif
+}
+
+//number of rows affected by the last SQL statement executed on the connection
+static uint64_t cdba_stats_rows_affected (cdba_handle db, uint64_t changes)
+{
+#if defined(DB_MYSQL)
+  my_ulonglong rows;
+  (void)changes;
+  if (mysql_field_count(db->mysql_conn) == 0 && (rows = mysql_affected_rows(db->mysql_conn)) != (my_ulonglong)-1)
+    return rows;
+  return 0;
+#elif defined(DB_SQLITE3)
+  //sqlite3_changes() is left unchanged by other statements and doesn't count rows changed by triggers
+  return (cdba_stats_total_changes(db) != changes ? (uint64_t)sqlite3_changes(db->sqlite3_conn) : 0);
+#else
+  (void)db;
+  (void)changes;
+  return 0;
+#endif
+}
+
+//record executions in the connection statistics and in the statement statistics (if not NULL)
+static void cdba_stats_record_execute (cdba_handle db, cdba_stats* stmtstats, uint64_t start, uint64_t executions, uint64_t errors, uint64_t rowsaffected, uint64_t busyretries)
+{
+  cdba_stats* stats[2] = {&db->stats, stmtstats};
+  uint64_t us = 0;
+  unsigned int bucket = 0;
+  int i;
+  if (start) {
+    us = cdba_get_time_us() - start;
+    bucket = cdba_stats_histogram_bucket(us);
+  }
+  for (i = 0; i < 2 && stats[i]; i++) {
+    stats[i]->executions += executions;
+    stats[i]->errors += errors;
+    stats[i]->rows_affected += rowsaffected;
+    stats[i]->busy_retries += busyretries;
+    if (start) {
+      stats[i]->execute_us += us;
+      if (us > stats[i]->execute_max_us)
+        stats[i]->execute_max_us = us;
+      stats[i]->histogram[bucket]++;
+    }
+  }
+}
+
+//record fetched rows in the connection statistics and in the statement statistics (if not NULL)
+static void cdba_stats_record_fetch (cdba_handle db, cdba_stats* stmtstats, uint64_t start, uint64_t rows, uint64_t errors, uint64_t busyretries)
+{
+  cdba_stats* stats[2] = {&db->stats, stmtstats};
+  uint64_t us = 0;
+  int i;
+  if (start)
+    us = cdba_get_time_us() - start;
+  for (i = 0; i < 2 && stats[i]; i++) {
+    stats[i]->rows_fetched += rows;
+    stats[i]->errors += errors;
+    stats[i]->busy_retries += busyretries;
+    if (start) {
+      stats[i]->fetch_us += us;
+      if (us > stats[i]->fetch_max_us)
+        stats[i]->fetch_max_us = us;
+    }
+  }
+}
+
 DLL_EXPORT_CDBALIB void cdba_set_error (cdba_handle db, const char* errmsg)
 {
   if (db->errmsg)
@@ -410,7 +1057,7 @@ DLL_EXPORT_CDBALIB void cdba_set_error (cdba_handle db, const char* errmsg)
 }
 
 #if defined(DB_FREETDS)
-void cdba_set_freetds_error (cdba_handle db)
+static void cdba_set_freetds_error (cdba_handle db)
 {
   CS_CLIENTMSG client_errmsg;
   CS_SERVERMSG server_errmsg;
@@ -426,7 +1073,7 @@ void cdba_set_freetds_error (cdba_handle db)
 #endif
 
 #if defined(DB_ODBC)
-void cdba_set_odbc_error (cdba_handle db, SQLHSTMT stmt, SQLSMALLINT handletype)
+static void cdba_set_odbc_error (cdba_handle db, SQLHSTMT stmt, SQLSMALLINT handletype)
 {
   SQLSMALLINT i;
   SQLSMALLINT len;
@@ -458,23 +1105,34 @@ DLL_EXPORT_CDBALIB const char* cdba_get_error (cdba_handle db)
   return db->errmsg;
 }
 
-DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql)
-{
 #if defined(DB_MYSQL)
+//discard the current and all following results of the last query, returns zero on success or -1 if one of the statements failed
+static int cdba_mysql_discard_results (cdba_handle db)
+{
   int status;
-  MYSQL_RES* res;
-  if ((status = mysql_query(db->mysql_conn, sql)) != 0) {
+  do {
+    mysql_free_result(mysql_use_result(db->mysql_conn));
+  } while ((status = mysql_next_result(db->mysql_conn)) == 0);
+  if (status > 0) {
     cdba_set_error(db, mysql_error(db->mysql_conn));
     return -1;
   }
-  res = mysql_use_result(db->mysql_conn);
-  mysql_free_result(res);
   return 0;
+}
+#endif
+
+static int cdba_sql_execute (cdba_handle db, const char* sql)
+{
+#if defined(DB_MYSQL)
+  if (mysql_query(db->mysql_conn, sql) != 0) {
+    cdba_set_error(db, mysql_error(db->mysql_conn));
+    return -1;
+  }
+  return cdba_mysql_discard_results(db);
 #elif defined(DB_FREETDS)
-  return cdba_sql_with_length(db, sql, (sql ? strlen(sql) : 0));
+  return cdba_sql_with_length_execute(db, sql, (sql ? strlen(sql) : 0));
 #elif defined(DB_SQLITE3)
   int status;
-  int i;
   const char* sqlnext;
   sqlite3_stmt* stmt;
 	if ((status = sqlite3_prepare_v2(db->sqlite3_conn, sql, -1, &stmt, &sqlnext)) != SQLITE_OK) {
@@ -486,11 +1144,7 @@ DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql)
     sqlite3_finalize(stmt);
 	  return -3;
 	}
-  status = SQLITE_ERROR;
-  i = 0;
-  while (i++ < RETRY_ATTEMPTS && ((status = sqlite3_step(stmt)) == SQLITE_BUSY || status == SQLITE_LOCKED)) {
-    WAIT_BEFORE_RETRY(RETRY_WAIT_TIME)
-  }
+  status = cdba_sqlite3_step(db, stmt);
   sqlite3_finalize(stmt);
   if (status != SQLITE_DONE && status != SQLITE_ROW) {
     cdba_set_error(db, sqlite3_errmsg(db->sqlite3_conn));
@@ -518,18 +1172,14 @@ DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql)
 #endif
 }
 
-DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, size_t sqllen)
+static int cdba_sql_with_length_execute (cdba_handle db, const char* sql, size_t sqllen)
 {
 #if defined(DB_MYSQL)
-  int status;
-  MYSQL_RES* res;
-  if ((status = mysql_real_query(db->mysql_conn, sql, sqllen)) != 0) {
+  if (mysql_real_query(db->mysql_conn, sql, sqllen) != 0) {
     cdba_set_error(db, mysql_error(db->mysql_conn));
     return -1;
   }
-  res = mysql_use_result(db->mysql_conn);
-  mysql_free_result(res);
-  return 0;
+  return cdba_mysql_discard_results(db);
 #elif defined(DB_FREETDS)
   CS_INT rc;
   CS_COMMAND* stmt;
@@ -563,7 +1213,6 @@ DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, si
   return 0;
 #elif defined(DB_SQLITE3)
   int status;
-  int i;
   const char* sqlnext;
   sqlite3_stmt* stmt;
 	if ((status = sqlite3_prepare_v2(db->sqlite3_conn, sql, sqllen, &stmt, &sqlnext)) != SQLITE_OK) {
@@ -575,11 +1224,7 @@ DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, si
     sqlite3_finalize(stmt);
 	  return -3;
 	}
-  status = SQLITE_ERROR;
-  i = 0;
-  while (i++ < RETRY_ATTEMPTS && ((status = sqlite3_step(stmt)) == SQLITE_BUSY || status == SQLITE_LOCKED)) {
-    WAIT_BEFORE_RETRY(RETRY_WAIT_TIME)
-  }
+  status = cdba_sqlite3_step(db, stmt);
   sqlite3_finalize(stmt);
   if (status != SQLITE_DONE && status != SQLITE_ROW) {
     cdba_set_error(db, sqlite3_errmsg(db->sqlite3_conn));
@@ -607,27 +1252,46 @@ DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, si
 #endif
 }
 
-DLL_EXPORT_CDBALIB int cdba_multiple_sql (cdba_handle db, const char* sql)
+#if !defined(DB_MYSQL) && !defined(DB_SQLITE3)
+//get length of the first of multiple SQL statements separated by semicolon (not including the semicolon)
+static size_t cdba_sql_statement_length (const char* sql)
+{
+  const char* q;
+  size_t inbrackets = 0;
+  size_t insinglequotes = 0;
+  q = sql;
+  while (*q) {
+    if (*q == '\'') {
+      insinglequotes = ~insinglequotes;
+    } else if (!insinglequotes) {
+      if (*q == '(') {
+        inbrackets++;
+      } else if (inbrackets > 0 && *q == ')') {
+        inbrackets--;
+      } else if (*q == ';') {
+        break;
+      }
+    }
+    q++;
+  }
+  return q - sql;
+}
+#endif
+
+static int cdba_multiple_sql_execute (cdba_handle db, const char* sql)
 {
 #if defined(DB_MYSQL)
-  int status;
-  MYSQL_RES* res;
-  mysql_set_server_option(db->mysql_conn, MYSQL_OPTION_MULTI_STATEMENTS_ON);
-  if ((status = mysql_query(db->mysql_conn, sql)) != 0) {
+  //all statements are sent in one round trip, the first failing statement ends the results
+  if (mysql_query(db->mysql_conn, sql) != 0) {
     cdba_set_error(db, mysql_error(db->mysql_conn));
-  } else {
-    res = mysql_use_result(db->mysql_conn);
-    mysql_free_result(res);
-    status = 0;
+    return -1;
   }
-  mysql_set_server_option(db->mysql_conn, MYSQL_OPTION_MULTI_STATEMENTS_OFF);
-  return status;
+  return cdba_mysql_discard_results(db);
 /*
 #elif defined(DB_FREETDS)
 */
 #elif defined(DB_SQLITE3)
   int status;
-  int i;
   const char* sqlnext;
   sqlite3_stmt* stmt;
   sqlnext = sql;
@@ -640,11 +1304,7 @@ DLL_EXPORT_CDBALIB int cdba_multiple_sql (cdba_handle db, const char* sql)
       cdba_set_error(db, sqlite3_errmsg(db->sqlite3_conn));
       return -2;
     }
-    status = SQLITE_ERROR;
-    i = 0;
-    while (i++ < RETRY_ATTEMPTS && ((status = sqlite3_step(stmt)) == SQLITE_BUSY || status == SQLITE_LOCKED)) {
-      WAIT_BEFORE_RETRY(RETRY_WAIT_TIME)
-    }
+    status = cdba_sqlite3_step(db, stmt);
     sqlite3_finalize(stmt);
     if (status != SQLITE_DONE && status != SQLITE_ROW) {
       cdba_set_error(db, sqlite3_errmsg(db->sqlite3_conn));
@@ -671,61 +1331,90 @@ DLL_EXPORT_CDBALIB int cdba_multiple_sql (cdba_handle db, const char* sql)
   int status;
   const char* p;
   const char* q;
-  size_t inbrackets = 0;
-  size_t insinglequotes = 0;
   p = sql;
   //loop through queries
   while (p && *p) {
     //skip spaces
     while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
       p++;
-    q = p;
+    if (!*p)
+      break;
     //find next semicolon or end
-    while (*q) {
-      if (*q == '\'') {
-        insinglequotes = ~insinglequotes;
-      } else if (!insinglequotes) {
-        if (*q == '(') {
-          inbrackets++;
-        } else if (inbrackets > 0 && *q == ')') {
-          inbrackets--;
-        } else if (*q == ';') {
-          break;
-        }
-      }
+    q = p + cdba_sql_statement_length(p);
+    if ((status = cdba_sql_with_length_execute(db, p, q - p)) != 0)
+      return status;
+    if (*q)
       q++;
-    }
-    if (!*q || *q == ';') {
-      if ((status = cdba_sql_with_length(db, p, q - p)) != 0)
-        return status;
-      if (*q)
-        q++;
-      p = q;
-    }
+    p = q;
   }
   return 0;
 #endif
 }
 
-DLL_EXPORT_CDBALIB void cdba_begin_transaction (cdba_handle db)
+DLL_EXPORT_CDBALIB int cdba_sql (cdba_handle db, const char* sql)
 {
-/*
+  int status;
+  uint64_t start = CDBA_STATS_START(db);
+  uint64_t retries = db->busystats.retries;
+  uint64_t changes = cdba_stats_total_changes(db);
+  status = cdba_sql_execute(db, sql);
+  cdba_stats_record_execute(db, NULL, start, 1, (status != 0), (status == 0 ? cdba_stats_rows_affected(db, changes) : 0), db->busystats.retries - retries);
 #if defined(DB_MYSQL)
-  mysql_autocommit(db->sqlite3_conn, 0);
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-#elif defined(DB_ODBC)
-#else
-#endif
-*/
-#if DB_ODBC
-  SQLSetConnectAttr(db->odbc_conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
-#else
-  cdba_sql(db, "BEGIN");
+  cdba_mysql_sql_executed(db, sql, (sql ? strlen(sql) : 0));
 #endif
+  cdba_result_cache_sql_executed(db, sql, (sql ? strlen(sql) : 0));
+  return status;
 }
 
-DLL_EXPORT_CDBALIB void cdba_commit_transaction (cdba_handle db)
+DLL_EXPORT_CDBALIB int cdba_sql_with_length (cdba_handle db, const char* sql, size_t sqllen)
+{
+  int status;
+  uint64_t start = CDBA_STATS_START(db);
+  uint64_t retries = db->busystats.retries;
+  uint64_t changes = cdba_stats_total_changes(db);
+  status = cdba_sql_with_length_execute(db, sql, sqllen);
+  cdba_stats_record_execute(db, NULL, start, 1, (status != 0), (status == 0 ? cdba_stats_rows_affected(db, changes) : 0), db->busystats.retries - retries);
+#if defined(DB_MYSQL)
+  cdba_mysql_sql_executed(db, sql, sqllen);
+#endif
+  cdba_result_cache_sql_executed(db, sql, sqllen);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB int cdba_multiple_sql (cdba_handle db, const char* sql)
+{
+  int status;
+  uint64_t start = CDBA_STATS_START(db);
+  uint64_t retries = db->busystats.retries;
+  uint64_t changes = cdba_stats_total_changes(db);
+  status = cdba_multiple_sql_execute(db, sql);
+  cdba_stats_record_execute(db, NULL, start, 1, (status != 0), (status == 0 ? cdba_stats_rows_affected(db, changes) : 0), db->busystats.retries - retries);
+#if defined(DB_MYSQL)
+  cdba_mysql_sql_executed(db, sql, (sql ? strlen(sql) : 0));
+#endif
+  cdba_result_cache_sql_executed(db, sql, (sql ? strlen(sql) : 0));
+  return status;
+}
+
+DLL_EXPORT_CDBALIB void cdba_begin_transaction (cdba_handle db)
+{
+/*
+#if defined(DB_MYSQL)
+  mysql_autocommit(db->sqlite3_conn, 0);
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+#elif defined(DB_ODBC)
+#else
+#endif
+*/
+#if DB_ODBC
+  SQLSetConnectAttr(db->odbc_conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
+#else
+  cdba_sql(db, "BEGIN");
+#endif
+}
+
+DLL_EXPORT_CDBALIB void cdba_commit_transaction (cdba_handle db)
 {
 /*
 #if defined(DB_MYSQL)
@@ -759,6 +1448,7 @@ DLL_EXPORT_CDBALIB void cdba_rollback_transaction (cdba_handle db)
 #if defined(DB_ODBC)
   SQLEndTran(SQL_HANDLE_DBC, db->odbc_conn, SQL_ROLLBACK);
   SQLSetConnectAttr(db->odbc_conn, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_ON, SQL_IS_UINTEGER);
+  cdba_result_cache_sql_executed(db, "ROLLBACK", 8);
 #else
   cdba_sql(db, "ROLLBACK");
 #endif
@@ -781,7 +1471,242 @@ struct mysql_resultbindinfo_struct {
 };
 #endif
 
+//internal argument type for values read in chunks while executing
+#define CDBA_PARAM_TYPE_STREAM ((db_int)-1)
+
+//size of chunks in which streamed values are read and sent
+#define CDBA_STREAM_CHUNK_SIZE 65536
+
+struct cdba_param_buffer_struct {
+  db_int type;
+  union {
+    long long intval;
+    double floatval;
+  } value;
+  char* text;                                       //text value or buffer for chunks of a streamed value
+  size_t textsize;
+  size_t len;
+  cdba_stream_read_fn reader;
+  void* streamdata;
+  size_t streamlen;                                 //total length of a streamed value or CDBA_NTS if unknown
+#if defined(DB_MYSQL)
+  unsigned long mysql_len;
+#elif defined(DB_ODBC)
+  SQLLEN odbc_len;
+  SQLULEN odbc_colsize;
+#endif
+  int bound;
+};
+
+static void cdba_param_buffers_invalidate (struct cdba_param_buffer_struct* params, int numargs)
+{
+  int i;
+  if (!params)
+    return;
+  for (i = 0; i < numargs; i++)
+    params[i].bound = 0;
+}
+
+static void cdba_param_buffers_clear (struct cdba_param_buffer_struct* params, int numargs)
+{
+  int i;
+  if (!params)
+    return;
+  //keep the text buffers for reuse but forget the values
+  for (i = 0; i < numargs; i++) {
+    params[i].type = CDBA_TYPE_NULL;
+    params[i].bound = 0;
+  }
+}
+
+static void cdba_param_buffers_free (struct cdba_param_buffer_struct* params, int numargs)
+{
+  int i;
+  if (!params)
+    return;
+  for (i = 0; i < numargs; i++)
+    free(params[i].text);
+  free(params);
+}
+
+//make sure the buffer of an argument can hold at least size bytes
+static char* cdba_param_buffer_reserve (cdba_prep_handle stmt, struct cdba_param_buffer_struct* param, size_t size)
+{
+  char* text;
+  if (size > param->textsize) {
+    if ((text = (char*)realloc(param->text, size)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return NULL;
+    }
+    param->text = text;
+    param->textsize = size;
+  }
+  return param->text;
+}
+
+#if defined(DB_MYSQL) || defined(DB_ODBC)
+struct cdba_column_buffer_struct {
+  char* data;
+  size_t size;
+  size_t len;
+  int is_null;
+  unsigned long row;
+#if defined(DB_ODBC)
+  unsigned long chunkrow;                           //row being read in chunks with cdba_prep_get_column_chunk()
+  size_t chunkpos;                                  //bytes already read with SQLGetData() for chunkrow
+  SQLSMALLINT ctype;                                //C type used to retrieve the value (SQL_C_CHAR or SQL_C_BINARY), 0 until known
+#endif
+};
+
+static struct cdba_column_buffer_struct* cdba_column_buffers_allocate (int numcols)
+{
+  struct cdba_column_buffer_struct* colbuf;
+  if (numcols <= 0)
+    return NULL;
+  if ((colbuf = (struct cdba_column_buffer_struct*)malloc(sizeof(struct cdba_column_buffer_struct) * numcols)) == NULL)
+    return NULL;
+  memset(colbuf, 0, sizeof(struct cdba_column_buffer_struct) * numcols);
+  return colbuf;
+}
+
+static void cdba_column_buffers_free (struct cdba_column_buffer_struct* colbuf, int numcols)
+{
+  int i;
+  if (!colbuf)
+    return;
+  for (i = 0; i < numcols; i++)
+    free(colbuf[i].data);
+  free(colbuf);
+}
+
+static int cdba_column_buffer_reserve (struct cdba_column_buffer_struct* buf, size_t size)
+{
+  char* data;
+  if (size <= buf->size)
+    return 0;
+  if ((data = (char*)realloc(buf->data, size)) == NULL)
+    return -1;
+  buf->data = data;
+  buf->size = size;
+  return 0;
+}
+#endif
+
+static char* cdba_copy_text (const char* data, size_t len)
+{
+  char* result;
+  if (!data)
+    return NULL;
+  if ((result = (char*)malloc(len + 1)) == NULL)
+    return NULL;
+  memcpy(result, data, len);
+  result[len] = 0;
+  return result;
+}
+
+//arena allocator for values returned by a prepared statement, memory is recycled in one go instead of being freed one value at a time
+struct cdba_arena_block_struct {
+  struct cdba_arena_block_struct* next;
+  size_t size;
+  size_t used;
+};
+
+struct cdba_arena_struct {
+  struct cdba_arena_block_struct* first;
+  struct cdba_arena_block_struct* current;
+  size_t blocksize;
+  cdba_arena_stats stats;
+};
+
+//data of arena blocks follows the block header, aligned for any type
+#define CDBA_ARENA_ALIGN(n) (((n) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+#define CDBA_ARENA_BLOCK_DATA(block) ((char*)(block) + CDBA_ARENA_ALIGN(sizeof(struct cdba_arena_block_struct)))
+
+static void cdba_arena_free (struct cdba_arena_struct* arena)
+{
+  struct cdba_arena_block_struct* block;
+  if (!arena)
+    return;
+  while ((block = arena->first) != NULL) {
+    arena->first = block->next;
+    free(block);
+  }
+  free(arena);
+}
+
+static void* cdba_arena_alloc (struct cdba_arena_struct* arena, size_t size)
+{
+  struct cdba_arena_block_struct* block;
+  struct cdba_arena_block_struct** last;
+  size_t blocksize;
+  size = CDBA_ARENA_ALIGN(size);
+  //use the first of the remaining blocks with enough room, blocks are kept when the arena is recycled
+  last = &arena->first;
+  for (block = arena->current; block; block = block->next) {
+    if (block->size - block->used >= size)
+      break;
+  }
+  if (!block) {
+    blocksize = (size > arena->blocksize ? size : arena->blocksize);
+    if ((block = (struct cdba_arena_block_struct*)malloc(CDBA_ARENA_ALIGN(sizeof(struct cdba_arena_block_struct)) + blocksize)) == NULL)
+      return NULL;
+    block->next = NULL;
+    block->size = blocksize;
+    block->used = 0;
+    while (*last)
+      last = &(*last)->next;
+    *last = block;
+    arena->stats.capacity += blocksize;
+    arena->stats.blocks++;
+  }
+  arena->current = block;
+  block->used += size;
+  arena->stats.used += size;
+  if (arena->stats.used > arena->stats.highwater)
+    arena->stats.highwater = arena->stats.used;
+  arena->stats.allocations++;
+  return CDBA_ARENA_BLOCK_DATA(block) + block->used - size;
+}
+
+static void cdba_arena_recycle (struct cdba_arena_struct* arena)
+{
+  struct cdba_arena_block_struct* block;
+  if (!arena || arena->stats.used == 0)
+    return;
+  for (block = arena->first; block; block = block->next)
+    block->used = 0;
+  arena->current = arena->first;
+  arena->stats.used = 0;
+  arena->stats.resets++;
+}
+
+//view of the current row of a prepared statement passed to row callbacks
+struct cdba_row_struct {
+#ifdef CDBA_DRIVER
+  const struct cdba_driver_struct* driver;   //must be the first member
+#endif
+  cdba_prep_handle stmt;                      //NULL for rows of a MySQL text protocol result
+  const struct cdba_result_cache_entry_struct* cacheentry;   //result cache entry for rows served from the cache, NULL otherwise
+  const struct cdba_result_cache_value_struct* cachevalues;  //values of the current row served from the cache
+#if defined(DB_MYSQL)
+  MYSQL_ROW mysql_row;
+  unsigned long* mysql_lengths;
+  MYSQL_FIELD* mysql_fields;
+  unsigned int mysql_numfields;
+#endif
+};
+
+//kinds of SQL statements as seen by the result cache
+#define CDBA_SQL_UNCLASSIFIED -1                    //not determined yet
+#define CDBA_SQL_READ 0                             //query only reading the tables it references, its result can be cached
+#define CDBA_SQL_NOCHANGE 1                         //statement not changing any data whose result can't be cached
+#define CDBA_SQL_WRITE 2                            //statement changing the tables it references
+#define CDBA_SQL_UNKNOWN 3                          //statement with effects that can't be determined
+
 struct cdba_prep_handle_struct {
+#ifdef CDBA_DRIVER
+  const struct cdba_driver_struct* driver;   //must be the first member
+#endif
   union {
 #if defined(DB_MYSQL)
     MYSQL_STMT* mysql_prepstat;
@@ -794,33 +1719,191 @@ struct cdba_prep_handle_struct {
 #else
 #endif
   };
+  cdba_handle db;
   char* errmsg;
 #if defined(DB_MYSQL)
   MYSQL_RES* mysql_result_metadata;
   MYSQL_BIND* mysql_bind_result;
   struct mysql_resultbindinfo_struct* mysql_bind_vars;
+  MYSQL_BIND* mysql_bind_param;
+  struct mysql_argbindinfo_struct* mysql_bind_args;
+  int mysql_fetch_mode;                             //CDBA_FETCH_MODE_*
 #elif defined(DB_FREETDS)
 #elif defined(DB_SQLITE3)
   int sqlite3_first_step_status;
 #elif defined(DB_ODBC)
-  cdba_handle db;
-  SQLLEN* odbc_bind_len;
+  unsigned long odbc_row;
+  SQLLEN* odbc_batch_ind;
+  size_t odbc_batch_indcount;
+  SQLULEN odbc_rowset_rows;                         //size of a rowset with rows that are still to be read one by one, 0 if none
+  SQLULEN odbc_rowset_next;                         //number of the next row of that rowset (first row is 1)
 #else
 #endif
+#if defined(DB_MYSQL) || defined(DB_ODBC)
+  struct cdba_column_buffer_struct* colbuf;
+#endif
+  struct cdba_param_buffer_struct* params;
   int numargs;
   int numcols;
+  cdba_column_info* columns;                        //column descriptors, built when first needed for the current result shape
+  char* columnnames;                                //names of all columns one after another
+  int* columnindex;                                 //hash table with column numbers by name (-1 for an empty slot)
+  unsigned int columnindexmask;
+  int row_pending;                                  //row fetched by cdba_prep_fetch_batch() that did not fit and still needs to be returned
+  struct cdba_statement_cache_entry_struct* cacheentry;
+  struct cdba_arena_struct* arena;                  //allocator for returned values, NULL unless enabled with cdba_prep_set_arena()
+  struct cdba_row_struct rowview;                   //row passed to the callback of cdba_prep_foreach()
+  char* sql;                                        //SQL text of the statement
+  size_t sqllen;
+  int sqlkind;                                      //CDBA_SQL_* classification used by the result cache, determined when first needed
+  char* sqltables;                                  //tables referenced by the statement (see cdba_sql_classify())
+  cdba_stats stats;
 };
 
-DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle db, const char* sql)
+//copy value to be returned by the prepared statement, from the arena when enabled
+static char* cdba_prep_copy_text (cdba_prep_handle stmt, const char* data, size_t len)
+{
+  char* result;
+  if (!stmt->arena)
+    return cdba_copy_text(data, len);
+  if (!data)
+    return NULL;
+  if ((result = (char*)cdba_arena_alloc(stmt->arena, len + 1)) == NULL)
+    return NULL;
+  memcpy(result, data, len);
+  result[len] = 0;
+  return result;
+}
+
+static void cdba_prep_free_columns (cdba_prep_handle stmt)
+{
+  free(stmt->columns);
+  free(stmt->columnnames);
+  free(stmt->columnindex);
+  stmt->columns = NULL;
+  stmt->columnnames = NULL;
+  stmt->columnindex = NULL;
+  stmt->columnindexmask = 0;
+}
+
+#if defined(DB_MYSQL)
+static void cdba_prep_mysql_free_result_bindings (cdba_prep_handle stmt)
+{
+  cdba_prep_free_columns(stmt);
+  if (stmt->mysql_result_metadata) {
+    mysql_free_result(stmt->mysql_result_metadata);
+    stmt->mysql_result_metadata = NULL;
+  }
+  if (stmt->mysql_bind_result) {
+    free(stmt->mysql_bind_result);
+    stmt->mysql_bind_result = NULL;
+  }
+  if (stmt->mysql_bind_vars) {
+    free(stmt->mysql_bind_vars);
+    stmt->mysql_bind_vars = NULL;
+  }
+  cdba_column_buffers_free(stmt->colbuf, stmt->numcols);
+  stmt->colbuf = NULL;
+}
+
+static int cdba_prep_mysql_bind_result (cdba_prep_handle stmt)
+{
+  int i;
+  //(re)build result bindings, these are kept for the lifetime of the statement unless the result shape changes
+  cdba_prep_mysql_free_result_bindings(stmt);
+  stmt->numcols = mysql_stmt_field_count(stmt->mysql_prepstat);
+  if (stmt->numcols <= 0)
+    return 0;
+  if ((stmt->mysql_result_metadata = mysql_stmt_result_metadata(stmt->mysql_prepstat)) == NULL) {
+    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+    return -1;
+  }
+  if ((stmt->mysql_bind_result = (MYSQL_BIND*)malloc(sizeof(MYSQL_BIND) * stmt->numcols)) == NULL || (stmt->mysql_bind_vars = (struct mysql_resultbindinfo_struct*)malloc(sizeof(struct mysql_resultbindinfo_struct) * stmt->numcols)) == NULL || (stmt->colbuf = cdba_column_buffers_allocate(stmt->numcols)) == NULL) {
+    cdba_prep_set_error(stmt, "Memory allocation error");
+    cdba_prep_mysql_free_result_bindings(stmt);
+    return -1;
+  }
+  memset(stmt->mysql_bind_result, 0, sizeof(MYSQL_BIND) * stmt->numcols);
+  memset(stmt->mysql_bind_vars, 0, sizeof(struct mysql_resultbindinfo_struct) * stmt->numcols);
+  for (i = 0; i < stmt->numcols; i++) {
+    switch (cdba_prep_get_column_type(stmt, i)) {
+      case CDBA_TYPE_NULL :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_NULL;
+        stmt->mysql_bind_result[i].buffer = NULL;
+        stmt->mysql_bind_result[i].buffer_length = 0;
+        break;
+      case CDBA_TYPE_INT :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_LONGLONG;
+        stmt->mysql_bind_result[i].buffer = &(stmt->mysql_bind_vars[i].value.intval);
+        stmt->mysql_bind_result[i].buffer_length = sizeof(stmt->mysql_bind_vars[i].value.intval);
+        break;
+      case CDBA_TYPE_FLOAT :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_DOUBLE;
+        stmt->mysql_bind_result[i].buffer = &(stmt->mysql_bind_vars[i].value.floatval);
+        stmt->mysql_bind_result[i].buffer_length = sizeof(stmt->mysql_bind_vars[i].value.floatval);
+        break;
+      case CDBA_TYPE_TEXT :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_STRING;
+        stmt->mysql_bind_result[i].buffer = NULL;
+        stmt->mysql_bind_result[i].buffer_length = 0;
+        break;
+      case CDBA_TYPE_BLOB :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_BLOB;
+        stmt->mysql_bind_result[i].buffer = NULL;
+        stmt->mysql_bind_result[i].buffer_length = 0;
+        break;
+      default :
+        stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_NULL;
+        stmt->mysql_bind_result[i].buffer = NULL;
+        stmt->mysql_bind_result[i].buffer_length = 0;
+       break;
+    }
+    stmt->mysql_bind_result[i].length = &(stmt->mysql_bind_vars[i].length);
+    stmt->mysql_bind_result[i].is_null = &(stmt->mysql_bind_vars[i].is_null);
+  }
+  if (mysql_stmt_bind_result(stmt->mysql_prepstat, stmt->mysql_bind_result) != 0) {
+    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+    cdba_prep_mysql_free_result_bindings(stmt);
+    return -1;
+  }
+  return 0;
+}
+#endif
+
+static cdba_prep_handle cdba_prep_create_statement (cdba_handle db, const char* sql, int persistent)
 {
   struct cdba_prep_handle_struct* stmt;
+#if !defined(DB_SQLITE3) || !defined(SQLITE_PREPARE_PERSISTENT)
+  //only SQLite3 can make use of the hint
+  (void)persistent;
+#endif
   if (!sql || !*sql)
     return NULL;
   if ((stmt = (struct cdba_prep_handle_struct*)malloc(sizeof(struct cdba_prep_handle_struct))) == NULL) {
     cdba_set_error(db, "Memory allocation error");
     return NULL;
   }
+#ifdef CDBA_DRIVER
+  stmt->driver = &CDBA_DRIVER_TABLE;
+  stmt->rowview.driver = &CDBA_DRIVER_TABLE;
+#endif
+  stmt->rowview.stmt = stmt;
+  stmt->rowview.cacheentry = NULL;
+  stmt->rowview.cachevalues = NULL;
+  stmt->db = db;
   stmt->errmsg = NULL;
+  stmt->params = NULL;
+  stmt->row_pending = 0;
+  stmt->cacheentry = NULL;
+  stmt->arena = NULL;
+  stmt->sql = NULL;
+  stmt->sqllen = 0;
+  stmt->sqlkind = CDBA_SQL_UNCLASSIFIED;
+  stmt->sqltables = NULL;
+  stmt->columns = NULL;
+  stmt->columnnames = NULL;
+  stmt->columnindex = NULL;
+  stmt->columnindexmask = 0;
 #if defined(DB_MYSQL)
   if ((stmt->mysql_prepstat = mysql_stmt_init(db->mysql_conn)) == NULL) {
     cdba_set_error(db, "Memory allocation error");
@@ -836,8 +1919,31 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
   stmt->mysql_result_metadata = NULL;
   stmt->mysql_bind_result = NULL;
   stmt->mysql_bind_vars = NULL;
+  stmt->mysql_bind_param = NULL;
+  stmt->mysql_bind_args = NULL;
+  stmt->mysql_fetch_mode = CDBA_FETCH_MODE_STREAM;
+  stmt->colbuf = NULL;
   stmt->numargs = mysql_stmt_param_count(stmt->mysql_prepstat);
-  stmt->numcols = mysql_stmt_field_count(stmt->mysql_prepstat);
+  stmt->numcols = 0;
+  //allocate argument and result bindings once so executing the statement doesn't need to allocate memory
+  if (stmt->numargs > 0) {
+    if ((stmt->mysql_bind_param = (MYSQL_BIND*)malloc(sizeof(MYSQL_BIND) * stmt->numargs)) == NULL || (stmt->mysql_bind_args = (struct mysql_argbindinfo_struct*)malloc(sizeof(struct mysql_argbindinfo_struct) * stmt->numargs)) == NULL) {
+      cdba_set_error(db, "Memory allocation error");
+      free(stmt->mysql_bind_param);
+      mysql_stmt_close(stmt->mysql_prepstat);
+      free(stmt);
+      return NULL;
+    }
+  }
+  if (cdba_prep_mysql_bind_result(stmt) != 0) {
+    cdba_set_error(db, stmt->errmsg);
+    free(stmt->errmsg);
+    free(stmt->mysql_bind_param);
+    free(stmt->mysql_bind_args);
+    mysql_stmt_close(stmt->mysql_prepstat);
+    free(stmt);
+    return NULL;
+  }
 #elif defined(DB_FREETDS)
   CS_INT rc;
   if ((rc = ct_cmd_alloc(db->freetds_conn, &stmt->freetds_prepstat)) != CS_SUCCEED) {
@@ -871,7 +1977,11 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
 
   ct_cmd_drop(stmt->freetds_prepstat);
 #elif defined(DB_SQLITE3)
+#ifdef SQLITE_PREPARE_PERSISTENT
+  if (sqlite3_prepare_v3(db->sqlite3_conn, sql, -1, (persistent ? SQLITE_PREPARE_PERSISTENT : 0), &(stmt->sqlite3_prepstat), NULL) != SQLITE_OK) {
+#else
   if (sqlite3_prepare_v2(db->sqlite3_conn, sql, -1, &(stmt->sqlite3_prepstat), NULL) != SQLITE_OK) {
+#endif
     cdba_set_error(db, sqlite3_errmsg(db->sqlite3_conn));
     free(stmt);
     return NULL;
@@ -904,7 +2014,6 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
     return NULL;
   }
 */
-  stmt->db = db;
   stmt->numargs = -1;
   status = SQLNumParams(stmt->odbc_prepstat, &n);
   if (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO)
@@ -913,15 +2022,16 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
   status = SQLNumResultCols(stmt->odbc_prepstat, &n);
   if (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO)
     stmt->numcols = n;
-  if (stmt->numargs <= 0) {
-    stmt->odbc_bind_len = NULL;
-  } else if ((stmt->odbc_bind_len = (SQLLEN*)malloc(sizeof(SQLLEN) * stmt->numargs)) == NULL) {
+  stmt->odbc_row = 0;
+  stmt->odbc_rowset_rows = 0;
+  stmt->odbc_rowset_next = 0;
+  stmt->odbc_batch_ind = NULL;
+  stmt->odbc_batch_indcount = 0;
+  if ((stmt->colbuf = cdba_column_buffers_allocate(stmt->numcols)) == NULL && stmt->numcols > 0) {
     cdba_set_error(db, "Memory allocation error");
     SQLFreeHandle(SQL_HANDLE_STMT, stmt->odbc_prepstat);
     free(stmt);
     return NULL;
-  } else {
-    memset(stmt->odbc_bind_len, 0, sizeof(SQLLEN) * stmt->numargs);
   }
 #else
   free(stmt);
@@ -930,38 +2040,85 @@ DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle d
   return stmt;
 }
 
+//prepare statement, persistent is a hint that the statement will be kept and reused many times
+static cdba_prep_handle cdba_prep_create (cdba_handle db, const char* sql, int persistent)
+{
+  cdba_prep_handle stmt;
+  if ((stmt = cdba_prep_create_statement(db, sql, persistent)) == NULL) {
+    db->stats.errors++;
+    return NULL;
+  }
+  //keep the SQL text for the result cache
+#if defined(DB_SQLITE3)
+  //SQLite3 only prepares the first statement and keeps its text
+  sql = (stmt->sqlite3_prepstat ? sqlite3_sql(stmt->sqlite3_prepstat) : "");
+#endif
+  stmt->sqllen = strlen(sql);
+  if ((stmt->sql = cdba_copy_text(sql, stmt->sqllen)) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    cdba_prep_close(stmt);
+    db->stats.errors++;
+    return NULL;
+  }
+  memset(&stmt->stats, 0, sizeof(stmt->stats));
+  stmt->stats.prepares = 1;
+  db->stats.prepares++;
+  return stmt;
+}
+
+DLL_EXPORT_CDBALIB cdba_prep_handle cdba_create_preparedstatement (cdba_handle db, const char* sql)
+{
+  return cdba_prep_create(db, sql, 0);
+}
+
 DLL_EXPORT_CDBALIB int cdba_prep_get_argument_count (cdba_prep_handle stmt)
 {
   return stmt->numargs;
 }
 
+#if defined(DB_ODBC)
+//forget the rows of a rowset that were not read yet and go back to rowsets of one row
+static void cdba_prep_odbc_rowset_end (cdba_prep_handle stmt)
+{
+  if (!stmt->odbc_rowset_rows)
+    return;
+  stmt->odbc_rowset_rows = 0;
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+}
+
+//move to the next row, taking the remaining rows of a rowset first
+static SQLRETURN cdba_prep_odbc_next_row (cdba_prep_handle stmt)
+{
+  stmt->odbc_row++;
+  if (stmt->odbc_rowset_rows) {
+    if (stmt->odbc_rowset_next <= stmt->odbc_rowset_rows)
+      return SQLSetPos(stmt->odbc_prepstat, (SQLSETPOSIROW)stmt->odbc_rowset_next++, SQL_POSITION, SQL_LOCK_NO_CHANGE);
+    cdba_prep_odbc_rowset_end(stmt);
+  }
+  return SQLFetch(stmt->odbc_prepstat);
+}
+#endif
+
 DLL_EXPORT_CDBALIB void cdba_prep_reset (cdba_prep_handle stmt)
 {
   if (!stmt)
     return;
+  stmt->row_pending = 0;
+  cdba_arena_recycle(stmt->arena);
 #if defined(DB_MYSQL)
   mysql_stmt_reset(stmt->mysql_prepstat);
-  if (stmt->mysql_result_metadata) {
-    mysql_free_result(stmt->mysql_result_metadata);
-    stmt->mysql_result_metadata = NULL;
-  }
-  if (stmt->mysql_bind_result) {
-    free(stmt->mysql_bind_result);
-    stmt->mysql_bind_result = NULL;
-  }
-  if (stmt->mysql_bind_vars) {
-    free(stmt->mysql_bind_vars);
-    stmt->mysql_bind_vars = NULL;
-  }
 #elif defined(DB_FREETDS)
 #elif defined(DB_SQLITE3)
   sqlite3_reset(stmt->sqlite3_prepstat);
   sqlite3_clear_bindings(stmt->sqlite3_prepstat);
   stmt->sqlite3_first_step_status = -1;
+  cdba_param_buffers_invalidate(stmt->params, stmt->numargs);
 #elif defined(DB_ODBC)
   SQLFreeStmt(stmt->odbc_prepstat, SQL_UNBIND);
   SQLFreeStmt(stmt->odbc_prepstat, SQL_CLOSE);
   SQLCancel(stmt->odbc_prepstat);
+  cdba_prep_odbc_rowset_end(stmt);
+  stmt->odbc_row++;
 #else
 #endif
 }
@@ -970,24 +2127,28 @@ DLL_EXPORT_CDBALIB void cdba_prep_close (cdba_prep_handle stmt)
 {
   if (!stmt)
     return;
+  //statements owned by the statement cache are returned to the cache instead of being closed
+  if (stmt->cacheentry) {
+    cdba_statement_cache_release(stmt);
+    return;
+  }
   if (stmt->errmsg)
     free(stmt->errmsg);
 #if defined(DB_MYSQL)
   if (stmt->mysql_prepstat)
     mysql_stmt_close(stmt->mysql_prepstat);
-  if (stmt->mysql_result_metadata)
-    mysql_free_result(stmt->mysql_result_metadata);
-  if (stmt->mysql_bind_result)
-    free(stmt->mysql_bind_result);
-  if (stmt->mysql_bind_vars)
-    free(stmt->mysql_bind_vars);
+  cdba_prep_mysql_free_result_bindings(stmt);
+  if (stmt->mysql_bind_param)
+    free(stmt->mysql_bind_param);
+  if (stmt->mysql_bind_args)
+    free(stmt->mysql_bind_args);
 #elif defined(DB_FREETDS)
 #elif defined(DB_SQLITE3)
   if (stmt->sqlite3_prepstat)
     sqlite3_finalize(stmt->sqlite3_prepstat);
 #elif defined(DB_ODBC)
-  if (stmt->odbc_bind_len)
-    free(stmt->odbc_bind_len);
+  free(stmt->odbc_batch_ind);
+  cdba_column_buffers_free(stmt->colbuf, stmt->numcols);
   if (stmt->odbc_prepstat) {
     SQLFreeStmt(stmt->odbc_prepstat, SQL_UNBIND);
     SQLFreeStmt(stmt->odbc_prepstat, SQL_CLOSE);
@@ -996,6 +2157,11 @@ DLL_EXPORT_CDBALIB void cdba_prep_close (cdba_prep_handle stmt)
   }
 #else
 #endif
+  cdba_prep_free_columns(stmt);
+  cdba_param_buffers_free(stmt->params, stmt->numargs);
+  cdba_arena_free(stmt->arena);
+  free(stmt->sql);
+  free(stmt->sqltables);
   free(stmt);
 }
 
@@ -1011,593 +2177,5188 @@ DLL_EXPORT_CDBALIB const char* cdba_prep_get_error (cdba_prep_handle stmt)
   return stmt->errmsg;
 }
 
-DLL_EXPORT_CDBALIB int cdba_prep_execute (cdba_prep_handle stmt, ...)
+DLL_EXPORT_CDBALIB void cdba_prep_get_stats (cdba_prep_handle stmt, cdba_stats* stats)
 {
-  int i;
-  int type;
-  int status = 0;
-  va_list argp;
-  va_start(argp, stmt);
-#if defined(DB_MYSQL)
-  MYSQL_BIND* bindarg;
-  struct mysql_argbindinfo_struct* argcopy;
-  //bind arguments
-  bindarg = NULL;
-  if (stmt->numargs > 0) {
-    if ((bindarg = (MYSQL_BIND*)malloc(sizeof(MYSQL_BIND) * stmt->numargs)) == NULL) {
+  *stats = stmt->stats;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_set_arena (cdba_prep_handle stmt, size_t blocksize)
+{
+  if (blocksize == 0) {
+    cdba_arena_free(stmt->arena);
+    stmt->arena = NULL;
+    return 0;
+  }
+  if (!stmt->arena) {
+    if ((stmt->arena = (struct cdba_arena_struct*)malloc(sizeof(struct cdba_arena_struct))) == NULL) {
       cdba_prep_set_error(stmt, "Memory allocation error");
-      va_end(argp);
       return -1;
     }
-    if ((argcopy = (struct mysql_argbindinfo_struct*)malloc(sizeof(struct mysql_argbindinfo_struct) * stmt->numargs)) == NULL) {
-      cdba_prep_set_error(stmt, "Memory allocation error");
-      free(bindarg);
-      va_end(argp);
-      return -1;
+    memset(stmt->arena, 0, sizeof(struct cdba_arena_struct));
+  }
+  stmt->arena->blocksize = blocksize;
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB void cdba_prep_get_arena_stats (cdba_prep_handle stmt, cdba_arena_stats* stats)
+{
+  if (stmt->arena)
+    *stats = stmt->arena->stats;
+  else
+    memset(stats, 0, sizeof(cdba_arena_stats));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//calculate hash (FNV-1a) and length of SQL statement
+static uint32_t cdba_statement_cache_hash (const char* sql, size_t* len)
+{
+  uint32_t hash = 2166136261u;
+  const char* p = sql;
+  while (*p) {
+    hash ^= (uint8_t)*p++;
+    hash *= 16777619u;
+  }
+  *len = p - sql;
+  return hash;
+}
+
+//unlink entry from the most recently used list
+static void cdba_statement_cache_lru_unlink (cdba_handle db, struct cdba_statement_cache_entry_struct* entry)
+{
+  if (entry->lruprev)
+    entry->lruprev->lrunext = entry->lrunext;
+  else
+    db->stmtcache_mru = entry->lrunext;
+  if (entry->lrunext)
+    entry->lrunext->lruprev = entry->lruprev;
+  else
+    db->stmtcache_lru = entry->lruprev;
+  entry->lruprev = NULL;
+  entry->lrunext = NULL;
+}
+
+//put entry at the front of the most recently used list
+static void cdba_statement_cache_lru_push (cdba_handle db, struct cdba_statement_cache_entry_struct* entry)
+{
+  entry->lruprev = NULL;
+  entry->lrunext = db->stmtcache_mru;
+  if (db->stmtcache_mru)
+    db->stmtcache_mru->lruprev = entry;
+  else
+    db->stmtcache_lru = entry;
+  db->stmtcache_mru = entry;
+}
+
+//remove entry from the cache and close its prepared statement unless it is in use
+static void cdba_statement_cache_remove (cdba_handle db, struct cdba_statement_cache_entry_struct* entry)
+{
+  struct cdba_statement_cache_entry_struct** p;
+  p = &db->stmtcache_buckets[entry->hash & (db->stmtcache_numbuckets - 1)];
+  while (*p != entry)
+    p = &(*p)->hashnext;
+  *p = entry->hashnext;
+  cdba_statement_cache_lru_unlink(db, entry);
+  db->stmtcache_stats.count--;
+  //a statement still in use becomes a normal prepared statement closed by the caller
+  entry->stmt->cacheentry = NULL;
+  if (!entry->inuse)
+    cdba_prep_close(entry->stmt);
+  free(entry->sql);
+  free(entry);
+}
+
+//remove least recently used entries not in use until the cache fits in the specified number of entries
+static void cdba_statement_cache_trim (cdba_handle db, size_t maxcount)
+{
+  struct cdba_statement_cache_entry_struct* entry;
+  struct cdba_statement_cache_entry_struct* prev;
+  entry = db->stmtcache_lru;
+  while (entry && db->stmtcache_stats.count > maxcount) {
+    prev = entry->lruprev;
+    if (!entry->inuse) {
+      cdba_statement_cache_remove(db, entry);
+      db->stmtcache_stats.evictions++;
     }
-    memset(bindarg, 0, sizeof(MYSQL_BIND) * stmt->numargs);
-    for (i = 0; i < stmt->numargs; i++) {
-      type = va_arg(argp, int);
-      switch (type) {
-        case CDBA_TYPE_NULL :
-          bindarg[i].buffer_type = MYSQL_TYPE_NULL;
-          bindarg[i].buffer = NULL;
-          break;
-        case CDBA_TYPE_INT :
-          argcopy[i].intval = (long long)va_arg(argp, db_int);
-          bindarg[i].buffer_type = MYSQL_TYPE_LONGLONG;
-          bindarg[i].buffer = &(argcopy[i].intval);
-          break;
-        case CDBA_TYPE_FLOAT :
-          argcopy[i].floatval = va_arg(argp, db_flt);
-          bindarg[i].buffer_type = MYSQL_TYPE_DOUBLE;
-          bindarg[i].buffer = &(argcopy[i].intval);
-          break;
-        case CDBA_TYPE_TEXT :
-          bindarg[i].buffer = va_arg(argp, char*);
-          if (bindarg[i].buffer) {
-            bindarg[i].buffer_type = MYSQL_TYPE_STRING;
-            bindarg[i].buffer_length = strlen(bindarg[i].buffer);
-          } else {
-            bindarg[i].buffer_type = MYSQL_TYPE_NULL;
-          }
-          break;
-        default :
-          cdba_prep_set_error(stmt, "Unknown database type");
-          cdba_prep_reset(stmt);
-          va_end(argp);
-          return -1;
+    entry = prev;
+  }
+}
+
+//allocate hash buckets (number of buckets is a power of 2 and at least twice the cache capacity)
+static int cdba_statement_cache_rehash (cdba_handle db)
+{
+  struct cdba_statement_cache_entry_struct** buckets;
+  struct cdba_statement_cache_entry_struct* entry;
+  size_t numbuckets = 16;
+  size_t i;
+  while (numbuckets < db->stmtcache_stats.capacity * 2)
+    numbuckets <<= 1;
+  if (numbuckets == db->stmtcache_numbuckets)
+    return 0;
+  if ((buckets = (struct cdba_statement_cache_entry_struct**)malloc(sizeof(struct cdba_statement_cache_entry_struct*) * numbuckets)) == NULL)
+    return -1;
+  memset(buckets, 0, sizeof(struct cdba_statement_cache_entry_struct*) * numbuckets);
+  for (entry = db->stmtcache_mru; entry; entry = entry->lrunext) {
+    i = entry->hash & (numbuckets - 1);
+    entry->hashnext = buckets[i];
+    buckets[i] = entry;
+  }
+  free(db->stmtcache_buckets);
+  db->stmtcache_buckets = buckets;
+  db->stmtcache_numbuckets = numbuckets;
+  return 0;
+}
+
+//return prepared statement to the cache so it can be reused
+static void cdba_statement_cache_release (cdba_prep_handle stmt)
+{
+  //release results and arguments without a server round trip
+  if (stmt->errmsg) {
+    free(stmt->errmsg);
+    stmt->errmsg = NULL;
+  }
+#if defined(DB_MYSQL)
+  mysql_stmt_free_result(stmt->mysql_prepstat);
+  //the next user expects the default fetch mode
+  if (stmt->mysql_fetch_mode != CDBA_FETCH_MODE_STREAM) {
+    unsigned long cursortype = CURSOR_TYPE_NO_CURSOR;
+    unsigned long prefetch = 1;
+    mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_CURSOR_TYPE, &cursortype);
+    mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_PREFETCH_ROWS, &prefetch);
+    stmt->mysql_fetch_mode = CDBA_FETCH_MODE_STREAM;
+  }
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  sqlite3_reset(stmt->sqlite3_prepstat);
+  sqlite3_clear_bindings(stmt->sqlite3_prepstat);
+  stmt->sqlite3_first_step_status = -1;
+#elif defined(DB_ODBC)
+  SQLFreeStmt(stmt->odbc_prepstat, SQL_CLOSE);
+  cdba_prep_odbc_rowset_end(stmt);
+  stmt->odbc_row++;
+#else
+#endif
+  //the next user expects arguments that were not bound to be NULL
+  cdba_param_buffers_clear(stmt->params, stmt->numargs);
+  stmt->row_pending = 0;
+  //the next user expects values that must be freed with cdba_free()
+  cdba_prep_set_arena(stmt, 0);
+  stmt->cacheentry->inuse = 0;
+  //the cache may have been shrunk while the statement was in use
+  cdba_statement_cache_trim(stmt->db, stmt->db->stmtcache_stats.capacity);
+}
+
+//close all cached statements
+static void cdba_statement_cache_flush (cdba_handle db)
+{
+  while (db->stmtcache_mru)
+    cdba_statement_cache_remove(db, db->stmtcache_mru);
+  free(db->stmtcache_buckets);
+  db->stmtcache_buckets = NULL;
+  db->stmtcache_numbuckets = 0;
+}
+
+DLL_EXPORT_CDBALIB cdba_prep_handle cdba_prepare_cached (cdba_handle db, const char* sql)
+{
+  struct cdba_statement_cache_entry_struct* entry;
+  cdba_prep_handle stmt;
+  size_t sqllen;
+  uint32_t hash;
+  if (!sql || !*sql)
+    return NULL;
+  hash = cdba_statement_cache_hash(sql, &sqllen);
+  //look for a cached statement with the same SQL that is not in use
+  if (db->stmtcache_buckets) {
+    for (entry = db->stmtcache_buckets[hash & (db->stmtcache_numbuckets - 1)]; entry; entry = entry->hashnext) {
+      if (!entry->inuse && entry->hash == hash && entry->sqllen == sqllen && memcmp(entry->sql, sql, sqllen) == 0) {
+        db->stmtcache_stats.hits++;
+        entry->inuse = 1;
+        if (db->stmtcache_mru != entry) {
+          cdba_statement_cache_lru_unlink(db, entry);
+          cdba_statement_cache_lru_push(db, entry);
+        }
+        return entry->stmt;
       }
     }
-    mysql_stmt_bind_param(stmt->mysql_prepstat, bindarg);
   }
-  //execute statement
-  if ((status = mysql_stmt_execute(stmt->mysql_prepstat)) != 0) {
-    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
-    if (bindarg)
-      free(bindarg);
-    if (argcopy)
-      free(argcopy);
-    cdba_prep_reset(stmt);
-    va_end(argp);
-    return -1;
+  db->stmtcache_stats.misses++;
+  //prepare new statement and add it to the cache if there is room
+  if ((stmt = cdba_prep_create(db, sql, (db->stmtcache_stats.capacity > 0))) == NULL)
+    return NULL;
+  if (db->stmtcache_stats.capacity == 0)
+    return stmt;
+  cdba_statement_cache_trim(db, db->stmtcache_stats.capacity - 1);
+  if (db->stmtcache_stats.count >= db->stmtcache_stats.capacity)
+    return stmt;
+  if (!db->stmtcache_buckets && cdba_statement_cache_rehash(db) != 0)
+    return stmt;
+  if ((entry = (struct cdba_statement_cache_entry_struct*)malloc(sizeof(struct cdba_statement_cache_entry_struct))) == NULL)
+    return stmt;
+  if ((entry->sql = cdba_copy_text(sql, sqllen)) == NULL) {
+    free(entry);
+    return stmt;
   }
-  //bind results
-  if (stmt->numcols > 0) {
-    //allocate space for bind data
-    if (stmt->mysql_bind_result)
-      free(stmt->mysql_bind_result);
-    if ((stmt->mysql_bind_result = (MYSQL_BIND*)malloc(sizeof(MYSQL_BIND) * stmt->numcols)) == NULL) {
-      cdba_prep_set_error(stmt, "Memory allocation error");
-      if (bindarg)
-        free(bindarg);
-      if (argcopy)
-        free(argcopy);
-      cdba_prep_reset(stmt);
-      va_end(argp);
-      return -1;
+  entry->sqllen = sqllen;
+  entry->hash = hash;
+  entry->stmt = stmt;
+  entry->inuse = 1;
+  entry->hashnext = db->stmtcache_buckets[hash & (db->stmtcache_numbuckets - 1)];
+  db->stmtcache_buckets[hash & (db->stmtcache_numbuckets - 1)] = entry;
+  cdba_statement_cache_lru_push(db, entry);
+  db->stmtcache_stats.count++;
+  stmt->cacheentry = entry;
+  return stmt;
+}
+
+DLL_EXPORT_CDBALIB void cdba_set_statement_cache_size (cdba_handle db, size_t capacity)
+{
+  db->stmtcache_stats.capacity = capacity;
+  cdba_statement_cache_trim(db, capacity);
+  if (db->stmtcache_buckets)
+    cdba_statement_cache_rehash(db);
+}
+
+DLL_EXPORT_CDBALIB void cdba_get_statement_cache_stats (cdba_handle db, cdba_statement_cache_stats* stats)
+{
+  *stats = db->stmtcache_stats;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#define CDBA_SQL_TOKEN_WORD 0                       //keyword, unquoted identifier or number
+#define CDBA_SQL_TOKEN_IDENTIFIER 1                 //quoted identifier
+#define CDBA_SQL_TOKEN_STRING 2                     //string literal
+#define CDBA_SQL_TOKEN_SYMBOL 3                     //any other character
+
+#define CDBA_SQL_IS_WORD_CHAR(c) (isalnum((unsigned char)(c)) || (c) == '_' || (c) == '$' || (unsigned char)(c) >= 0x80)
+#define CDBA_SQL_TOKEN_IS_SYMBOL(token, c) ((token).type == CDBA_SQL_TOKEN_SYMBOL && *(token).text == (c))
+
+//maximum nesting of parentheses tracked when looking for table names
+#define CDBA_SQL_MAX_DEPTH 32
+
+struct cdba_sql_token_struct {
+  int type;                                         //CDBA_SQL_TOKEN_*
+  const char* text;                                 //text without quotes
+  size_t len;
+};
+
+//get the next token from SQL text, returns zero at the end
+static int cdba_sql_next_token (const char** sql, const char* end, struct cdba_sql_token_struct* token)
+{
+  const char* p = *sql;
+  char quote;
+  //skip spaces and comments
+  while (p < end) {
+    if (isspace((unsigned char)*p)) {
+      p++;
+    } else if (*p == '-' && p + 1 < end && p[1] == '-') {
+      while (p < end && *p != '\n')
+        p++;
+#if defined(DB_MYSQL)
+    } else if (*p == '#') {
+      while (p < end && *p != '\n')
+        p++;
+#endif
+    } else if (*p == '/' && p + 1 < end && p[1] == '*') {
+      p += 2;
+      while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/'))
+        p++;
+      p = (p < end ? p + 2 : end);
+    } else {
+      break;
     }
-    memset(stmt->mysql_bind_result, 0, sizeof(MYSQL_BIND) * stmt->numcols);
-    if (stmt->mysql_bind_vars )
-      free(stmt->mysql_bind_vars );
-    if ((stmt->mysql_bind_vars = (struct mysql_resultbindinfo_struct*)malloc(sizeof(struct mysql_resultbindinfo_struct) * stmt->numcols)) == NULL) {
-      cdba_prep_set_error(stmt, "Memory allocation error");
-      if (bindarg)
-        free(bindarg);
-      if (argcopy)
-        free(argcopy);
-      free(stmt->mysql_bind_result);
-      cdba_prep_reset(stmt);
-      va_end(argp);
-      return -1;
+  }
+  if (p >= end) {
+    *sql = end;
+    return 0;
+  }
+  if (CDBA_SQL_IS_WORD_CHAR(*p)) {
+    token->type = CDBA_SQL_TOKEN_WORD;
+    token->text = p;
+    while (p < end && CDBA_SQL_IS_WORD_CHAR(*p))
+      p++;
+    token->len = p - token->text;
+  } else if (*p == '\'' || *p == '"' || *p == '`' || *p == '[') {
+    quote = (*p == '[' ? ']' : *p);
+    token->type = (quote == '\'' ? CDBA_SQL_TOKEN_STRING : CDBA_SQL_TOKEN_IDENTIFIER);
+    token->text = ++p;
+    while (p < end && *p != quote) {
+#if defined(DB_MYSQL)
+      //MySQL allows escaping characters in strings with a backslash
+      if (*p == '\\' && quote != '`' && p + 1 < end)
+        p++;
+#endif
+      p++;
     }
-    /////memset(stmt->mysql_bind_result, 0, sizeof(struct mysql_resultbindinfo_struct) * stmt->numcols);
-    //populate bind data
-    if (stmt->mysql_result_metadata)
-      mysql_free_result(stmt->mysql_result_metadata);
-    stmt->mysql_result_metadata = mysql_stmt_result_metadata(stmt->mysql_prepstat);
-    for (i = 0; i < stmt->numcols; i++) {
-      switch (cdba_prep_get_column_type(stmt, i)) {
-        case CDBA_TYPE_NULL :
-          stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_NULL;
-          stmt->mysql_bind_result[i].buffer = NULL;
-          stmt->mysql_bind_result[i].buffer_length = 0;
-          break;
-        case CDBA_TYPE_INT :
-          stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_LONGLONG;
-          stmt->mysql_bind_result[i].buffer = &(stmt->mysql_bind_vars[i].value.intval);
-          stmt->mysql_bind_result[i].buffer_length = sizeof(stmt->mysql_bind_vars[i].value.intval);
-          break;
-        case CDBA_TYPE_FLOAT :
-          stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_DOUBLE;
-          stmt->mysql_bind_result[i].buffer = &(stmt->mysql_bind_vars[i].value.floatval);
-          stmt->mysql_bind_result[i].buffer_length = sizeof(stmt->mysql_bind_vars[i].value.floatval);
-          break;
-        case CDBA_TYPE_TEXT :
-          stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_STRING;
-          stmt->mysql_bind_result[i].buffer = NULL;
-          stmt->mysql_bind_result[i].buffer_length = 0;
-          break;
-/*
-        case CDBA_TYPE_BLOB :
-*/
-        default :
-          stmt->mysql_bind_result[i].buffer_type = MYSQL_TYPE_NULL;
-          stmt->mysql_bind_result[i].buffer = NULL;
-          stmt->mysql_bind_result[i].buffer_length = 0;
-         break;
-      }
-      stmt->mysql_bind_result[i].length = &(stmt->mysql_bind_vars[i].length);
-      stmt->mysql_bind_result[i].is_null = &(stmt->mysql_bind_vars[i].is_null);
+    token->len = p - token->text;
+    if (p < end)
+      p++;
+  } else {
+    token->type = CDBA_SQL_TOKEN_SYMBOL;
+    token->text = p++;
+    token->len = 1;
+  }
+  *sql = p;
+  return 1;
+}
+
+//check if text matches a lower case keyword without regard to case
+static int cdba_sql_text_is (const char* text, size_t len, const char* keyword)
+{
+  size_t i;
+  for (i = 0; i < len; i++) {
+    if (!keyword[i] || tolower((unsigned char)text[i]) != keyword[i])
+      return 0;
+  }
+  return (keyword[i] == 0);
+}
+
+//check if token is the specified keyword (in lower case)
+static int cdba_sql_token_is (const struct cdba_sql_token_struct* token, const char* keyword)
+{
+  return (token->type == CDBA_SQL_TOKEN_WORD && cdba_sql_text_is(token->text, token->len, keyword));
+}
+
+//check if token is one of the keywords in a NULL terminated list
+static int cdba_sql_token_in (const struct cdba_sql_token_struct* token, const char* const* keywords)
+{
+  if (token->type != CDBA_SQL_TOKEN_WORD)
+    return 0;
+  while (*keywords) {
+    if (cdba_sql_text_is(token->text, token->len, *keywords))
+      return 1;
+    keywords++;
+  }
+  return 0;
+}
+
+//statements that only read data
+static const char* const cdba_sql_read_verbs[] = {"select", "with", "values", NULL};
+//statements that change data or the database structure
+static const char* const cdba_sql_write_verbs[] = {"insert", "update", "delete", "replace", "merge", "upsert", "truncate", "load", "create", "drop", "alter", "rename", NULL};
+//statements followed directly by a table name
+static const char* const cdba_sql_table_verbs[] = {"insert", "update", "delete", "replace", "truncate", NULL};
+//statements that don't change data
+static const char* const cdba_sql_nochange_verbs[] = {"begin", "start", "commit", "end", "savepoint", "release", "set", "show", "explain", "describe", "desc", "pragma", "analyze", "vacuum", "checkpoint", "lock", "unlock", NULL};
+//keywords that make a query change data
+static const char* const cdba_sql_write_keywords[] = {"insert", "update", "delete", "merge", NULL};
+//objects whose creation or removal has effects on other tables
+static const char* const cdba_sql_ddl_objects[] = {"trigger", "procedure", "function", "event", "database", "schema", "rule", NULL};
+//keywords followed by table names
+static const char* const cdba_sql_table_keywords[] = {"from", "join", "straight_join", "into", "update", "table", "view", NULL};
+//keywords allowed between a table keyword and the table name
+static const char* const cdba_sql_table_modifiers[] = {"low_priority", "high_priority", "delayed", "quick", "ignore", "only", "if", "not", "exists", "or", "replace", "rollback", "abort", "fail", "temporary", "temp", "lateral", NULL};
+//keywords ending a list of tables
+static const char* const cdba_sql_clause_keywords[] = {"where", "group", "order", "limit", "having", "union", "except", "intersect", "window", "set", "values", "select", "returning", "for", "lock", "offset", "fetch", "with", NULL};
+//keywords that can't be a table alias
+static const char* const cdba_sql_alias_stop_keywords[] = {"where", "join", "inner", "left", "right", "full", "outer", "cross", "natural", "on", "using", "set", "group", "order", "limit", "having", "union", "except", "intersect", "window", "values", "value", "select", "partition", "straight_join", "lateral", "for", "lock", "offset", "fetch", "returning", "use", "force", "ignore", "to", "default", "with", "from", "into", "character", "fields", "lines", "columns", "indexed", NULL};
+//functions with results that change without any table being written
+static const char* const cdba_sql_volatile_functions[] = {"now", "current_timestamp", "current_date", "current_time", "localtime", "localtimestamp", "sysdate", "curdate", "curtime", "utc_timestamp", "utc_date", "utc_time", "unix_timestamp", "getdate", "getutcdate", "sysdatetime", "rand", "random", "randomblob", "uuid", "uuid_short", "newid", "last_insert_id", "last_insert_rowid", "changes", "total_changes", "found_rows", "row_count", "nextval", "currval", "get_lock", "release_lock", "sleep", "connection_id", "scope_identity", NULL};
+
+//list of lower case table names, each followed by a zero byte, ending with an empty name
+struct cdba_sql_tables_struct {
+  char* names;
+  size_t len;                                       //length without the final zero byte
+  size_t size;
+  size_t last;                                      //position of the last name added
+  int error;
+};
+
+//add the table name in token to the list, replacelast replaces the name added before (used for schema qualified names)
+static void cdba_sql_tables_add (struct cdba_sql_tables_struct* tables, const struct cdba_sql_token_struct* token, int replacelast)
+{
+  char* names;
+  size_t size;
+  size_t i;
+  if (tables->error || token->len == 0)
+    return;
+  if (replacelast)
+    tables->len = tables->last;
+  if (tables->len + token->len + 2 > tables->size) {
+    size = (tables->len + token->len + 2) * 2;
+    if ((names = (char*)realloc(tables->names, size)) == NULL) {
+      tables->error = 1;
+      return;
     }
-    mysql_stmt_bind_result(stmt->mysql_prepstat, stmt->mysql_bind_result);
+    tables->names = names;
+    tables->size = size;
   }
-  if (bindarg)
-    free(bindarg);
-  if (argcopy)
-    free(argcopy);
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  //bind arguments
-  for (i = 0; i < stmt->numargs; i++) {
-    type = va_arg(argp, int);
-    switch (type) {
-      case CDBA_TYPE_NULL :
-        sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
-        break;
-      case CDBA_TYPE_INT :
-        {
-          int64_t val = va_arg(argp, db_int);
-          sqlite3_bind_int64(stmt->sqlite3_prepstat, i + 1, val);
+  tables->last = tables->len;
+  for (i = 0; i < token->len; i++)
+    tables->names[tables->len++] = tolower((unsigned char)token->text[i]);
+  tables->names[tables->len++] = 0;
+  tables->names[tables->len] = 0;
+}
+
+//get the length of a list of table names including the final zero byte
+static size_t cdba_sql_tables_length (const char* tables)
+{
+  const char* p = tables;
+  while (*p)
+    p += strlen(p) + 1;
+  return p - tables + 1;
+}
+
+//check if two lists of table names have a name in common
+static int cdba_sql_tables_intersect (const char* tables1, const char* tables2)
+{
+  const char* p;
+  const char* q;
+  for (p = tables1; *p; p += strlen(p) + 1) {
+    for (q = tables2; *q; q += strlen(q) + 1) {
+      if (strcmp(p, q) == 0)
+        return 1;
+    }
+  }
+  return 0;
+}
+
+#define CDBA_SQL_STATE_NORMAL 0
+#define CDBA_SQL_STATE_TABLE 1                      //table name expected
+#define CDBA_SQL_STATE_AFTERNAME 2                  //after a table name
+#define CDBA_SQL_STATE_QUALIFIED 3                  //after the dot following a schema name
+
+//determine the kind of SQL statements (CDBA_SQL_*) and for CDBA_SQL_READ and CDBA_SQL_WRITE set tables to the list of tables they reference (see struct cdba_sql_tables_struct)
+//this is a heuristic that errs on the side of CDBA_SQL_UNKNOWN and of listing too many tables
+static int cdba_sql_classify (const char* sql, size_t len, char** tables)
+{
+  struct cdba_sql_token_struct token;
+  struct cdba_sql_tables_struct list = {NULL, 0, 0, 0, 0};
+  unsigned char fromlist[CDBA_SQL_MAX_DEPTH];       //set for each level of parentheses while in a list of tables
+  const char* end = sql + len;
+  int result = CDBA_SQL_UNCLASSIFIED;
+  int statements = 0;
+  int kind = CDBA_SQL_UNCLASSIFIED;                 //kind of the current statement
+  size_t stmttables = 0;                            //length of the list of tables at the start of the current statement
+  int state = CDBA_SQL_STATE_NORMAL;
+  int depth = 0;
+  int ddl = 0;
+  int afterfor = 0;
+  int more;
+  *tables = NULL;
+  fromlist[0] = 0;
+  do {
+    more = cdba_sql_next_token(&sql, end, &token);
+    //end of statement
+    if (!more || (depth == 0 && CDBA_SQL_TOKEN_IS_SYMBOL(token, ';'))) {
+      if (kind != CDBA_SQL_UNCLASSIFIED) {
+        //queries without tables can return different results each time and writes to unknown tables can affect anything
+        if (kind == CDBA_SQL_READ && list.len == stmttables)
+          kind = CDBA_SQL_NOCHANGE;
+        else if (kind == CDBA_SQL_WRITE && list.len == stmttables)
+          kind = CDBA_SQL_UNKNOWN;
+        if (kind > result)
+          result = kind;
+        statements++;
+      }
+      kind = CDBA_SQL_UNCLASSIFIED;
+      stmttables = list.len;
+      state = CDBA_SQL_STATE_NORMAL;
+      depth = 0;
+      ddl = 0;
+      afterfor = 0;
+      fromlist[0] = 0;
+      continue;
+    }
+    //the first word determines the kind of statement
+    if (kind == CDBA_SQL_UNCLASSIFIED) {
+      if (token.type == CDBA_SQL_TOKEN_WORD) {
+        if (cdba_sql_token_in(&token, cdba_sql_read_verbs)) {
+          kind = CDBA_SQL_READ;
+        } else if (cdba_sql_token_in(&token, cdba_sql_write_verbs)) {
+          kind = CDBA_SQL_WRITE;
+          ddl = (cdba_sql_token_is(&token, "create") || cdba_sql_token_is(&token, "drop") || cdba_sql_token_is(&token, "alter"));
+          if (cdba_sql_token_in(&token, cdba_sql_table_verbs)) {
+            state = CDBA_SQL_STATE_TABLE;
+            fromlist[depth] = 1;
+          }
+        } else if (cdba_sql_token_in(&token, cdba_sql_nochange_verbs)) {
+          kind = CDBA_SQL_NOCHANGE;
+        } else {
+          kind = CDBA_SQL_UNKNOWN;
+        }
+        continue;
+      }
+      //queries can start with parentheses
+      if (!CDBA_SQL_TOKEN_IS_SYMBOL(token, '('))
+        kind = CDBA_SQL_UNKNOWN;
+    }
+    //look for table names
+    switch (state) {
+      case CDBA_SQL_STATE_TABLE :
+        if (cdba_sql_token_in(&token, cdba_sql_table_modifiers) || cdba_sql_token_in(&token, cdba_sql_table_keywords))
+          continue;
+        state = CDBA_SQL_STATE_NORMAL;
+        if (token.type == CDBA_SQL_TOKEN_WORD || token.type == CDBA_SQL_TOKEN_IDENTIFIER) {
+          cdba_sql_tables_add(&list, &token, 0);
+          state = CDBA_SQL_STATE_AFTERNAME;
+          continue;
         }
         break;
-      case CDBA_TYPE_FLOAT :
-        {
-          double val = va_arg(argp, db_flt);
-          sqlite3_bind_double(stmt->sqlite3_prepstat, i + 1, val);
+      case CDBA_SQL_STATE_AFTERNAME :
+        if (CDBA_SQL_TOKEN_IS_SYMBOL(token, '.')) {
+          state = CDBA_SQL_STATE_QUALIFIED;
+          continue;
         }
+        if (cdba_sql_token_is(&token, "as"))
+          continue;
+        state = CDBA_SQL_STATE_NORMAL;
+        //skip alias
+        if (token.type == CDBA_SQL_TOKEN_IDENTIFIER || (token.type == CDBA_SQL_TOKEN_WORD && !cdba_sql_token_in(&token, cdba_sql_alias_stop_keywords)))
+          continue;
         break;
-      case CDBA_TYPE_TEXT :
-        {
-          const char* val = va_arg(argp, const char*);
-          if (val)
-            sqlite3_bind_text(stmt->sqlite3_prepstat, i + 1, val, -1, SQLITE_STATIC);
-          else
-            sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+      case CDBA_SQL_STATE_QUALIFIED :
+        state = CDBA_SQL_STATE_NORMAL;
+        if (token.type == CDBA_SQL_TOKEN_WORD || token.type == CDBA_SQL_TOKEN_IDENTIFIER) {
+          cdba_sql_tables_add(&list, &token, 1);
+          state = CDBA_SQL_STATE_AFTERNAME;
+          continue;
         }
         break;
-      default :
-        cdba_prep_set_error(stmt, "Unknown database type");
-        sqlite3_reset(stmt->sqlite3_prepstat);
-        sqlite3_clear_bindings(stmt->sqlite3_prepstat);
-        va_end(argp);
-        return -1;
+    }
+    if (token.type == CDBA_SQL_TOKEN_SYMBOL) {
+      if (*token.text == '(') {
+        if (++depth < CDBA_SQL_MAX_DEPTH)
+          fromlist[depth] = 0;
+        else
+          kind = CDBA_SQL_UNKNOWN;
+      } else if (*token.text == ')') {
+        if (depth > 0)
+          depth--;
+      } else if (*token.text == ',') {
+        if (depth < CDBA_SQL_MAX_DEPTH && fromlist[depth])
+          state = CDBA_SQL_STATE_TABLE;
+#if !defined(DB_SQLITE3)
+      } else if (*token.text == '@') {
+        //variables can change without any table being written (SQLite3 uses @ for arguments)
+        if (kind == CDBA_SQL_READ)
+          kind = CDBA_SQL_NOCHANGE;
+#endif
+      }
+      continue;
+    }
+    if (token.type == CDBA_SQL_TOKEN_STRING) {
+      //SQLite3 date and time functions use 'now' for the current time
+      if (kind == CDBA_SQL_READ && cdba_sql_text_is(token.text, token.len, "now"))
+        kind = CDBA_SQL_NOCHANGE;
+      continue;
+    }
+    if (token.type != CDBA_SQL_TOKEN_WORD)
+      continue;
+    //locking reads are not cached
+    if (afterfor) {
+      afterfor = 0;
+      if (cdba_sql_token_is(&token, "update") || cdba_sql_token_is(&token, "share")) {
+        if (kind == CDBA_SQL_READ)
+          kind = CDBA_SQL_NOCHANGE;
+        continue;
+      }
+    }
+    if (cdba_sql_token_is(&token, "for"))
+      afterfor = 1;
+    else if (kind == CDBA_SQL_READ && cdba_sql_token_is(&token, "lock"))
+      kind = CDBA_SQL_NOCHANGE;
+    //data changing statements inside queries (e.g. in common table expressions) or statements that don't change data
+    if (cdba_sql_token_in(&token, cdba_sql_write_keywords)) {
+      if (kind == CDBA_SQL_READ)
+        kind = CDBA_SQL_WRITE;
+      else if (kind == CDBA_SQL_NOCHANGE)
+        kind = CDBA_SQL_UNKNOWN;
+    }
+    if (kind == CDBA_SQL_READ && cdba_sql_token_in(&token, cdba_sql_volatile_functions))
+      kind = CDBA_SQL_NOCHANGE;
+    if (ddl && cdba_sql_token_in(&token, cdba_sql_ddl_objects))
+      kind = CDBA_SQL_UNKNOWN;
+    if (cdba_sql_token_in(&token, cdba_sql_table_keywords)) {
+      state = CDBA_SQL_STATE_TABLE;
+      if (depth < CDBA_SQL_MAX_DEPTH)
+        fromlist[depth] = 1;
+    } else if (depth < CDBA_SQL_MAX_DEPTH && cdba_sql_token_in(&token, cdba_sql_clause_keywords)) {
+      fromlist[depth] = 0;
+    }
+  } while (more);
+  if (list.error)
+    result = CDBA_SQL_UNKNOWN;
+  else if (result == CDBA_SQL_UNCLASSIFIED || (result == CDBA_SQL_READ && statements > 1))
+    result = CDBA_SQL_NOCHANGE;
+  if (result == CDBA_SQL_READ || result == CDBA_SQL_WRITE)
+    *tables = list.names;
+  else
+    free(list.names);
+  return result;
+}
+
+#if defined(DB_SQLITE3)
+//check if a list of table names contains a name (without regard to case)
+static int cdba_sql_tables_contain (const char* tables, const char* name)
+{
+  const char* p;
+  size_t len = strlen(name);
+  if (tables) {
+    for (p = tables; *p; p += strlen(p) + 1) {
+      if (cdba_sql_text_is(name, len, p))
+        return 1;
     }
   }
-  //fetch first row
-  stmt->sqlite3_first_step_status = -1;
-  i = 0;
-  while (i++ < RETRY_ATTEMPTS && ((stmt->sqlite3_first_step_status = sqlite3_step(stmt->sqlite3_prepstat)) == SQLITE_BUSY || stmt->sqlite3_first_step_status == SQLITE_LOCKED)) {
-    WAIT_BEFORE_RETRY(RETRY_WAIT_TIME)
+  return 0;
+}
+
+//add each table read by a statement being compiled to the list of tables
+static int cdba_sqlite3_read_tables_authorizer (void* data, int action, const char* table, const char* column, const char* dbname, const char* trigger)
+{
+  struct cdba_sql_tables_struct* list = (struct cdba_sql_tables_struct*)data;
+  struct cdba_sql_token_struct token;
+  (void)column;
+  (void)dbname;
+  (void)trigger;
+  if (action == SQLITE_READ && table && !cdba_sql_tables_contain(list->names, table)) {
+    token.type = CDBA_SQL_TOKEN_WORD;
+    token.text = table;
+    token.len = strlen(table);
+    cdba_sql_tables_add(list, &token, 0);
   }
-  switch (stmt->sqlite3_first_step_status) {
-    case SQLITE_OK :
-    case SQLITE_DONE :
-    case SQLITE_ROW :
-      status = 0;
-      break;
-    default :
-      status = -1;
-      cdba_prep_set_error(stmt, sqlite3_errmsg(sqlite3_db_handle(stmt->sqlite3_prepstat)));
-      break;
+  return SQLITE_OK;
+}
+
+//add the tables read by a query to the list of tables found in its SQL, this includes the tables underlying views, returns non-zero on error
+static int cdba_sqlite3_add_read_tables (cdba_handle db, const char* sql, size_t sqllen, char** tables)
+{
+  struct cdba_sql_tables_struct list = {NULL, 0, 0, 0, 0};
+  sqlite3_stmt* stmt = NULL;
+  int status;
+  if (*tables) {
+    list.names = *tables;
+    list.len = cdba_sql_tables_length(*tables) - 1;
+    list.size = list.len + 1;
+  }
+  //SQLite reports the tables a statement reads to the authorizer while compiling it
+  sqlite3_set_authorizer(db->sqlite3_conn, cdba_sqlite3_read_tables_authorizer, &list);
+  status = sqlite3_prepare_v2(db->sqlite3_conn, sql, (int)sqllen, &stmt, NULL);
+  sqlite3_set_authorizer(db->sqlite3_conn, NULL, NULL);
+  sqlite3_finalize(stmt);
+  *tables = list.names;
+  return (status != SQLITE_OK || list.error ? -1 : 0);
+}
+#endif
+
+//get the kind of a prepared statement (CDBA_SQL_*), it is only determined once
+static int cdba_prep_sql_kind (cdba_prep_handle stmt)
+{
+  if (stmt->sqlkind == CDBA_SQL_UNCLASSIFIED) {
+    stmt->sqlkind = cdba_sql_classify(stmt->sql, stmt->sqllen, &stmt->sqltables);
+#if defined(DB_SQLITE3)
+    //results read through views must also be removed when the tables underlying them are written
+    if (stmt->sqlkind == CDBA_SQL_READ && cdba_sqlite3_add_read_tables(stmt->db, stmt->sql, stmt->sqllen, &stmt->sqltables) != 0)
+      stmt->sqlkind = CDBA_SQL_NOCHANGE;
+#endif
+  }
+  return stmt->sqlkind;
+}
+
+//cached value of a result column
+struct cdba_result_cache_value_struct {
+  union {
+    db_int intval;
+    db_flt floatval;
+  } value;
+  db_int type;
+  size_t offset;                                    //position of the text in the data of the entry, CDBA_NTS for NULL values
+  size_t len;                                       //length of the text
+};
+
+struct cdba_result_cache_entry_struct {
+  struct cdba_result_cache_entry_struct* hashnext;
+  struct cdba_result_cache_entry_struct* lruprev;   //more recently used entry
+  struct cdba_result_cache_entry_struct* lrunext;   //less recently used entry
+  uint32_t hash;
+  char* key;                                        //SQL text followed by the arguments (stored after the entry)
+  size_t keylen;
+  char* tables;                                     //tables the result was read from (stored after the key)
+  uint64_t expires;                                 //time when the result is no longer valid (in microseconds), 0 if it doesn't expire
+  int numcols;
+  size_t numrows;
+  struct cdba_result_cache_value_struct* values;    //numcols values for each row
+  size_t valuessize;                                //number of values allocated while recording
+  char* data;                                       //text of all values, each followed by a zero byte
+  size_t datalen;
+  size_t datasize;
+  size_t size;                                      //memory used by the entry
+  unsigned int refs;                                //number of iterations over the entry in progress
+  int removed;                                      //set when the entry is removed from the cache while in use
+  int failed;                                       //set when recording the result failed or it became too large
+};
+
+//build the key of the result of a prepared statement with its current arguments in db->rescache_key, returns its length or 0 if the result can't be cached
+static size_t cdba_result_cache_key (cdba_prep_handle stmt)
+{
+  cdba_handle db = stmt->db;
+  struct cdba_param_buffer_struct* param;
+  char* key;
+  size_t size;
+  size_t pos;
+  db_int type;
+  int i;
+  //determine the length (arguments not bound are NULL)
+  size = stmt->sqllen + 1;
+  for (i = 0; i < stmt->numargs; i++) {
+    size += sizeof(db_int);
+    if (!stmt->params)
+      continue;
+    param = &stmt->params[i];
+    if (param->type == CDBA_PARAM_TYPE_STREAM)
+      return 0;
+    if (param->type == CDBA_TYPE_INT || param->type == CDBA_TYPE_FLOAT)
+      size += sizeof(param->value);
+    else if (param->type == CDBA_TYPE_TEXT || param->type == CDBA_TYPE_BLOB)
+      size += sizeof(size_t) + param->len;
+  }
+  if (size > db->rescache_keysize) {
+    if ((key = (char*)realloc(db->rescache_key, size)) == NULL)
+      return 0;
+    db->rescache_key = key;
+    db->rescache_keysize = size;
+  }
+  key = db->rescache_key;
+  memcpy(key, stmt->sql, stmt->sqllen + 1);
+  pos = stmt->sqllen + 1;
+  for (i = 0; i < stmt->numargs; i++) {
+    param = (stmt->params ? &stmt->params[i] : NULL);
+    type = (param ? param->type : CDBA_TYPE_NULL);
+    memcpy(key + pos, &type, sizeof(type));
+    pos += sizeof(type);
+    if (type == CDBA_TYPE_INT || type == CDBA_TYPE_FLOAT) {
+      memcpy(key + pos, &param->value, sizeof(param->value));
+      pos += sizeof(param->value);
+    } else if (type == CDBA_TYPE_TEXT || type == CDBA_TYPE_BLOB) {
+      memcpy(key + pos, &param->len, sizeof(size_t));
+      pos += sizeof(size_t);
+      memcpy(key + pos, param->text, param->len);
+      pos += param->len;
+    }
+  }
+  return pos;
+}
+
+//calculate hash (FNV-1a) of a result cache key
+static uint32_t cdba_result_cache_hash (const char* key, size_t len)
+{
+  uint32_t hash = 2166136261u;
+  const char* p;
+  for (p = key; p < key + len; p++) {
+    hash ^= (uint8_t)*p;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+//free an entry that is not in the cache
+static void cdba_result_cache_entry_free (struct cdba_result_cache_entry_struct* entry)
+{
+  free(entry->values);
+  free(entry->data);
+  free(entry);
+}
+
+//unlink entry from the most recently used list
+static void cdba_result_cache_lru_unlink (cdba_handle db, struct cdba_result_cache_entry_struct* entry)
+{
+  if (entry->lruprev)
+    entry->lruprev->lrunext = entry->lrunext;
+  else
+    db->rescache_mru = entry->lrunext;
+  if (entry->lrunext)
+    entry->lrunext->lruprev = entry->lruprev;
+  else
+    db->rescache_lru = entry->lruprev;
+  entry->lruprev = NULL;
+  entry->lrunext = NULL;
+}
+
+//put entry at the front of the most recently used list
+static void cdba_result_cache_lru_push (cdba_handle db, struct cdba_result_cache_entry_struct* entry)
+{
+  entry->lruprev = NULL;
+  entry->lrunext = db->rescache_mru;
+  if (db->rescache_mru)
+    db->rescache_mru->lruprev = entry;
+  else
+    db->rescache_lru = entry;
+  db->rescache_mru = entry;
+}
+
+//remove entry from the cache and free it unless it is in use
+static void cdba_result_cache_remove (cdba_handle db, struct cdba_result_cache_entry_struct* entry)
+{
+  struct cdba_result_cache_entry_struct** p;
+  p = &db->rescache_buckets[entry->hash & (db->rescache_numbuckets - 1)];
+  while (*p != entry)
+    p = &(*p)->hashnext;
+  *p = entry->hashnext;
+  cdba_result_cache_lru_unlink(db, entry);
+  db->rescache_stats.count--;
+  db->rescache_stats.size -= entry->size;
+  //an entry still in use is freed at the end of the iteration
+  if (entry->refs > 0)
+    entry->removed = 1;
+  else
+    cdba_result_cache_entry_free(entry);
+}
+
+//remove least recently used entries until the cache fits in the specified size
+static void cdba_result_cache_trim (cdba_handle db, size_t maxsize)
+{
+  while (db->rescache_lru && db->rescache_stats.size > maxsize) {
+    cdba_result_cache_remove(db, db->rescache_lru);
+    db->rescache_stats.evictions++;
+  }
+}
+
+//remove all cached results
+static void cdba_result_cache_flush (cdba_handle db)
+{
+  db->rescache_generation++;
+  while (db->rescache_mru)
+    cdba_result_cache_remove(db, db->rescache_mru);
+  free(db->rescache_buckets);
+  db->rescache_buckets = NULL;
+  db->rescache_numbuckets = 0;
+}
+
+//remove cached results read from any of the specified tables or all cached results if tables is NULL
+static void cdba_result_cache_invalidate (cdba_handle db, const char* tables)
+{
+  struct cdba_result_cache_entry_struct* entry;
+  struct cdba_result_cache_entry_struct* next;
+  //results being recorded may be affected as well
+  db->rescache_generation++;
+  for (entry = db->rescache_mru; entry; entry = next) {
+    next = entry->lrunext;
+    if (!tables || cdba_sql_tables_intersect(entry->tables, tables)) {
+      cdba_result_cache_remove(db, entry);
+      db->rescache_stats.invalidations++;
+    }
+  }
+}
+
+//invalidate cached results affected by SQL executed on the database connection
+static void cdba_result_cache_sql_executed (cdba_handle db, const char* sql, size_t sqllen)
+{
+  char* tables;
+  int kind;
+  if (db->rescache_stats.capacity == 0 || !sql)
+    return;
+  kind = cdba_sql_classify(sql, sqllen, &tables);
+  if (kind == CDBA_SQL_WRITE)
+    cdba_result_cache_invalidate(db, tables);
+  else if (kind == CDBA_SQL_UNKNOWN)
+    cdba_result_cache_invalidate(db, NULL);
+  free(tables);
+}
+
+//invalidate cached results affected by the execution of a prepared statement
+static void cdba_result_cache_statement_executed (cdba_prep_handle stmt)
+{
+  if (stmt->db->rescache_stats.capacity == 0)
+    return;
+  switch (cdba_prep_sql_kind(stmt)) {
+    case CDBA_SQL_WRITE :
+      cdba_result_cache_invalidate(stmt->db, stmt->sqltables);
+      break;
+    case CDBA_SQL_UNKNOWN :
+      cdba_result_cache_invalidate(stmt->db, NULL);
+      break;
+  }
+}
+
+//invalidate cached results read from a table written without SQL the result cache can see (e.g. by the bulk loader)
+static void cdba_result_cache_table_written (cdba_handle db, const char* table)
+{
+  struct cdba_sql_token_struct token;
+  struct cdba_sql_tables_struct list = {NULL, 0, 0, 0, 0};
+  const char* end;
+  int qualified = 0;
+  if (db->rescache_stats.capacity == 0)
+    return;
+  //the name can be quoted and qualified with a schema name
+  end = table + strlen(table);
+  while (cdba_sql_next_token(&table, end, &token)) {
+    if (CDBA_SQL_TOKEN_IS_SYMBOL(token, '.')) {
+      qualified = 1;
+    } else if (token.type == CDBA_SQL_TOKEN_WORD || token.type == CDBA_SQL_TOKEN_IDENTIFIER) {
+      cdba_sql_tables_add(&list, &token, qualified);
+      qualified = 0;
+    }
+  }
+  //all results are removed when the name can't be used
+  cdba_result_cache_invalidate(db, (list.error || !list.names ? NULL : list.names));
+  free(list.names);
+}
+
+#if defined(DB_SQLITE3)
+//remember the tables written on the connection, this includes writes done by triggers and foreign key actions
+//it is called for each row, so the cached results are only removed when the cache is used again (see cdba_result_cache_apply_writes())
+static void cdba_sqlite3_update_hook (void* data, int op, const char* dbname, const char* table, sqlite3_int64 rowid)
+{
+  cdba_handle db = (cdba_handle)data;
+  struct cdba_sql_token_struct token;
+  (void)op;
+  (void)dbname;
+  (void)rowid;
+  if (!db->sqlite3_written && (db->sqlite3_written = (struct cdba_sql_tables_struct*)calloc(1, sizeof(struct cdba_sql_tables_struct))) == NULL) {
+    cdba_result_cache_invalidate(db, NULL);
+    return;
+  }
+  if (!cdba_sql_tables_contain(db->sqlite3_written->names, table)) {
+    token.type = CDBA_SQL_TOKEN_WORD;
+    token.text = table;
+    token.len = strlen(table);
+    cdba_sql_tables_add(db->sqlite3_written, &token, 0);
+  }
+}
+#endif
+
+//remove cached results read from the tables the database reported as written
+static void cdba_result_cache_apply_writes (cdba_handle db)
+{
+#if defined(DB_SQLITE3)
+  struct cdba_sql_tables_struct* written = db->sqlite3_written;
+  if (written && (written->len > 0 || written->error)) {
+    cdba_result_cache_invalidate(db, (written->error ? NULL : written->names));
+    if (written->names)
+      written->names[0] = 0;
+    written->len = 0;
+    written->error = 0;
+  }
+#else
+  (void)db;
+#endif
+}
+
+//find a valid cached result for the key in db->rescache_key
+static struct cdba_result_cache_entry_struct* cdba_result_cache_find (cdba_handle db, uint32_t hash, size_t keylen)
+{
+  struct cdba_result_cache_entry_struct* entry;
+  cdba_result_cache_apply_writes(db);
+  if (!db->rescache_buckets)
+    return NULL;
+  for (entry = db->rescache_buckets[hash & (db->rescache_numbuckets - 1)]; entry; entry = entry->hashnext) {
+    if (entry->hash == hash && entry->keylen == keylen && memcmp(entry->key, db->rescache_key, keylen) == 0) {
+      if (entry->expires && entry->expires <= cdba_get_time_us()) {
+        cdba_result_cache_remove(db, entry);
+        db->rescache_stats.expirations++;
+        return NULL;
+      }
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+//allocate hash buckets (number of buckets is a power of 2 and at least the number of cached results)
+static int cdba_result_cache_rehash (cdba_handle db, size_t count)
+{
+  struct cdba_result_cache_entry_struct** buckets;
+  struct cdba_result_cache_entry_struct* entry;
+  size_t numbuckets = 64;
+  size_t i;
+  while (numbuckets < count)
+    numbuckets <<= 1;
+  if (numbuckets <= db->rescache_numbuckets)
+    return 0;
+  if ((buckets = (struct cdba_result_cache_entry_struct**)malloc(sizeof(struct cdba_result_cache_entry_struct*) * numbuckets)) == NULL)
+    return -1;
+  for (i = 0; i < numbuckets; i++)
+    buckets[i] = NULL;
+  for (entry = db->rescache_mru; entry; entry = entry->lrunext) {
+    entry->hashnext = buckets[entry->hash & (numbuckets - 1)];
+    buckets[entry->hash & (numbuckets - 1)] = entry;
+  }
+  free(db->rescache_buckets);
+  db->rescache_buckets = buckets;
+  db->rescache_numbuckets = numbuckets;
+  return 0;
+}
+
+//create an entry for recording the result of a prepared statement with the key in db->rescache_key
+static struct cdba_result_cache_entry_struct* cdba_result_cache_entry_create (cdba_prep_handle stmt, uint32_t hash, size_t keylen)
+{
+  struct cdba_result_cache_entry_struct* entry;
+  size_t tableslen = cdba_sql_tables_length(stmt->sqltables);
+  if ((entry = (struct cdba_result_cache_entry_struct*)malloc(sizeof(struct cdba_result_cache_entry_struct) + keylen + tableslen)) == NULL)
+    return NULL;
+  entry->hashnext = NULL;
+  entry->lruprev = NULL;
+  entry->lrunext = NULL;
+  entry->hash = hash;
+  entry->key = (char*)(entry + 1);
+  memcpy(entry->key, stmt->db->rescache_key, keylen);
+  entry->keylen = keylen;
+  entry->tables = entry->key + keylen;
+  memcpy(entry->tables, stmt->sqltables, tableslen);
+  entry->expires = 0;
+  entry->numcols = cdba_prep_get_column_count(stmt);
+  entry->numrows = 0;
+  entry->values = NULL;
+  entry->valuessize = 0;
+  entry->data = NULL;
+  entry->datalen = 0;
+  entry->datasize = 0;
+  entry->size = sizeof(struct cdba_result_cache_entry_struct) + keylen + tableslen;
+  entry->refs = 0;
+  entry->removed = 0;
+  entry->failed = 0;
+  return entry;
+}
+
+//add the current row to the result being recorded, recording stops when it doesn't fit in the cache
+static void cdba_result_cache_record_row (struct cdba_result_cache_entry_struct* entry, cdba_row row, size_t maxsize)
+{
+  struct cdba_result_cache_value_struct* values;
+  struct cdba_result_cache_value_struct* value;
+  const char* text;
+  char* data;
+  size_t size;
+  size_t len;
+  int i;
+  if (entry->failed)
+    return;
+  //make room for the values of the row
+  if ((entry->numrows + 1) * entry->numcols > entry->valuessize) {
+    size = (entry->valuessize ? entry->valuessize * 2 : (size_t)entry->numcols * 16);
+    if ((values = (struct cdba_result_cache_value_struct*)realloc(entry->values, sizeof(struct cdba_result_cache_value_struct) * size)) == NULL) {
+      entry->failed = 1;
+      return;
+    }
+    entry->values = values;
+    entry->valuessize = size;
+  }
+  value = entry->values + entry->numrows * entry->numcols;
+  for (i = 0; i < entry->numcols; i++, value++) {
+    value->type = cdba_row_get_type(row, i);
+    value->value.intval = 0;
+    value->len = 0;
+    if (value->type == CDBA_TYPE_NULL || cdba_row_is_null(row, i)) {
+      value->offset = CDBA_NTS;
+      continue;
+    }
+    if (value->type == CDBA_TYPE_INT)
+      value->value.intval = cdba_row_get_int(row, i);
+    else if (value->type == CDBA_TYPE_FLOAT)
+      value->value.floatval = cdba_row_get_float(row, i);
+    //keep the text of all values so it is returned as when reading from the database
+    text = (value->type == CDBA_TYPE_BLOB ? (const char*)cdba_row_get_blob(row, i, &len) : cdba_row_get_text(row, i, &len));
+    if (!text)
+      len = 0;
+    if (entry->datalen + len + 1 > entry->datasize) {
+      size = (entry->datalen + len + 1) * 2;
+      if (size < 256)
+        size = 256;
+      if ((data = (char*)realloc(entry->data, size)) == NULL) {
+        entry->failed = 1;
+        return;
+      }
+      entry->data = data;
+      entry->datasize = size;
+    }
+    if (len > 0)
+      memcpy(entry->data + entry->datalen, text, len);
+    entry->data[entry->datalen + len] = 0;
+    value->offset = entry->datalen;
+    value->len = len;
+    entry->datalen += len + 1;
+  }
+  entry->numrows++;
+  if (entry->size + entry->numrows * entry->numcols * sizeof(struct cdba_result_cache_value_struct) + entry->datalen > maxsize)
+    entry->failed = 1;
+}
+
+//add a recorded result to the cache, the entry is freed if it can't be added
+static void cdba_result_cache_insert (cdba_handle db, struct cdba_result_cache_entry_struct* entry)
+{
+  struct cdba_result_cache_entry_struct* old;
+  void* p;
+  //release unused memory
+  if (entry->numrows * entry->numcols == 0) {
+    free(entry->values);
+    entry->values = NULL;
+  } else if ((p = realloc(entry->values, sizeof(struct cdba_result_cache_value_struct) * entry->numrows * entry->numcols)) != NULL) {
+    entry->values = (struct cdba_result_cache_value_struct*)p;
+  }
+  if (entry->datalen == 0) {
+    free(entry->data);
+    entry->data = NULL;
+  } else if ((p = realloc(entry->data, entry->datalen)) != NULL) {
+    entry->data = (char*)p;
+  }
+  entry->size += entry->numrows * entry->numcols * sizeof(struct cdba_result_cache_value_struct) + entry->datalen;
+  if (entry->size > db->rescache_stats.capacity || cdba_result_cache_rehash(db, db->rescache_stats.count + 1) != 0) {
+    cdba_result_cache_entry_free(entry);
+    return;
+  }
+  //replace a result with the same key added while this one was recorded
+  if ((old = cdba_result_cache_find(db, entry->hash, entry->keylen)) != NULL)
+    cdba_result_cache_remove(db, old);
+  cdba_result_cache_trim(db, db->rescache_stats.capacity - entry->size);
+  entry->expires = (db->rescache_ttl_us ? cdba_get_time_us() + db->rescache_ttl_us : 0);
+  entry->hashnext = db->rescache_buckets[entry->hash & (db->rescache_numbuckets - 1)];
+  db->rescache_buckets[entry->hash & (db->rescache_numbuckets - 1)] = entry;
+  cdba_result_cache_lru_push(db, entry);
+  db->rescache_stats.count++;
+  db->rescache_stats.size += entry->size;
+}
+
+DLL_EXPORT_CDBALIB void cdba_set_result_cache (cdba_handle db, size_t capacity, unsigned int ttl)
+{
+  cdba_result_cache_apply_writes(db);
+#if defined(DB_SQLITE3)
+  sqlite3_update_hook(db->sqlite3_conn, (capacity > 0 ? cdba_sqlite3_update_hook : NULL), db);
+  if (capacity == 0 && db->sqlite3_written) {
+    free(db->sqlite3_written->names);
+    free(db->sqlite3_written);
+    db->sqlite3_written = NULL;
+  }
+#endif
+  db->rescache_stats.capacity = capacity;
+  db->rescache_ttl_us = cdba_result_cache_ttl_us(ttl);
+  if (capacity == 0)
+    cdba_result_cache_flush(db);
+  else
+    cdba_result_cache_trim(db, capacity);
+}
+
+DLL_EXPORT_CDBALIB void cdba_clear_result_cache (cdba_handle db)
+{
+  cdba_result_cache_flush(db);
+}
+
+DLL_EXPORT_CDBALIB void cdba_get_result_cache_stats (cdba_handle db, cdba_result_cache_stats* stats)
+{
+  cdba_result_cache_apply_writes(db);
+  *stats = db->rescache_stats;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#if defined(DB_MYSQL)
+//process the result of mysql_stmt_execute()
+static int cdba_prep_mysql_executed (cdba_prep_handle stmt, int status)
+{
+  if (status != 0) {
+    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+    cdba_prep_reset(stmt);
+    return -1;
+  }
+  //result bindings are only rebuilt when the number of result columns changed (e.g. after the server re-prepared the statement)
+  if ((int)mysql_stmt_field_count(stmt->mysql_prepstat) != stmt->numcols) {
+    if (cdba_prep_mysql_bind_result(stmt) != 0) {
+      cdba_prep_reset(stmt);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//check if the result of an executed statement needs to be buffered on the client
+static int cdba_prep_mysql_needs_store (cdba_prep_handle stmt)
+{
+  return (stmt->mysql_fetch_mode == CDBA_FETCH_MODE_BUFFERED && stmt->numcols > 0);
+}
+
+//process the result of mysql_stmt_store_result()
+static int cdba_prep_mysql_stored (cdba_prep_handle stmt, int status)
+{
+  if (status != 0) {
+    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+    cdba_prep_reset(stmt);
+    return -1;
+  }
+  return 0;
+}
+
+//convert the result of mysql_stmt_fetch() to the result of cdba_prep_fetch_row()
+static int cdba_prep_mysql_fetched (int status)
+{
+  if (status == 0 || status == MYSQL_DATA_TRUNCATED)
+    return 1;
+  return (status == MYSQL_NO_DATA ? 0 : -1);
+}
+#endif
+
+#if defined(DB_ODBC)
+//send arguments bound for data at execution in chunks after SQLExecute() returned SQL_NEED_DATA
+static int cdba_prep_odbc_put_data (cdba_prep_handle stmt)
+{
+  SQLRETURN status;
+  SQLPOINTER token;
+  struct cdba_param_buffer_struct* param;
+  size_t n;
+  int sent;
+  while ((status = SQLParamData(stmt->odbc_prepstat, &token)) == SQL_NEED_DATA) {
+    param = (struct cdba_param_buffer_struct*)token;
+    if (cdba_param_buffer_reserve(stmt, param, CDBA_STREAM_CHUNK_SIZE) == NULL) {
+      SQLCancel(stmt->odbc_prepstat);
+      return -1;
+    }
+    //an empty value still needs one call to SQLPutData()
+    sent = 0;
+    while ((n = param->reader(param->streamdata, param->text, param->textsize)) > 0 || !sent) {
+      status = SQLPutData(stmt->odbc_prepstat, param->text, (SQLLEN)n);
+      if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+        cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+        SQLCancel(stmt->odbc_prepstat);
+        return -2;
+      }
+      sent = 1;
+      if (n == 0)
+        break;
+    }
+  }
+  if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+    cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+    return -2;
+  }
+  return status;
+}
+#endif
+
+static int cdba_prep_run_execute (cdba_prep_handle stmt)
+{
+  int status = 0;
+  stmt->row_pending = 0;
+#if defined(DB_MYSQL)
+  //execute statement
+  if ((status = cdba_prep_mysql_executed(stmt, mysql_stmt_execute(stmt->mysql_prepstat))) != 0)
+    return status;
+  //read the complete result so the server is done with the statement
+  if (cdba_prep_mysql_needs_store(stmt) && (status = cdba_prep_mysql_stored(stmt, mysql_stmt_store_result(stmt->mysql_prepstat))) != 0)
+    return status;
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  //fetch first row
+  stmt->sqlite3_first_step_status = cdba_sqlite3_step(stmt->db, stmt->sqlite3_prepstat);
+  switch (stmt->sqlite3_first_step_status) {
+    case SQLITE_OK :
+    case SQLITE_DONE :
+    case SQLITE_ROW :
+      status = 0;
+      break;
+    default :
+      status = -1;
+      cdba_prep_set_error(stmt, sqlite3_errmsg(sqlite3_db_handle(stmt->sqlite3_prepstat)));
+      break;
+  }
+#elif defined(DB_ODBC)
+  SQLRETURN odbcstatus;
+  cdba_prep_odbc_rowset_end(stmt);
+  odbcstatus = SQLExecute(stmt->odbc_prepstat);
+  if (odbcstatus == SQL_NEED_DATA)
+    return cdba_prep_odbc_put_data(stmt);
+  if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO) {
+    cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+    /////cdba_set_odbc_error(NULL, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+    return -2;
+  }
+  status = odbcstatus;
+#else
+#endif
+  return status;
+}
+
+//number of rows affected by the last execution of a prepared statement
+static uint64_t cdba_prep_stats_rows_affected (cdba_prep_handle stmt, uint64_t changes)
+{
+#if defined(DB_MYSQL)
+  my_ulonglong rows;
+  (void)changes;
+  if (mysql_stmt_field_count(stmt->mysql_prepstat) == 0 && (rows = mysql_stmt_affected_rows(stmt->mysql_prepstat)) != (my_ulonglong)-1)
+    return rows;
+  return 0;
+#elif defined(DB_SQLITE3)
+  return (cdba_stats_total_changes(stmt->db) != changes ? (uint64_t)sqlite3_changes(stmt->db->sqlite3_conn) : 0);
+#elif defined(DB_ODBC)
+  SQLLEN rows = 0;
+  (void)changes;
+  if (stmt->numcols == 0 && SQLRowCount(stmt->odbc_prepstat, &rows) == SQL_SUCCESS && rows > 0)
+    return (uint64_t)rows;
+  return 0;
+#else
+  (void)stmt;
+  (void)changes;
+  return 0;
+#endif
+}
+
+static int cdba_prep_run (cdba_prep_handle stmt)
+{
+  int status;
+  uint64_t start = CDBA_STATS_START(stmt->db);
+  uint64_t retries = stmt->db->busystats.retries;
+  uint64_t changes = cdba_stats_total_changes(stmt->db);
+  cdba_arena_recycle(stmt->arena);
+  status = cdba_prep_run_execute(stmt);
+  cdba_stats_record_execute(stmt->db, &stmt->stats, start, 1, (status < 0), (status >= 0 ? cdba_prep_stats_rows_affected(stmt, changes) : 0), stmt->db->busystats.retries - retries);
+  cdba_result_cache_statement_executed(stmt);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_va (cdba_prep_handle stmt, va_list argp)
+{
+  int i;
+  int type;
+  int status = 0;
+#if !defined(DB_ODBC)
+  //arguments bound with cdba_prep_bind_*() will need to be bound again
+  cdba_param_buffers_invalidate(stmt->params, stmt->numargs);
+#endif
+#if defined(DB_MYSQL)
+  MYSQL_BIND* bindarg = stmt->mysql_bind_param;
+  struct mysql_argbindinfo_struct* argcopy = stmt->mysql_bind_args;
+  //bind arguments
+  if (stmt->numargs > 0) {
+    memset(bindarg, 0, sizeof(MYSQL_BIND) * stmt->numargs);
+    for (i = 0; i < stmt->numargs; i++) {
+      type = va_arg(argp, int);
+      switch (type) {
+        case CDBA_TYPE_NULL :
+          bindarg[i].buffer_type = MYSQL_TYPE_NULL;
+          bindarg[i].buffer = NULL;
+          break;
+        case CDBA_TYPE_INT :
+          argcopy[i].intval = (long long)va_arg(argp, db_int);
+          bindarg[i].buffer_type = MYSQL_TYPE_LONGLONG;
+          bindarg[i].buffer = &(argcopy[i].intval);
+          break;
+        case CDBA_TYPE_FLOAT :
+          argcopy[i].floatval = va_arg(argp, db_flt);
+          bindarg[i].buffer_type = MYSQL_TYPE_DOUBLE;
+          bindarg[i].buffer = &(argcopy[i].intval);
+          break;
+        case CDBA_TYPE_TEXT :
+          bindarg[i].buffer = va_arg(argp, char*);
+          if (bindarg[i].buffer) {
+            bindarg[i].buffer_type = MYSQL_TYPE_STRING;
+            bindarg[i].buffer_length = strlen(bindarg[i].buffer);
+          } else {
+            bindarg[i].buffer_type = MYSQL_TYPE_NULL;
+          }
+          break;
+        case CDBA_TYPE_BLOB :
+          bindarg[i].buffer = va_arg(argp, void*);
+          bindarg[i].buffer_length = va_arg(argp, size_t);
+          bindarg[i].buffer_type = (bindarg[i].buffer ? MYSQL_TYPE_BLOB : MYSQL_TYPE_NULL);
+          break;
+        default :
+          cdba_prep_set_error(stmt, "Unknown database type");
+          cdba_prep_reset(stmt);
+          return -1;
+      }
+    }
+    mysql_stmt_bind_param(stmt->mysql_prepstat, bindarg);
+  }
+  //execute statement
+  status = cdba_prep_run(stmt);
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  //bind arguments
+  for (i = 0; i < stmt->numargs; i++) {
+    type = va_arg(argp, int);
+    switch (type) {
+      case CDBA_TYPE_NULL :
+        sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+        break;
+      case CDBA_TYPE_INT :
+        {
+          int64_t val = va_arg(argp, db_int);
+          sqlite3_bind_int64(stmt->sqlite3_prepstat, i + 1, val);
+        }
+        break;
+      case CDBA_TYPE_FLOAT :
+        {
+          double val = va_arg(argp, db_flt);
+          sqlite3_bind_double(stmt->sqlite3_prepstat, i + 1, val);
+        }
+        break;
+      case CDBA_TYPE_TEXT :
+        {
+          const char* val = va_arg(argp, const char*);
+          if (val)
+            sqlite3_bind_text(stmt->sqlite3_prepstat, i + 1, val, -1, SQLITE_STATIC);
+          else
+            sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+        }
+        break;
+      case CDBA_TYPE_BLOB :
+        {
+          const void* val = va_arg(argp, const void*);
+          size_t len = va_arg(argp, size_t);
+          if (val)
+            sqlite3_bind_blob(stmt->sqlite3_prepstat, i + 1, val, (int)len, SQLITE_STATIC);
+          else
+            sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+        }
+        break;
+      default :
+        cdba_prep_set_error(stmt, "Unknown database type");
+        sqlite3_reset(stmt->sqlite3_prepstat);
+        sqlite3_clear_bindings(stmt->sqlite3_prepstat);
+        return -1;
+    }
+  }
+  //execute statement and fetch first row
+  status = cdba_prep_run(stmt);
+#elif defined(DB_ODBC)
+  //arguments are copied into the buffers of the prepared statement, which are only bound again when their type changes or a value doesn't fit
+  for (i = 0; i < stmt->numargs; i++) {
+    type = va_arg(argp, int);
+    switch (type) {
+      case CDBA_TYPE_NULL :
+        status = cdba_prep_bind_null(stmt, i);
+        break;
+      case CDBA_TYPE_INT :
+        status = cdba_prep_bind_int(stmt, i, va_arg(argp, db_int));
+        break;
+      case CDBA_TYPE_FLOAT :
+        status = cdba_prep_bind_float(stmt, i, va_arg(argp, db_flt));
+        break;
+      case CDBA_TYPE_TEXT :
+        status = cdba_prep_bind_text(stmt, i, va_arg(argp, const char*), CDBA_NTS);
+        break;
+      case CDBA_TYPE_BLOB :
+        {
+          const void* val = va_arg(argp, const void*);
+          size_t len = va_arg(argp, size_t);
+          status = cdba_prep_bind_blob(stmt, i, val, len);
+        }
+        break;
+      default :
+        cdba_prep_set_error(stmt, "Unknown database type");
+        return -1;
+    }
+    if (status != 0)
+      return -1;
+  }
+  status = cdba_prep_execute_bound(stmt);
+#else
+#endif
+  return status;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute (cdba_prep_handle stmt, ...)
+{
+  int status;
+  va_list argp;
+  va_start(argp, stmt);
+  status = cdba_prep_execute_va(stmt, argp);
+  va_end(argp);
+  return status;
+}
+
+static struct cdba_param_buffer_struct* cdba_prep_get_param_buffer (cdba_prep_handle stmt, int index)
+{
+  int i;
+  if (index < 0 || index >= stmt->numargs) {
+    cdba_prep_set_error(stmt, "Invalid argument index");
+    return NULL;
+  }
+  if (!stmt->params) {
+    if ((stmt->params = (struct cdba_param_buffer_struct*)malloc(sizeof(struct cdba_param_buffer_struct) * stmt->numargs)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return NULL;
+    }
+    memset(stmt->params, 0, sizeof(struct cdba_param_buffer_struct) * stmt->numargs);
+    for (i = 0; i < stmt->numargs; i++)
+      stmt->params[i].type = CDBA_TYPE_NULL;
+  }
+  return &stmt->params[index];
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_null (cdba_prep_handle stmt, int index)
+{
+  struct cdba_param_buffer_struct* param;
+  if ((param = cdba_prep_get_param_buffer(stmt, index)) == NULL)
+    return -1;
+  if (param->type != CDBA_TYPE_NULL) {
+    param->type = CDBA_TYPE_NULL;
+    param->bound = 0;
+  }
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_int (cdba_prep_handle stmt, int index, db_int value)
+{
+  struct cdba_param_buffer_struct* param;
+  if ((param = cdba_prep_get_param_buffer(stmt, index)) == NULL)
+    return -1;
+  if (param->type != CDBA_TYPE_INT) {
+    param->type = CDBA_TYPE_INT;
+    param->bound = 0;
+  }
+  param->value.intval = value;
+#if defined(DB_SQLITE3)
+  //SQLite3 copies the value when binding
+  param->bound = 0;
+#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_float (cdba_prep_handle stmt, int index, db_flt value)
+{
+  struct cdba_param_buffer_struct* param;
+  if ((param = cdba_prep_get_param_buffer(stmt, index)) == NULL)
+    return -1;
+  if (param->type != CDBA_TYPE_FLOAT) {
+    param->type = CDBA_TYPE_FLOAT;
+    param->bound = 0;
+  }
+  param->value.floatval = value;
+#if defined(DB_SQLITE3)
+  //SQLite3 copies the value when binding
+  param->bound = 0;
+#endif
+  return 0;
+}
+
+//copy a text or binary value into the argument buffer
+static int cdba_prep_bind_buffer (cdba_prep_handle stmt, int index, db_int type, const char* value, size_t len)
+{
+  struct cdba_param_buffer_struct* param;
+  char* text;
+  if (!value)
+    return cdba_prep_bind_null(stmt, index);
+  if ((param = cdba_prep_get_param_buffer(stmt, index)) == NULL)
+    return -1;
+  if (param->type != type) {
+    param->type = type;
+    param->bound = 0;
+  }
+  //the buffer is kept and only grows when needed
+  if (len + 1 > param->textsize) {
+    if ((text = (char*)realloc(param->text, len + 1)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return -1;
+    }
+    param->text = text;
+    param->textsize = len + 1;
+    param->bound = 0;
+  }
+  memcpy(param->text, value, len);
+  param->text[len] = 0;
+  param->len = len;
+#if defined(DB_MYSQL)
+  param->mysql_len = len;
+#elif defined(DB_SQLITE3)
+  param->bound = 0;
+#elif defined(DB_ODBC)
+  param->odbc_len = len;
+  if (len > param->odbc_colsize)
+    param->bound = 0;
+#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_text (cdba_prep_handle stmt, int index, const char* value, size_t len)
+{
+  if (value && len == CDBA_NTS)
+    len = strlen(value);
+  return cdba_prep_bind_buffer(stmt, index, CDBA_TYPE_TEXT, value, len);
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_blob (cdba_prep_handle stmt, int index, const void* value, size_t len)
+{
+  return cdba_prep_bind_buffer(stmt, index, CDBA_TYPE_BLOB, (const char*)value, len);
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_bind_stream (cdba_prep_handle stmt, int index, size_t len, cdba_stream_read_fn reader, void* streamdata)
+{
+  struct cdba_param_buffer_struct* param;
+  if (!reader) {
+    cdba_prep_set_error(stmt, "No stream reader function");
+    return -1;
+  }
+  if ((param = cdba_prep_get_param_buffer(stmt, index)) == NULL)
+    return -1;
+  if (param->type != CDBA_PARAM_TYPE_STREAM) {
+    param->type = CDBA_PARAM_TYPE_STREAM;
+    param->bound = 0;
+  }
+  param->reader = reader;
+  param->streamdata = streamdata;
+  param->streamlen = len;
+#if defined(DB_ODBC)
+  //the length is part of the binding
+  param->bound = 0;
+#endif
+  return 0;
+}
+
+#if defined(DB_MYSQL)
+//send a streamed argument to the server in chunks, it is used by the next execution
+static int cdba_prep_mysql_send_stream (cdba_prep_handle stmt, int index)
+{
+  struct cdba_param_buffer_struct* param = &stmt->params[index];
+  size_t n;
+  if (cdba_param_buffer_reserve(stmt, param, CDBA_STREAM_CHUNK_SIZE) == NULL)
+    return -1;
+  while ((n = param->reader(param->streamdata, param->text, param->textsize)) > 0) {
+    if (mysql_stmt_send_long_data(stmt->mysql_prepstat, index, param->text, n) != 0) {
+      cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+      return -1;
+    }
+  }
+  return 0;
+}
+#elif defined(DB_SQLITE3)
+//read a streamed argument into the argument buffer as SQLite3 needs the complete value when binding
+static int cdba_prep_sqlite3_read_stream (cdba_prep_handle stmt, struct cdba_param_buffer_struct* param)
+{
+  size_t n;
+  if (cdba_param_buffer_reserve(stmt, param, (param->streamlen != CDBA_NTS ? param->streamlen + 1 : CDBA_STREAM_CHUNK_SIZE)) == NULL)
+    return -1;
+  param->len = 0;
+  while ((n = param->reader(param->streamdata, param->text + param->len, param->textsize - param->len - 1)) > 0) {
+    param->len += n;
+    if (param->streamlen != CDBA_NTS && param->len >= param->streamlen)
+      break;
+    if (param->len + 1 >= param->textsize && cdba_param_buffer_reserve(stmt, param, param->textsize * 2) == NULL)
+      return -1;
+  }
+  param->text[param->len] = 0;
+  return 0;
+}
+#endif
+
+//bind arguments set with cdba_prep_bind_*() that changed since the last execution
+static int cdba_prep_bind_arguments (cdba_prep_handle stmt)
+{
+  int i;
+  struct cdba_param_buffer_struct* param;
+  if (stmt->numargs > 0 && !stmt->params && cdba_prep_get_param_buffer(stmt, 0) == NULL)
+    return -1;
+  stmt->row_pending = 0;
+#if defined(DB_MYSQL)
+  //discard any pending results from a previous execution
+  mysql_stmt_free_result(stmt->mysql_prepstat);
+  //only bind again when a buffer or type has changed, values are read from the buffers on each execution
+  for (i = 0; i < stmt->numargs; i++) {
+    if (!stmt->params[i].bound)
+      break;
+  }
+  if (i < stmt->numargs) {
+    memset(stmt->mysql_bind_param, 0, sizeof(MYSQL_BIND) * stmt->numargs);
+    for (i = 0; i < stmt->numargs; i++) {
+      param = &stmt->params[i];
+      switch (param->type) {
+        case CDBA_TYPE_INT :
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_LONGLONG;
+          stmt->mysql_bind_param[i].buffer = &(param->value.intval);
+          break;
+        case CDBA_TYPE_FLOAT :
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_DOUBLE;
+          stmt->mysql_bind_param[i].buffer = &(param->value.floatval);
+          break;
+        case CDBA_TYPE_TEXT :
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_STRING;
+          stmt->mysql_bind_param[i].buffer = param->text;
+          stmt->mysql_bind_param[i].buffer_length = param->textsize;
+          stmt->mysql_bind_param[i].length = &(param->mysql_len);
+          break;
+        case CDBA_TYPE_BLOB :
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_BLOB;
+          stmt->mysql_bind_param[i].buffer = param->text;
+          stmt->mysql_bind_param[i].buffer_length = param->textsize;
+          stmt->mysql_bind_param[i].length = &(param->mysql_len);
+          break;
+        case CDBA_PARAM_TYPE_STREAM :
+          //the value is sent with mysql_stmt_send_long_data()
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_STRING;
+          break;
+        default :
+          stmt->mysql_bind_param[i].buffer_type = MYSQL_TYPE_NULL;
+          break;
+      }
+      param->bound = 1;
+    }
+    if (mysql_stmt_bind_param(stmt->mysql_prepstat, stmt->mysql_bind_param) != 0) {
+      cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+      for (i = 0; i < stmt->numargs; i++)
+        stmt->params[i].bound = 0;
+      return -1;
+    }
+  }
+  //send streamed values, this must be done again for every execution
+  for (i = 0; i < stmt->numargs; i++) {
+    if (stmt->params[i].type == CDBA_PARAM_TYPE_STREAM && cdba_prep_mysql_send_stream(stmt, i) != 0)
+      return -1;
+  }
+#elif defined(DB_FREETDS)
+  return -1;
+#elif defined(DB_SQLITE3)
+  int status;
+  //the statement must be reset before binding and executing again, bindings are kept
+  sqlite3_reset(stmt->sqlite3_prepstat);
+  for (i = 0; i < stmt->numargs; i++) {
+    param = &stmt->params[i];
+    if (param->bound && param->type != CDBA_PARAM_TYPE_STREAM)
+      continue;
+    switch (param->type) {
+      case CDBA_TYPE_INT :
+        status = sqlite3_bind_int64(stmt->sqlite3_prepstat, i + 1, param->value.intval);
+        break;
+      case CDBA_TYPE_FLOAT :
+        status = sqlite3_bind_double(stmt->sqlite3_prepstat, i + 1, param->value.floatval);
+        break;
+      case CDBA_TYPE_TEXT :
+        status = sqlite3_bind_text(stmt->sqlite3_prepstat, i + 1, param->text, param->len, SQLITE_STATIC);
+        break;
+      case CDBA_TYPE_BLOB :
+        status = sqlite3_bind_blob(stmt->sqlite3_prepstat, i + 1, param->text, param->len, SQLITE_STATIC);
+        break;
+      case CDBA_PARAM_TYPE_STREAM :
+        if (cdba_prep_sqlite3_read_stream(stmt, param) != 0)
+          return -1;
+        status = sqlite3_bind_text(stmt->sqlite3_prepstat, i + 1, param->text, param->len, SQLITE_STATIC);
+        break;
+      default :
+        status = sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+        break;
+    }
+    if (status != SQLITE_OK) {
+      cdba_prep_set_error(stmt, sqlite3_errmsg(sqlite3_db_handle(stmt->sqlite3_prepstat)));
+      return -1;
+    }
+    param->bound = 1;
+  }
+#elif defined(DB_ODBC)
+  SQLRETURN odbcstatus;
+  //close any open cursor from a previous execution
+  SQLFreeStmt(stmt->odbc_prepstat, SQL_CLOSE);
+  //deferred binding: values are read from the buffers on each execution, so only bind again when a buffer or type has changed
+  for (i = 0; i < stmt->numargs; i++) {
+    param = &stmt->params[i];
+    if (param->bound)
+      continue;
+    switch (param->type) {
+      case CDBA_TYPE_INT :
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, &(param->value.intval), sizeof(param->value.intval), NULL);
+        break;
+      case CDBA_TYPE_FLOAT :
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, &(param->value.floatval), sizeof(param->value.floatval), NULL);
+        break;
+      case CDBA_TYPE_TEXT :
+        param->odbc_colsize = (param->textsize > 1 ? param->textsize - 1 : 1);
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_LONGVARCHAR, param->odbc_colsize, 0, param->text, param->textsize, &(param->odbc_len));
+        break;
+      case CDBA_TYPE_BLOB :
+        param->odbc_colsize = (param->textsize > 1 ? param->textsize - 1 : 1);
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_BINARY, SQL_LONGVARBINARY, param->odbc_colsize, 0, param->text, param->textsize, &(param->odbc_len));
+        break;
+      case CDBA_PARAM_TYPE_STREAM :
+        //data at execution: the argument buffer is passed as token to identify the argument when SQLParamData() asks for its data
+        param->odbc_colsize = (param->streamlen != CDBA_NTS ? (param->streamlen > 0 ? param->streamlen : 1) : INT_MAX);
+        param->odbc_len = SQL_LEN_DATA_AT_EXEC(param->streamlen != CDBA_NTS ? (SQLLEN)param->streamlen : 0);
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_LONGVARCHAR, param->odbc_colsize, 0, (SQLPOINTER)param, 0, &(param->odbc_len));
+        break;
+      default :
+        param->odbc_len = SQL_NULL_DATA;
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR, 1, 0, NULL, 0, &(param->odbc_len));
+        break;
+    }
+    if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO) {
+      cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+      return -1;
+    }
+    param->bound = 1;
+  }
+#else
+  return -1;
+#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_bound (cdba_prep_handle stmt)
+{
+  if (cdba_prep_bind_arguments(stmt) != 0)
+    return -1;
+  return cdba_prep_run(stmt);
+}
+
+static db_int cdba_param_column_get_type (const cdba_param_column* param, size_t row)
+{
+  if (param->type == CDBA_TYPE_NULL || (param->nulls && param->nulls[row]))
+    return CDBA_TYPE_NULL;
+  if ((param->type == CDBA_TYPE_TEXT || param->type == CDBA_TYPE_BLOB) && !((const void* const*)param->values)[row])
+    return CDBA_TYPE_NULL;
+  return param->type;
+}
+
+#if defined(DB_MYSQL) || defined(DB_ODBC)
+static size_t cdba_param_column_get_text_length (const cdba_param_column* param, size_t row)
+{
+  return (param->lengths ? param->lengths[row] : strlen(((const char* const*)param->values)[row]));
+}
+#endif
+
+#if defined(DB_MYSQL)
+//forget the cached session settings changed by SET statements in SQL executed on the connection
+static void cdba_mysql_sql_executed (cdba_handle db, const char* sql, size_t sqllen)
+{
+  struct cdba_sql_token_struct token;
+  const char* end;
+  int first = 1;
+  int setstatement = 0;
+  if (db->mysql_autoinc_increment == 0 || !sql)
+    return;
+  end = sql + sqllen;
+  while (cdba_sql_next_token(&sql, end, &token)) {
+    if (CDBA_SQL_TOKEN_IS_SYMBOL(token, ';')) {
+      first = 1;
+    } else if (first) {
+      setstatement = cdba_sql_token_is(&token, "set");
+      first = 0;
+    } else if (setstatement && (token.type == CDBA_SQL_TOKEN_WORD || token.type == CDBA_SQL_TOKEN_IDENTIFIER) && cdba_sql_text_is(token.text, token.len, "auto_increment_increment")) {
+      db->mysql_autoinc_increment = 0;
+      return;
+    }
+  }
+}
+#endif
+
+#if defined(DB_MYSQL) && defined(MARIADB_CLIENT_STMT_BULK_OPERATIONS)
+//get the auto_increment_increment setting of the session, returns 0 if unknown
+//it is only queried once as it only changes with SET statements (see cdba_mysql_sql_executed()) or when reconnecting
+static unsigned long cdba_mysql_auto_increment_increment (cdba_handle db)
+{
+  MYSQL_RES* res;
+  MYSQL_ROW row;
+  unsigned long increment = 0;
+  if (db->mysql_autoinc_increment != 0 && db->mysql_autoinc_thread == mysql_thread_id(db->mysql_conn))
+    return db->mysql_autoinc_increment;
+  if (mysql_query(db->mysql_conn, "SELECT @@auto_increment_increment") != 0)
+    return 0;
+  if ((res = mysql_store_result(db->mysql_conn)) == NULL)
+    return 0;
+  if ((row = mysql_fetch_row(res)) != NULL && row[0])
+    increment = strtoul(row[0], NULL, 10);
+  mysql_free_result(res);
+  db->mysql_autoinc_increment = increment;
+  db->mysql_autoinc_thread = mysql_thread_id(db->mysql_conn);
+  return increment;
+}
+#endif
+
+static int cdba_prep_execute_batch_rows (cdba_prep_handle stmt, size_t rows, const cdba_param_column* params, int* rowstatus, db_int* rowsaffected, db_int* insertids)
+{
+  size_t row;
+  int i;
+  int failed = 0;
+  db_int affected = 0;
+  if (rowsaffected)
+    *rowsaffected = 0;
+  if (rows == 0)
+    return 0;
+  stmt->row_pending = 0;
+  cdba_param_buffers_invalidate(stmt->params, stmt->numargs);
+  if (stmt->numargs > 0 && !params) {
+    cdba_prep_set_error(stmt, "Missing arguments");
+    return -1;
+  }
+  for (i = 0; i < stmt->numargs; i++) {
+    if (params[i].type != CDBA_TYPE_NULL && params[i].type != CDBA_TYPE_INT && params[i].type != CDBA_TYPE_FLOAT && params[i].type != CDBA_TYPE_TEXT && params[i].type != CDBA_TYPE_BLOB) {
+      cdba_prep_set_error(stmt, "Unknown database type");
+      return -1;
+    }
+    //binary values can't be zero-terminated
+    if (params[i].type == CDBA_TYPE_BLOB && !params[i].lengths) {
+      cdba_prep_set_error(stmt, "Missing argument lengths");
+      return -1;
+    }
+  }
+#if defined(DB_MYSQL)
+  MYSQL_BIND* bindarg = NULL;
+  struct mysql_argbindinfo_struct* argcopy = NULL;
+  unsigned long* arglen = NULL;
+  int status;
+  if (stmt->numargs > 0) {
+    if ((bindarg = (MYSQL_BIND*)malloc(sizeof(MYSQL_BIND) * stmt->numargs)) == NULL || (argcopy = (struct mysql_argbindinfo_struct*)malloc(sizeof(struct mysql_argbindinfo_struct) * stmt->numargs)) == NULL || (arglen = (unsigned long*)malloc(sizeof(unsigned long) * stmt->numargs)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      free(bindarg);
+      free(argcopy);
+      return -1;
+    }
+  }
+#if defined(MARIADB_CLIENT_STMT_BULK_OPERATIONS)
+  //use MariaDB bulk execution (all rows in one round trip) if the server supports it
+  unsigned long capabilities = 0;
+  mariadb_get_infov(stmt->db->mysql_conn, MARIADB_CONNECTION_EXTENDED_SERVER_CAPABILITIES, &capabilities);
+  //bulk execution only reports the first generated ID, the IDs of the other rows can only be derived if they are consecutive
+  if (rows > 1 && stmt->numargs > 0 && (capabilities & (MARIADB_CLIENT_STMT_BULK_OPERATIONS >> 32)) != 0 && (!insertids || cdba_mysql_auto_increment_increment(stmt->db) == 1)) {
+    char* indicators;
+    unsigned long* lengths;
+    unsigned int arraysize = rows;
+    if ((indicators = (char*)malloc(stmt->numargs * rows)) == NULL || (lengths = (unsigned long*)malloc(sizeof(unsigned long) * stmt->numargs * rows)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      free(indicators);
+      free(bindarg);
+      free(argcopy);
+      free(arglen);
+      return -1;
+    }
+    memset(bindarg, 0, sizeof(MYSQL_BIND) * stmt->numargs);
+    for (i = 0; i < stmt->numargs; i++) {
+      bindarg[i].u.indicator = indicators + i * rows;
+      for (row = 0; row < rows; row++)
+        bindarg[i].u.indicator[row] = (cdba_param_column_get_type(&params[i], row) == CDBA_TYPE_NULL ? STMT_INDICATOR_NULL : STMT_INDICATOR_NONE);
+      switch (params[i].type) {
+        case CDBA_TYPE_INT :
+          bindarg[i].buffer_type = MYSQL_TYPE_LONGLONG;
+          bindarg[i].buffer = (void*)params[i].values;
+          break;
+        case CDBA_TYPE_FLOAT :
+          bindarg[i].buffer_type = MYSQL_TYPE_DOUBLE;
+          bindarg[i].buffer = (void*)params[i].values;
+          break;
+        case CDBA_TYPE_TEXT :
+        case CDBA_TYPE_BLOB :
+          bindarg[i].buffer_type = (params[i].type == CDBA_TYPE_BLOB ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING);
+          bindarg[i].buffer = (void*)params[i].values;
+          bindarg[i].length = lengths + i * rows;
+          for (row = 0; row < rows; row++)
+            bindarg[i].length[row] = (bindarg[i].u.indicator[row] == STMT_INDICATOR_NULL ? 0 : cdba_param_column_get_text_length(&params[i], row));
+          break;
+        default :
+          bindarg[i].buffer_type = MYSQL_TYPE_NULL;
+          break;
+      }
+    }
+    mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_ARRAY_SIZE, &arraysize);
+    mysql_stmt_bind_param(stmt->mysql_prepstat, bindarg);
+    status = mysql_stmt_execute(stmt->mysql_prepstat);
+    if (status != 0) {
+      cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+      failed = rows;
+    } else {
+      affected = mysql_stmt_affected_rows(stmt->mysql_prepstat);
+    }
+    for (row = 0; row < rows; row++) {
+      if (rowstatus)
+        rowstatus[row] = (status == 0 ? 0 : -1);
+      //the IDs of the other rows follow the first one as auto_increment_increment is 1
+      if (insertids)
+        insertids[row] = (status == 0 ? (db_int)mysql_stmt_insert_id(stmt->mysql_prepstat) + row : 0);
+    }
+    arraysize = 0;
+    mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_ARRAY_SIZE, &arraysize);
+    mysql_stmt_reset(stmt->mysql_prepstat);
+    free(indicators);
+    free(lengths);
+    free(bindarg);
+    free(argcopy);
+    free(arglen);
+    if (rowsaffected)
+      *rowsaffected = affected;
+    return failed;
+  }
+#endif
+  //execute row by row, the statement only needs to be sent once
+  for (row = 0; row < rows; row++) {
+    if (stmt->numargs > 0) {
+      memset(bindarg, 0, sizeof(MYSQL_BIND) * stmt->numargs);
+      for (i = 0; i < stmt->numargs; i++) {
+        switch (cdba_param_column_get_type(&params[i], row)) {
+          case CDBA_TYPE_INT :
+            argcopy[i].intval = (long long)((const db_int*)params[i].values)[row];
+            bindarg[i].buffer_type = MYSQL_TYPE_LONGLONG;
+            bindarg[i].buffer = &(argcopy[i].intval);
+            break;
+          case CDBA_TYPE_FLOAT :
+            argcopy[i].floatval = ((const db_flt*)params[i].values)[row];
+            bindarg[i].buffer_type = MYSQL_TYPE_DOUBLE;
+            bindarg[i].buffer = &(argcopy[i].floatval);
+            break;
+          case CDBA_TYPE_TEXT :
+          case CDBA_TYPE_BLOB :
+            arglen[i] = cdba_param_column_get_text_length(&params[i], row);
+            bindarg[i].buffer_type = (params[i].type == CDBA_TYPE_BLOB ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING);
+            bindarg[i].buffer = (void*)((const char* const*)params[i].values)[row];
+            bindarg[i].buffer_length = arglen[i];
+            bindarg[i].length = &arglen[i];
+            break;
+          default :
+            bindarg[i].buffer_type = MYSQL_TYPE_NULL;
+            break;
+        }
+      }
+      mysql_stmt_bind_param(stmt->mysql_prepstat, bindarg);
+    }
+    if ((status = mysql_stmt_execute(stmt->mysql_prepstat)) != 0) {
+      cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+      failed++;
+    } else {
+      affected += mysql_stmt_affected_rows(stmt->mysql_prepstat);
+    }
+    if (rowstatus)
+      rowstatus[row] = (status == 0 ? 0 : -1);
+    if (insertids)
+      insertids[row] = (status == 0 ? (db_int)mysql_stmt_insert_id(stmt->mysql_prepstat) : 0);
+  }
+  mysql_stmt_reset(stmt->mysql_prepstat);
+  free(bindarg);
+  free(argcopy);
+  free(arglen);
+#elif defined(DB_FREETDS)
+  cdba_prep_set_error(stmt, "Not supported");
+  return -1;
+#elif defined(DB_SQLITE3)
+  int status;
+  int autocommit;
+  sqlite3* conn = sqlite3_db_handle(stmt->sqlite3_prepstat);
+  //run all rows in a single transaction unless the caller already started one
+  if ((autocommit = sqlite3_get_autocommit(conn)) != 0) {
+    status = cdba_sqlite3_exec(stmt->db, "BEGIN");
+    if (status != SQLITE_OK) {
+      cdba_prep_set_error(stmt, sqlite3_errmsg(conn));
+      return -1;
+    }
+  }
+  sqlite3_reset(stmt->sqlite3_prepstat);
+  stmt->sqlite3_first_step_status = -1;
+  for (row = 0; row < rows; row++) {
+    for (i = 0; i < stmt->numargs; i++) {
+      switch (cdba_param_column_get_type(&params[i], row)) {
+        case CDBA_TYPE_INT :
+          sqlite3_bind_int64(stmt->sqlite3_prepstat, i + 1, ((const db_int*)params[i].values)[row]);
+          break;
+        case CDBA_TYPE_FLOAT :
+          sqlite3_bind_double(stmt->sqlite3_prepstat, i + 1, ((const db_flt*)params[i].values)[row]);
+          break;
+        case CDBA_TYPE_TEXT :
+          sqlite3_bind_text(stmt->sqlite3_prepstat, i + 1, ((const char* const*)params[i].values)[row], (params[i].lengths ? (int)params[i].lengths[row] : -1), SQLITE_STATIC);
+          break;
+        case CDBA_TYPE_BLOB :
+          sqlite3_bind_blob(stmt->sqlite3_prepstat, i + 1, ((const void* const*)params[i].values)[row], (int)params[i].lengths[row], SQLITE_STATIC);
+          break;
+        default :
+          sqlite3_bind_null(stmt->sqlite3_prepstat, i + 1);
+          break;
+      }
+    }
+    status = cdba_sqlite3_step(stmt->db, stmt->sqlite3_prepstat);
+    if (status == SQLITE_DONE || status == SQLITE_ROW) {
+      affected += sqlite3_changes(conn);
+      if (rowstatus)
+        rowstatus[row] = 0;
+      if (insertids)
+        insertids[row] = sqlite3_last_insert_rowid(conn);
+    } else {
+      cdba_prep_set_error(stmt, sqlite3_errmsg(conn));
+      failed++;
+      if (rowstatus)
+        rowstatus[row] = -1;
+      if (insertids)
+        insertids[row] = 0;
+    }
+    sqlite3_reset(stmt->sqlite3_prepstat);
+  }
+  sqlite3_clear_bindings(stmt->sqlite3_prepstat);
+  if (autocommit) {
+    status = cdba_sqlite3_exec(stmt->db, "COMMIT");
+    if (status != SQLITE_OK) {
+      cdba_prep_set_error(stmt, sqlite3_errmsg(conn));
+      sqlite3_exec(conn, "ROLLBACK", NULL, NULL, NULL);
+      //none of the rows were stored
+      for (row = 0; row < rows; row++) {
+        if (rowstatus)
+          rowstatus[row] = -1;
+        if (insertids)
+          insertids[row] = 0;
+      }
+      if (rowsaffected)
+        *rowsaffected = 0;
+      return -1;
+    }
+  }
+#elif defined(DB_ODBC)
+  SQLRETURN odbcstatus;
+  SQLUSMALLINT* paramstatus;
+  SQLULEN processed = 0;
+  SQLLEN* indicators;
+  char** textbuf;
+  size_t width;
+  size_t len;
+  if ((paramstatus = (SQLUSMALLINT*)malloc(sizeof(SQLUSMALLINT) * rows)) == NULL) {
+    cdba_prep_set_error(stmt, "Memory allocation error");
+    return -1;
+  }
+  indicators = NULL;
+  textbuf = NULL;
+  if (stmt->numargs > 0) {
+    if ((indicators = (SQLLEN*)malloc(sizeof(SQLLEN) * stmt->numargs * rows)) == NULL || (textbuf = (char**)malloc(sizeof(char*) * stmt->numargs)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      free(indicators);
+      free(paramstatus);
+      return -1;
+    }
+    memset(textbuf, 0, sizeof(char*) * stmt->numargs);
+  }
+  //bind arrays of values column-wise and execute all rows at once
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)(SQLULEN)rows, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAM_STATUS_PTR, paramstatus, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAMS_PROCESSED_PTR, &processed, 0);
+  odbcstatus = SQL_SUCCESS;
+  for (i = 0; i < stmt->numargs && (odbcstatus == SQL_SUCCESS || odbcstatus == SQL_SUCCESS_WITH_INFO); i++) {
+    SQLLEN* ind = indicators + i * rows;
+    for (row = 0; row < rows; row++)
+      ind[row] = (cdba_param_column_get_type(&params[i], row) == CDBA_TYPE_NULL ? SQL_NULL_DATA : 0);
+    switch (params[i].type) {
+      case CDBA_TYPE_INT :
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, (SQLPOINTER)params[i].values, sizeof(db_int), ind);
+        break;
+      case CDBA_TYPE_FLOAT :
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, (SQLPOINTER)params[i].values, sizeof(db_flt), ind);
+        break;
+      case CDBA_TYPE_TEXT :
+      case CDBA_TYPE_BLOB :
+        //column-wise binding of text and binary values requires fixed width elements
+        width = 1;
+        for (row = 0; row < rows; row++) {
+          if (ind[row] != SQL_NULL_DATA && (len = cdba_param_column_get_text_length(&params[i], row)) + 1 > width)
+            width = len + 1;
+        }
+        if ((textbuf[i] = (char*)malloc(width * rows)) == NULL) {
+          cdba_prep_set_error(stmt, "Memory allocation error");
+          odbcstatus = SQL_ERROR;
+          break;
+        }
+        for (row = 0; row < rows; row++) {
+          if (ind[row] != SQL_NULL_DATA) {
+            ind[row] = cdba_param_column_get_text_length(&params[i], row);
+            memcpy(textbuf[i] + row * width, ((const char* const*)params[i].values)[row], ind[row]);
+            textbuf[i][row * width + ind[row]] = 0;
+          }
+        }
+        if (params[i].type == CDBA_TYPE_BLOB)
+          odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_BINARY, SQL_LONGVARBINARY, width, 0, textbuf[i], width, ind);
+        else
+          odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_LONGVARCHAR, width, 0, textbuf[i], width, ind);
+        break;
+      default :
+        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR, 1, 0, NULL, 0, ind);
+        break;
+    }
+    if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO && ((params[i].type != CDBA_TYPE_TEXT && params[i].type != CDBA_TYPE_BLOB) || textbuf[i]))
+      cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+  }
+  if (odbcstatus == SQL_SUCCESS || odbcstatus == SQL_SUCCESS_WITH_INFO) {
+    for (row = 0; row < rows; row++)
+      paramstatus[row] = SQL_PARAM_UNUSED;
+    cdba_prep_odbc_rowset_end(stmt);
+    odbcstatus = SQLExecute(stmt->odbc_prepstat);
+    if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO)
+      cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+    for (row = 0; row < rows; row++) {
+      if (paramstatus[row] == SQL_PARAM_SUCCESS || paramstatus[row] == SQL_PARAM_SUCCESS_WITH_INFO || (paramstatus[row] == SQL_PARAM_DIAG_UNAVAILABLE && (odbcstatus == SQL_SUCCESS || odbcstatus == SQL_SUCCESS_WITH_INFO))) {
+        if (rowstatus)
+          rowstatus[row] = 0;
+      } else {
+        failed++;
+        if (rowstatus)
+          rowstatus[row] = -1;
+      }
+      if (insertids)
+        insertids[row] = 0;
+    }
+    if (odbcstatus == SQL_SUCCESS || odbcstatus == SQL_SUCCESS_WITH_INFO) {
+      SQLLEN rowcount = 0;
+      if (SQLRowCount(stmt->odbc_prepstat, &rowcount) == SQL_SUCCESS && rowcount > 0)
+        affected = rowcount;
+    }
+  }
+  //restore single row parameter binding
+  SQLFreeStmt(stmt->odbc_prepstat, SQL_CLOSE);
+  SQLFreeStmt(stmt->odbc_prepstat, SQL_RESET_PARAMS);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_PARAMS_PROCESSED_PTR, NULL, 0);
+  if (textbuf) {
+    for (i = 0; i < stmt->numargs; i++)
+      free(textbuf[i]);
+    free(textbuf);
+  }
+  free(indicators);
+  free(paramstatus);
+  if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO && failed == 0)
+    return -2;
+#else
+  return -1;
+#endif
+  if (rowsaffected)
+    *rowsaffected = affected;
+  return failed;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_batch (cdba_prep_handle stmt, size_t rows, const cdba_param_column* params, int* rowstatus, db_int* rowsaffected, db_int* insertids)
+{
+  int status;
+  db_int total = 0;
+  uint64_t start = CDBA_STATS_START(stmt->db);
+  uint64_t retries = stmt->db->busystats.retries;
+  status = cdba_prep_execute_batch_rows(stmt, rows, params, rowstatus, &total, insertids);
+  if (rowsaffected)
+    *rowsaffected = total;
+  cdba_stats_record_execute(stmt->db, &stmt->stats, start, rows, (status < 0 ? 1 : (uint64_t)status), (total > 0 ? (uint64_t)total : 0), stmt->db->busystats.retries - retries);
+  cdba_result_cache_statement_executed(stmt);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_rows_affected (cdba_prep_handle stmt)
+{
+#if defined(DB_MYSQL)
+  return mysql_stmt_affected_rows(stmt->mysql_prepstat);
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  return sqlite3_changes(sqlite3_db_handle(stmt->sqlite3_prepstat));
+#elif defined(DB_ODBC)
+  SQLLEN rows = 0;
+  SQLRowCount(stmt->odbc_prepstat, &rows);
+  return (db_int)rows;
+#else
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_set_fetch_mode (cdba_prep_handle stmt, int mode, unsigned long prefetchrows)
+{
+  if (mode != CDBA_FETCH_MODE_STREAM && mode != CDBA_FETCH_MODE_BUFFERED && mode != CDBA_FETCH_MODE_CURSOR) {
+    cdba_prep_set_error(stmt, "Invalid fetch mode");
+    return -1;
+  }
+#if defined(DB_MYSQL)
+  unsigned long cursortype = (mode == CDBA_FETCH_MODE_CURSOR ? CURSOR_TYPE_READ_ONLY : CURSOR_TYPE_NO_CURSOR);
+  unsigned long prefetch = (mode == CDBA_FETCH_MODE_CURSOR && prefetchrows > 0 ? prefetchrows : 1);
+  //the cursor type is used by the server on the next execution
+  if (mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_CURSOR_TYPE, &cursortype) != 0 || mysql_stmt_attr_set(stmt->mysql_prepstat, STMT_ATTR_PREFETCH_ROWS, &prefetch) != 0) {
+    cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+    return -1;
+  }
+  stmt->mysql_fetch_mode = mode;
+#else
+  (void)prefetchrows;
+#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_row_count (cdba_prep_handle stmt)
+{
+#if defined(DB_MYSQL)
+  if (stmt->mysql_fetch_mode == CDBA_FETCH_MODE_BUFFERED && stmt->numcols > 0)
+    return mysql_stmt_num_rows(stmt->mysql_prepstat);
+#else
+  (void)stmt;
+#endif
+  return -1;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_insert_id (cdba_prep_handle stmt)
+{
+#if defined(DB_MYSQL)
+  return mysql_stmt_insert_id(stmt->mysql_prepstat);
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  return sqlite3_last_insert_rowid(sqlite3_db_handle(stmt->sqlite3_prepstat));
+#elif defined(DB_ODBC)
+  return 0;
+#else
+#endif
+}
+
+static int cdba_prep_fetch_next (cdba_prep_handle stmt)
+{
+#if defined(DB_MYSQL)
+  int status;
+  //return row left over by cdba_prep_fetch_batch()
+  if (stmt->row_pending) {
+    stmt->row_pending = 0;
+    return 1;
+  }
+	status = mysql_stmt_fetch(stmt->mysql_prepstat);
+  return cdba_prep_mysql_fetched(status);
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  int status;
+  if (stmt->sqlite3_first_step_status != -1) {
+    status = stmt->sqlite3_first_step_status;
+    stmt->sqlite3_first_step_status = -1;
+  } else {
+    status = cdba_sqlite3_step(stmt->db, stmt->sqlite3_prepstat);
+  }
+  if (status == SQLITE_ROW)
+    return 1;
+  //remember the end was reached so fetching again doesn't restart the statement
+  if (status == SQLITE_DONE)
+    stmt->sqlite3_first_step_status = SQLITE_DONE;
+  return (status == SQLITE_DONE || status == SQLITE_OK ? 0 : -1);
+#elif defined(DB_ODBC)
+  SQLRETURN status;
+  status = cdba_prep_odbc_next_row(stmt);
+  return (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO ? 1 : 0);
+#else
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row (cdba_prep_handle stmt)
+{
+  int status;
+  uint64_t start = CDBA_STATS_START(stmt->db);
+  uint64_t retries = stmt->db->busystats.retries;
+  cdba_arena_recycle(stmt->arena);
+  status = cdba_prep_fetch_next(stmt);
+  cdba_stats_record_fetch(stmt->db, &stmt->stats, start, (status > 0 ? 1 : 0), (status < 0), stmt->db->busystats.retries - retries);
+  return status;
+}
+
+//set or clear NULL flag of a row in a result column
+static void cdba_result_column_set_null (cdba_result_column* column, size_t row, int isnull)
+{
+  if (column->nulls) {
+    if (isnull)
+      column->nulls[row / 8] |= (uint8_t)(1 << (row % 8));
+    else
+      column->nulls[row / 8] &= (uint8_t)~(1 << (row % 8));
+  }
+}
+
+#if defined(DB_ODBC)
+//maximum column display size for which text columns can be fetched as part of a rowset
+#define ODBC_ROWSET_MAX_TEXT 1024
+
+//fetch one rowset into the result columns, returns number of rows fetched, 0 when there are no more rows, negative on error
+static int cdba_prep_odbc_fetch_rowset (cdba_prep_handle stmt, size_t maxrows, cdba_result_column* columns, size_t* textwidth)
+{
+  SQLRETURN status;
+  SQLULEN fetched = 0;
+  SQLLEN ind;
+  size_t row;
+  size_t len;
+  int i;
+  int result = 0;
+  //make sure the indicators and text buffers are large enough
+  if (stmt->odbc_batch_indcount < maxrows * stmt->numcols) {
+    free(stmt->odbc_batch_ind);
+    stmt->odbc_batch_indcount = 0;
+    if ((stmt->odbc_batch_ind = (SQLLEN*)malloc(sizeof(SQLLEN) * maxrows * stmt->numcols)) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return -1;
+    }
+    stmt->odbc_batch_indcount = maxrows * stmt->numcols;
+  }
+  for (i = 0; i < stmt->numcols; i++) {
+    if ((columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB) && cdba_column_buffer_reserve(&stmt->colbuf[i], maxrows * textwidth[i]) != 0) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return -1;
+    }
+  }
+  //bind the columns (numbers directly into the caller's arrays) and fetch a rowset
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)maxrows, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROWS_FETCHED_PTR, &fetched, 0);
+  status = SQL_SUCCESS;
+  for (i = 0; i < stmt->numcols && (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO); i++) {
+    switch (columns[i].type) {
+      case CDBA_TYPE_INT :
+        status = SQLBindCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), SQL_C_SBIGINT, columns[i].values, sizeof(db_int), stmt->odbc_batch_ind + i * maxrows);
+        break;
+      case CDBA_TYPE_FLOAT :
+        status = SQLBindCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), SQL_C_DOUBLE, columns[i].values, sizeof(db_flt), stmt->odbc_batch_ind + i * maxrows);
+        break;
+      case CDBA_TYPE_TEXT :
+        status = SQLBindCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), SQL_C_CHAR, stmt->colbuf[i].data, textwidth[i], stmt->odbc_batch_ind + i * maxrows);
+        break;
+      case CDBA_TYPE_BLOB :
+        status = SQLBindCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), SQL_C_BINARY, stmt->colbuf[i].data, textwidth[i], stmt->odbc_batch_ind + i * maxrows);
+        break;
+    }
+  }
+  stmt->odbc_row++;
+  if (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO)
+    status = SQLFetch(stmt->odbc_prepstat);
+  if (status == SQL_NO_DATA) {
+    result = 0;
+  } else if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+    cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+    cdba_prep_set_error(stmt, cdba_get_error(stmt->db));
+    result = -1;
+  } else {
+    //a row with a truncated value and the rows after it stay in the rowset and are read one by one with SQLGetData()
+    for (row = 0; row < fetched; row++) {
+      for (i = 0; i < stmt->numcols; i++) {
+        ind = stmt->odbc_batch_ind[i * maxrows + row];
+        //text values need room for the terminating zero
+        if ((columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB) && (ind == SQL_NO_TOTAL || (ind != SQL_NULL_DATA && (size_t)ind > textwidth[i] - (columns[i].type == CDBA_TYPE_TEXT ? 1 : 0))))
+          break;
+      }
+      if (i < stmt->numcols)
+        break;
+    }
+    if (row < fetched) {
+      stmt->odbc_rowset_rows = fetched;
+      stmt->odbc_rowset_next = row + 1;
+    }
+    result = (int)row;
+    //fill in NULL values and move text values into the caller's buffer
+    for (i = 0; i < stmt->numcols; i++) {
+      for (row = 0; row < (size_t)result; row++) {
+        ind = stmt->odbc_batch_ind[i * maxrows + row];
+        switch (columns[i].type) {
+          case CDBA_TYPE_INT :
+            if (ind == SQL_NULL_DATA)
+              ((db_int*)columns[i].values)[row] = 0;
+            break;
+          case CDBA_TYPE_FLOAT :
+            if (ind == SQL_NULL_DATA)
+              ((db_flt*)columns[i].values)[row] = 0;
+            break;
+          case CDBA_TYPE_TEXT :
+          case CDBA_TYPE_BLOB :
+            len = 0;
+            if (ind != SQL_NULL_DATA) {
+              len = ind;
+              memcpy((char*)columns[i].values + columns[i].offsets[row], stmt->colbuf[i].data + row * textwidth[i], len);
+            }
+            columns[i].offsets[row + 1] = columns[i].offsets[row] + len;
+            break;
+          default :
+            continue;
+        }
+        cdba_result_column_set_null(&columns[i], row, (ind == SQL_NULL_DATA));
+      }
+    }
+  }
+  //go back to fetching one row at a time, the rowset size is kept until the remaining rows of the rowset were read
+  SQLFreeStmt(stmt->odbc_prepstat, SQL_UNBIND);
+  if (!stmt->odbc_rowset_rows)
+    SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+  SQLSetStmtAttr(stmt->odbc_prepstat, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+  stmt->odbc_row++;
+  return result;
+}
+#endif
+
+static int cdba_prep_fetch_rows (cdba_prep_handle stmt, size_t maxrows, cdba_result_column* columns)
+{
+  size_t n = 0;
+  int i;
+  int fits;
+  int pending = 0;
+  if (maxrows == 0)
+    return 0;
+  if (maxrows > (size_t)INT_MAX)
+    maxrows = INT_MAX;
+  for (i = 0; i < stmt->numcols; i++) {
+    if (columns[i].type != CDBA_TYPE_NULL && columns[i].type != CDBA_TYPE_INT && columns[i].type != CDBA_TYPE_FLOAT && columns[i].type != CDBA_TYPE_TEXT && columns[i].type != CDBA_TYPE_BLOB) {
+      cdba_prep_set_error(stmt, "Unknown database type");
+      return -1;
+    }
+    if (columns[i].type != CDBA_TYPE_NULL && (!columns[i].values || ((columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB) && !columns[i].offsets))) {
+      cdba_prep_set_error(stmt, "Missing result buffer");
+      return -1;
+    }
+    if (columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB)
+      columns[i].offsets[0] = 0;
+  }
+#if defined(DB_MYSQL)
+  int status;
+  int isnull;
+  MYSQL_BIND bindarg;
+  unsigned long length;
+  size_t avail;
+  while (n < maxrows) {
+    if (stmt->row_pending) {
+      stmt->row_pending = 0;
+    } else {
+      status = mysql_stmt_fetch(stmt->mysql_prepstat);
+      if (status == MYSQL_NO_DATA)
+        break;
+      if (status != 0 && status != MYSQL_DATA_TRUNCATED) {
+        cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+        return -1;
+      }
+    }
+    //fetch text and binary values straight into the caller's buffer, the row only counts when all of them fit
+    fits = 1;
+    for (i = 0; i < stmt->numcols && fits; i++) {
+      if (columns[i].type != CDBA_TYPE_TEXT && columns[i].type != CDBA_TYPE_BLOB)
+        continue;
+      columns[i].offsets[n + 1] = columns[i].offsets[n];
+      if (stmt->mysql_bind_vars[i].is_null)
+        continue;
+      avail = columns[i].textsize - columns[i].offsets[n];
+      if ((stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_STRING || stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_BLOB) && stmt->mysql_bind_vars[i].length > avail) {
+        fits = 0;
+        break;
+      }
+      memset(&bindarg, 0, sizeof(bindarg));
+      bindarg.buffer_type = (columns[i].type == CDBA_TYPE_BLOB ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING);
+      bindarg.buffer = (char*)columns[i].values + columns[i].offsets[n];
+      bindarg.buffer_length = avail;
+      bindarg.length = &length;
+      if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &bindarg, i, 0) != 0) {
+        cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+        return -1;
+      }
+      if (length > avail) {
+        fits = 0;
+        break;
+      }
+      columns[i].offsets[n + 1] = columns[i].offsets[n] + length;
+    }
+    if (!fits) {
+      //keep the row for the next call
+      stmt->row_pending = 1;
+      pending = 1;
+      break;
+    }
+    //numbers are taken from the result bindings when they have the right type
+    for (i = 0; i < stmt->numcols; i++) {
+      isnull = stmt->mysql_bind_vars[i].is_null;
+      switch (columns[i].type) {
+        case CDBA_TYPE_INT :
+          if (isnull)
+            ((db_int*)columns[i].values)[n] = 0;
+          else if (stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_LONGLONG)
+            ((db_int*)columns[i].values)[n] = stmt->mysql_bind_vars[i].value.intval;
+          else if (stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_DOUBLE)
+            ((db_int*)columns[i].values)[n] = (db_int)stmt->mysql_bind_vars[i].value.floatval;
+          else
+            ((db_int*)columns[i].values)[n] = cdba_prep_get_column_int(stmt, i);
+          break;
+        case CDBA_TYPE_FLOAT :
+          if (isnull)
+            ((db_flt*)columns[i].values)[n] = 0;
+          else if (stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_DOUBLE)
+            ((db_flt*)columns[i].values)[n] = stmt->mysql_bind_vars[i].value.floatval;
+          else if (stmt->mysql_bind_result[i].buffer_type == MYSQL_TYPE_LONGLONG)
+            ((db_flt*)columns[i].values)[n] = (db_flt)stmt->mysql_bind_vars[i].value.intval;
+          else
+            ((db_flt*)columns[i].values)[n] = cdba_prep_get_column_float(stmt, i);
+          break;
+        case CDBA_TYPE_TEXT :
+        case CDBA_TYPE_BLOB :
+          break;
+        default :
+          continue;
+      }
+      cdba_result_column_set_null(&columns[i], n, isnull);
+    }
+    n++;
+  }
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  int status;
+  int isnull;
+  const char* text;
+  size_t len;
+  while (n < maxrows) {
+    if (stmt->sqlite3_first_step_status != -1) {
+      status = stmt->sqlite3_first_step_status;
+      stmt->sqlite3_first_step_status = -1;
+    } else {
+      status = cdba_sqlite3_step(stmt->db, stmt->sqlite3_prepstat);
+    }
+    if (status != SQLITE_ROW) {
+      //remember the end was reached so the next call doesn't restart the statement
+      if (status == SQLITE_DONE || status == SQLITE_OK) {
+        stmt->sqlite3_first_step_status = status;
+        break;
+      }
+      cdba_prep_set_error(stmt, sqlite3_errmsg(sqlite3_db_handle(stmt->sqlite3_prepstat)));
+      return -1;
+    }
+    //check if all text and binary values fit before storing anything
+    fits = 1;
+    for (i = 0; i < stmt->numcols && fits; i++) {
+      if (columns[i].type == CDBA_TYPE_TEXT && sqlite3_column_text(stmt->sqlite3_prepstat, i) != NULL && (size_t)sqlite3_column_bytes(stmt->sqlite3_prepstat, i) > columns[i].textsize - columns[i].offsets[n])
+        fits = 0;
+      else if (columns[i].type == CDBA_TYPE_BLOB && sqlite3_column_blob(stmt->sqlite3_prepstat, i) != NULL && (size_t)sqlite3_column_bytes(stmt->sqlite3_prepstat, i) > columns[i].textsize - columns[i].offsets[n])
+        fits = 0;
+    }
+    if (!fits) {
+      //keep the row for the next call
+      stmt->sqlite3_first_step_status = SQLITE_ROW;
+      pending = 1;
+      break;
+    }
+    for (i = 0; i < stmt->numcols; i++) {
+      switch (columns[i].type) {
+        case CDBA_TYPE_INT :
+          isnull = (sqlite3_column_type(stmt->sqlite3_prepstat, i) == SQLITE_NULL);
+          ((db_int*)columns[i].values)[n] = sqlite3_column_int64(stmt->sqlite3_prepstat, i);
+          break;
+        case CDBA_TYPE_FLOAT :
+          isnull = (sqlite3_column_type(stmt->sqlite3_prepstat, i) == SQLITE_NULL);
+          ((db_flt*)columns[i].values)[n] = sqlite3_column_double(stmt->sqlite3_prepstat, i);
+          break;
+        case CDBA_TYPE_TEXT :
+          len = 0;
+          if ((text = (const char*)sqlite3_column_text(stmt->sqlite3_prepstat, i)) != NULL) {
+            len = sqlite3_column_bytes(stmt->sqlite3_prepstat, i);
+            memcpy((char*)columns[i].values + columns[i].offsets[n], text, len);
+          }
+          columns[i].offsets[n + 1] = columns[i].offsets[n] + len;
+          isnull = (text == NULL);
+          break;
+        case CDBA_TYPE_BLOB :
+          len = 0;
+          //empty blobs are returned as NULL pointer
+          if ((text = (const char*)sqlite3_column_blob(stmt->sqlite3_prepstat, i)) != NULL) {
+            len = sqlite3_column_bytes(stmt->sqlite3_prepstat, i);
+            memcpy((char*)columns[i].values + columns[i].offsets[n], text, len);
+          }
+          columns[i].offsets[n + 1] = columns[i].offsets[n] + len;
+          isnull = (sqlite3_column_type(stmt->sqlite3_prepstat, i) == SQLITE_NULL);
+          break;
+        default :
+          continue;
+      }
+      cdba_result_column_set_null(&columns[i], n, isnull);
+    }
+    n++;
+  }
+#elif defined(DB_ODBC)
+  SQLRETURN status;
+  SQLLEN displaysize;
+  size_t* textwidth;
+  size_t rowsetsize;
+  const char* text;
+  size_t len;
+  //fetch a rowset when all text columns have a limited size, limiting the number of rows so the longest possible values fit
+  if (!stmt->row_pending && !stmt->odbc_rowset_rows) {
+    if ((textwidth = (size_t*)malloc(sizeof(size_t) * (stmt->numcols > 0 ? stmt->numcols : 1))) == NULL) {
+      cdba_prep_set_error(stmt, "Memory allocation error");
+      return -1;
+    }
+    rowsetsize = maxrows;
+    for (i = 0; i < stmt->numcols && rowsetsize > 0; i++) {
+      textwidth[i] = 0;
+      if (columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB) {
+        displaysize = 0;
+        status = SQLColAttribute(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), SQL_DESC_DISPLAY_SIZE, NULL, 0, NULL, &displaysize);
+        if ((status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) || displaysize <= 0 || displaysize > ODBC_ROWSET_MAX_TEXT) {
+          rowsetsize = 0;
+        } else {
+          //allow for multibyte characters, binary values don't have a terminating zero
+          textwidth[i] = displaysize * 4 + 1;
+          len = (columns[i].type == CDBA_TYPE_BLOB ? textwidth[i] : textwidth[i] - 1);
+          if (rowsetsize > columns[i].textsize / len)
+            rowsetsize = columns[i].textsize / len;
+        }
+      }
+    }
+    if (rowsetsize > 0) {
+      i = cdba_prep_odbc_fetch_rowset(stmt, rowsetsize, columns, textwidth);
+      free(textwidth);
+      //when the first row already has a truncated value it is read below
+      if (i != 0 || !stmt->odbc_rowset_rows)
+        return i;
+    } else {
+      free(textwidth);
+    }
+  }
+  //otherwise fetch row by row, values are kept in the column buffers until the next row is fetched
+  while (n < maxrows) {
+    if (stmt->row_pending) {
+      stmt->row_pending = 0;
+    } else {
+      status = cdba_prep_odbc_next_row(stmt);
+      if (status == SQL_NO_DATA)
+        break;
+      if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+        cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+        cdba_prep_set_error(stmt, cdba_get_error(stmt->db));
+        return -1;
+      }
+    }
+    fits = 1;
+    for (i = 0; i < stmt->numcols && fits; i++) {
+      if (columns[i].type != CDBA_TYPE_NULL && (text = cdba_prep_get_column_text_ref(stmt, i, &len)) != NULL && (columns[i].type == CDBA_TYPE_TEXT || columns[i].type == CDBA_TYPE_BLOB) && len > columns[i].textsize - columns[i].offsets[n])
+        fits = 0;
+    }
+    if (!fits) {
+      //keep the row for the next call
+      stmt->row_pending = 1;
+      pending = 1;
+      break;
+    }
+    for (i = 0; i < stmt->numcols; i++) {
+      if (columns[i].type == CDBA_TYPE_NULL)
+        continue;
+      len = 0;
+      text = cdba_prep_get_column_text_ref(stmt, i, &len);
+      switch (columns[i].type) {
+        case CDBA_TYPE_INT :
+          ((db_int*)columns[i].values)[n] = (text ? strtoll(text, NULL, 10) : 0);
+          break;
+        case CDBA_TYPE_FLOAT :
+          ((db_flt*)columns[i].values)[n] = (text ? strtod(text, NULL) : 0);
+          break;
+        case CDBA_TYPE_TEXT :
+        case CDBA_TYPE_BLOB :
+          if (text)
+            memcpy((char*)columns[i].values + columns[i].offsets[n], text, len);
+          columns[i].offsets[n + 1] = columns[i].offsets[n] + (text ? len : 0);
+          break;
+      }
+      cdba_result_column_set_null(&columns[i], n, (text == NULL));
+    }
+    n++;
+  }
+#else
+#endif
+  if (n == 0 && pending) {
+    cdba_prep_set_error(stmt, "Result buffer too small");
+    return -1;
+  }
+  return (int)n;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_batch (cdba_prep_handle stmt, size_t maxrows, cdba_result_column* columns)
+{
+  int status;
+  uint64_t start = CDBA_STATS_START(stmt->db);
+  uint64_t retries = stmt->db->busystats.retries;
+  status = cdba_prep_fetch_rows(stmt, maxrows, columns);
+  cdba_stats_record_fetch(stmt->db, &stmt->stats, start, (status > 0 ? (uint64_t)status : 0), (status < 0), stmt->db->busystats.retries - retries);
+  return status;
+}
+
+#if defined(DB_MYSQL)
+//get type of MySQL result field
+static db_int cdba_mysql_column_type (const MYSQL_FIELD* field)
+{
+  switch (field->type) {
+    case MYSQL_TYPE_NULL :
+      return CDBA_TYPE_NULL;
+    case MYSQL_TYPE_BIT :
+#ifdef MYSQL_TYPE_BOOL
+    case MYSQL_TYPE_BOOL :
+#endif
+    case MYSQL_TYPE_DECIMAL :
+    case MYSQL_TYPE_NEWDECIMAL :
+    case MYSQL_TYPE_TINY :
+    case MYSQL_TYPE_SHORT :
+    case MYSQL_TYPE_INT24 :
+    case MYSQL_TYPE_LONG :
+    case MYSQL_TYPE_LONGLONG :
+    case MYSQL_TYPE_TIMESTAMP :
+    case MYSQL_TYPE_TIMESTAMP2 :
+    case MYSQL_TYPE_DATE :
+    case MYSQL_TYPE_TIME :
+    case MYSQL_TYPE_DATETIME :
+    case MYSQL_TYPE_YEAR :
+      return CDBA_TYPE_INT;
+    case MYSQL_TYPE_FLOAT :
+    case MYSQL_TYPE_DOUBLE :
+      return CDBA_TYPE_FLOAT;
+    case MYSQL_TYPE_VARCHAR :
+    case MYSQL_TYPE_VAR_STRING :
+    case MYSQL_TYPE_STRING :
+    case MYSQL_TYPE_TINY_BLOB :
+    case MYSQL_TYPE_MEDIUM_BLOB :
+    case MYSQL_TYPE_LONG_BLOB :
+    case MYSQL_TYPE_BLOB :
+      //binary strings use the binary character set
+      if (field->charsetnr == MYSQL_BINARY_CHARSETNR)
+        return CDBA_TYPE_BLOB;
+      return CDBA_TYPE_TEXT;
+    default :
+      return CDBA_TYPE_NULL;
+  }
+}
+#elif defined(DB_SQLITE3)
+//get type of SQLite3 column from its declared type using the type affinity rules
+static db_int cdba_sqlite3_declared_type (const char* decltype, int* nativetype)
+{
+  char name[64];
+  size_t i;
+  //expressions don't have a declared type
+  if (!decltype) {
+    *nativetype = SQLITE_NULL;
+    return CDBA_TYPE_NULL;
+  }
+  for (i = 0; decltype[i] && i < sizeof(name) - 1; i++)
+    name[i] = toupper((unsigned char)decltype[i]);
+  name[i] = 0;
+  if (strstr(name, "INT")) {
+    *nativetype = SQLITE_INTEGER;
+    return CDBA_TYPE_INT;
+  }
+  if (strstr(name, "CHAR") || strstr(name, "CLOB") || strstr(name, "TEXT")) {
+    *nativetype = SQLITE_TEXT;
+    return CDBA_TYPE_TEXT;
+  }
+  if (!*name || strstr(name, "BLOB")) {
+    *nativetype = SQLITE_BLOB;
+    return CDBA_TYPE_BLOB;
+  }
+  if (strstr(name, "REAL") || strstr(name, "FLOA") || strstr(name, "DOUB")) {
+    *nativetype = SQLITE_FLOAT;
+    return CDBA_TYPE_FLOAT;
+  }
+  //NUMERIC affinity (e.g. NUMERIC, DECIMAL, BOOLEAN, DATE) stores integers, floats or text depending on the value
+  *nativetype = SQLITE_NULL;
+  return CDBA_TYPE_NULL;
+}
+
+//get type of the value in the current row of a SQLite3 column
+static db_int cdba_sqlite3_value_type (sqlite3_stmt* stmt, int col)
+{
+  switch (sqlite3_column_type(stmt, col)) {
+    case SQLITE_INTEGER :
+      return CDBA_TYPE_INT;
+    case SQLITE_FLOAT :
+      return CDBA_TYPE_FLOAT;
+    case SQLITE_TEXT :
+      return CDBA_TYPE_TEXT;
+    case SQLITE_BLOB :
+      return CDBA_TYPE_BLOB;
+    default :
+      return CDBA_TYPE_NULL;
+  }
+}
+#elif defined(DB_ODBC)
+//get type of ODBC SQL data type
+static db_int cdba_odbc_column_type (SQLSMALLINT type)
+{
+  switch (type) {
+    case SQL_DECIMAL :
+    case SQL_SMALLINT :
+    case SQL_INTEGER :
+    case SQL_BIT :
+    case SQL_TINYINT :
+    case SQL_BIGINT :
+      return CDBA_TYPE_INT;
+    case SQL_NUMERIC :
+    case SQL_REAL :
+    case SQL_FLOAT :
+    case SQL_DOUBLE :
+      return CDBA_TYPE_FLOAT;
+    case SQL_CHAR :
+    case SQL_VARCHAR :
+    case SQL_LONGVARCHAR :
+      return CDBA_TYPE_TEXT;
+    case SQL_BINARY :
+    case SQL_VARBINARY :
+    case SQL_LONGVARBINARY :
+      return CDBA_TYPE_BLOB;
+/*
+    case SQL_TYPE_TIME :
+    case SQL_TYPE_TIMESTAMP :
+    case SQL_TYPE_UTCDATETIME :
+    case SQL_TYPE_UTCTIME :
+*/
+/*
+    case SQL_WCHAR :
+    case SQL_WVARCHAR :
+    case SQL_WLONGVARCHAR :
+*/
+    default :
+      return CDBA_TYPE_NULL;
+  }
+}
+#endif
+
+//build column descriptors and hash table for looking up columns by name, done once for each result shape
+static int cdba_prep_describe_columns (cdba_prep_handle stmt)
+{
+  cdba_column_info* column;
+  size_t namessize;
+  char* name;
+  uint32_t hash;
+  size_t len;
+  unsigned int tablesize;
+  unsigned int slot;
+  int i;
+  cdba_prep_free_columns(stmt);
+  if (stmt->numcols <= 0)
+    return 0;
+  if ((stmt->columns = (cdba_column_info*)malloc(sizeof(cdba_column_info) * stmt->numcols)) == NULL) {
+    cdba_prep_set_error(stmt, "Memory allocation error");
+    return -1;
+  }
+  memset(stmt->columns, 0, sizeof(cdba_column_info) * stmt->numcols);
+  //get the column types and the length of the column names
+  namessize = 0;
+  for (i = 0; i < stmt->numcols; i++) {
+    column = &stmt->columns[i];
+    column->nullable = -1;
+#if defined(DB_MYSQL)
+    const MYSQL_FIELD* field = &stmt->mysql_result_metadata->fields[i];
+    column->name = (field->name ? field->name : "");
+    column->namelen = (field->name ? field->name_length : 0);
+    column->type = cdba_mysql_column_type(field);
+    column->nativetype = field->type;
+    column->size = field->length;
+    column->nullable = (field->flags & NOT_NULL_FLAG ? 0 : 1);
+#elif defined(DB_FREETDS)
+    column->name = "";
+#elif defined(DB_SQLITE3)
+    if ((column->name = sqlite3_column_name(stmt->sqlite3_prepstat, i)) == NULL)
+      column->name = "";
+    column->namelen = strlen(column->name);
+    column->type = cdba_sqlite3_declared_type(sqlite3_column_decltype(stmt->sqlite3_prepstat, i), &column->nativetype);
+#elif defined(DB_ODBC)
+    SQLRETURN status;
+    SQLSMALLINT namelen = 0;
+    SQLSMALLINT type = 0;
+    SQLULEN size = 0;
+    SQLSMALLINT decimals;
+    SQLSMALLINT nullable = SQL_NULLABLE_UNKNOWN;
+    status = SQLDescribeCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), NULL, 0, &namelen, &type, &size, &decimals, &nullable);
+    if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+      cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+      cdba_prep_set_error(stmt, cdba_get_error(stmt->db));
+      cdba_prep_free_columns(stmt);
+      return -1;
+    }
+    column->namelen = namelen;
+    column->type = cdba_odbc_column_type(type);
+    column->nativetype = type;
+    column->size = size;
+    column->nullable = (nullable == SQL_NULLABLE ? 1 : (nullable == SQL_NO_NULLS ? 0 : -1));
+#else
+    column->name = "";
+#endif
+    namessize += column->namelen + 1;
+  }
+  //keep a copy of all names in a single block
+  if ((stmt->columnnames = (char*)malloc(namessize)) == NULL) {
+    cdba_prep_set_error(stmt, "Memory allocation error");
+    cdba_prep_free_columns(stmt);
+    return -1;
+  }
+  name = stmt->columnnames;
+  for (i = 0; i < stmt->numcols; i++) {
+    column = &stmt->columns[i];
+#if defined(DB_ODBC)
+    SQLRETURN status;
+    SQLSMALLINT namelen;
+    status = SQLDescribeCol(stmt->odbc_prepstat, (SQLUSMALLINT)(i + 1), (SQLCHAR*)name, (SQLSMALLINT)(column->namelen + 1), &namelen, NULL, NULL, NULL, NULL);
+    if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO)
+      *name = 0;
+    name[column->namelen] = 0;
+    column->namelen = strlen(name);
+#else
+    memcpy(name, column->name, column->namelen);
+    name[column->namelen] = 0;
+#endif
+    column->name = name;
+    name += column->namelen + 1;
+  }
+  //hash table with at most half of the slots used, when names occur more than once the first column is found
+  tablesize = 4;
+  while (tablesize < (unsigned int)stmt->numcols * 2)
+    tablesize *= 2;
+  if ((stmt->columnindex = (int*)malloc(sizeof(int) * tablesize)) == NULL) {
+    cdba_prep_set_error(stmt, "Memory allocation error");
+    cdba_prep_free_columns(stmt);
+    return -1;
+  }
+  memset(stmt->columnindex, 0xFF, sizeof(int) * tablesize);
+  stmt->columnindexmask = tablesize - 1;
+  for (i = 0; i < stmt->numcols; i++) {
+    column = &stmt->columns[i];
+    hash = cdba_statement_cache_hash(column->name, &len);
+    slot = hash & stmt->columnindexmask;
+    while (stmt->columnindex[slot] >= 0 && strcmp(stmt->columns[stmt->columnindex[slot]].name, column->name) != 0)
+      slot = (slot + 1) & stmt->columnindexmask;
+    if (stmt->columnindex[slot] < 0)
+      stmt->columnindex[slot] = i;
+  }
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_get_column_count (cdba_prep_handle stmt)
+{
+  return stmt->numcols;
+}
+
+DLL_EXPORT_CDBALIB const cdba_column_info* cdba_prep_get_column_info (cdba_prep_handle stmt, int col)
+{
+  if (col < 0 || col >= stmt->numcols)
+    return NULL;
+  if (!stmt->columns && cdba_prep_describe_columns(stmt) != 0)
+    return NULL;
+#if defined(DB_SQLITE3)
+  //columns with NUMERIC affinity have no fixed type, use the type of the value in the current row
+  if (stmt->columns[col].nativetype == SQLITE_NULL && sqlite3_column_decltype(stmt->sqlite3_prepstat, col) != NULL)
+    stmt->columns[col].type = cdba_sqlite3_value_type(stmt->sqlite3_prepstat, col);
+#endif
+  return &stmt->columns[col];
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_get_column_index (cdba_prep_handle stmt, const char* name)
+{
+  const cdba_column_info* column;
+  uint32_t hash;
+  size_t len;
+  unsigned int slot;
+  if (!name || stmt->numcols <= 0)
+    return -1;
+  if (!stmt->columns && cdba_prep_describe_columns(stmt) != 0)
+    return -1;
+  hash = cdba_statement_cache_hash(name, &len);
+  slot = hash & stmt->columnindexmask;
+  while (stmt->columnindex[slot] >= 0) {
+    column = &stmt->columns[stmt->columnindex[slot]];
+    if (column->namelen == len && memcmp(column->name, name, len) == 0)
+      return stmt->columnindex[slot];
+    slot = (slot + 1) & stmt->columnindexmask;
+  }
+  return -1;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_column_type (cdba_prep_handle stmt, int col)
+{
+#if defined(DB_SQLITE3)
+  //SQLite3 values are typed dynamically, so the type of the value in the current row is returned
+  if (col < 0 || col >= stmt->numcols)
+    return CDBA_TYPE_NULL;
+  return cdba_sqlite3_value_type(stmt->sqlite3_prepstat, col);
+#else
+  const cdba_column_info* column;
+  if ((column = cdba_prep_get_column_info(stmt, col)) == NULL)
+    return CDBA_TYPE_NULL;
+  return column->type;
+#endif
+}
+
+DLL_EXPORT_CDBALIB char* cdba_prep_get_column_name (cdba_prep_handle stmt, int col)
+{
+  const char* colname;
+  size_t colnamelen;
+  if ((colname = cdba_prep_get_column_name_ref(stmt, col, &colnamelen)) == NULL)
+    return NULL;
+  //the column descriptors can be rebuilt when the statement is executed again, so a copy is returned even when the arena is used
+  return cdba_prep_copy_text(stmt, colname, colnamelen);
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_prep_get_column_name_ref (cdba_prep_handle stmt, int col, size_t* len)
+{
+  const cdba_column_info* column;
+  if ((column = cdba_prep_get_column_info(stmt, col)) == NULL)
+    return NULL;
+  if (len)
+    *len = column->namelen;
+  return column->name;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_prep_get_column_int (cdba_prep_handle stmt, int col)
+{
+#if defined(DB_MYSQL)
+  MYSQL_BIND bindarg;
+  long long result = 0;
+  memset(&bindarg, 0, sizeof(MYSQL_BIND));
+  bindarg.buffer_type = MYSQL_TYPE_LONGLONG;
+  bindarg.buffer = &result;
+  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &bindarg, col, 0) != 0)
+    return 0;
+  return result;
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  return sqlite3_column_int64(stmt->sqlite3_prepstat, col);
+#elif defined(DB_ODBC)
+  SQLLEN value_size;
+  SQLINTEGER value = -1;
+  if (SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_INTEGER, (SQLCHAR*)&value, (SQLLEN)sizeof(value), &value_size) == SQL_SUCCESS) {
+    if (value_size == SQL_NULL_DATA || value_size == SQL_NO_TOTAL)
+      value = 0;
+  }
+  return value;
+#else
+  return 0;
+#endif
+}
+
+DLL_EXPORT_CDBALIB double cdba_prep_get_column_float (cdba_prep_handle stmt, int col)
+{
+#if defined(DB_MYSQL)
+  MYSQL_BIND bindarg;
+  double result = 0;
+  memset(&bindarg, 0, sizeof(MYSQL_BIND));
+  bindarg.buffer_type = MYSQL_TYPE_DOUBLE;
+  bindarg.buffer = &result;
+  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &bindarg, col, 0) != 0)
+    return 0;
+  return result;
+#elif defined(DB_FREETDS)
+#elif defined(DB_SQLITE3)
+  return sqlite3_column_double(stmt->sqlite3_prepstat, col);
+#elif defined(DB_ODBC)
+  SQLLEN value_size;
+  SQLDOUBLE value = -1;
+  if (SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_DOUBLE, (SQLCHAR*)&value, (SQLLEN)sizeof(value), &value_size) == SQL_SUCCESS) {
+    if (value_size == SQL_NULL_DATA || value_size == SQL_NO_TOTAL)
+      value = 0;
+  }
+  return value;
+#else
+  return 0;
+#endif
+}
+
+DLL_EXPORT_CDBALIB char* cdba_prep_get_column_text (cdba_prep_handle stmt, int col)
+{
+  const char* value;
+  size_t valuelen;
+#if defined(DB_MYSQL)
+  if (stmt->mysql_bind_result && stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_STRING && stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_BLOB)
+    return cdba_prep_copy_text(stmt, "ERROR (not a string)", 20);
+    //return NULL;
+#endif
+  if ((value = cdba_prep_get_column_text_ref(stmt, col, &valuelen)) == NULL)
+    return NULL;
+  return cdba_prep_copy_text(stmt, value, valuelen);
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_prep_get_column_text_ref (cdba_prep_handle stmt, int col, size_t* len)
+{
+  if (col < 0 || col >= stmt->numcols)
+    return NULL;
+#if defined(DB_MYSQL)
+  struct cdba_column_buffer_struct* buf;
+  MYSQL_BIND mysql_bind_var;
+  unsigned long length;
+  if (!stmt->mysql_bind_result || (stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_STRING && stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_BLOB) || stmt->mysql_bind_vars[col].is_null)
+    return NULL;
+  //fetch the value into a buffer that is kept with the statement and only grows when needed
+  buf = &stmt->colbuf[col];
+  if (cdba_column_buffer_reserve(buf, stmt->mysql_bind_vars[col].length + 1) != 0)
+    return NULL;
+  memset(&mysql_bind_var, 0, sizeof(mysql_bind_var));
+  mysql_bind_var.buffer_type = stmt->mysql_bind_result[col].buffer_type;
+  mysql_bind_var.buffer = buf->data;
+  mysql_bind_var.buffer_length = buf->size;
+  mysql_bind_var.length = &length;
+  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &mysql_bind_var, col, 0) != 0)
+    return NULL;
+  buf->len = (length < buf->size ? length : buf->size - 1);
+  buf->data[buf->len] = 0;
+  if (len)
+    *len = buf->len;
+  return buf->data;
+#elif defined(DB_FREETDS)
+  return NULL;
+#elif defined(DB_SQLITE3)
+  const char* result;
+  if ((result = (const char*)sqlite3_column_text(stmt->sqlite3_prepstat, col)) == NULL)
+    return NULL;
+  if (len)
+    *len = sqlite3_column_bytes(stmt->sqlite3_prepstat, col);
+  return result;
+#elif defined(DB_ODBC)
+#define STRING_ALLOCATE_INITIAL 256
+  struct cdba_column_buffer_struct* buf;
+  SQLRETURN status;
+  SQLLEN valuelen;
+  size_t avail;
+  size_t part;
+  buf = &stmt->colbuf[col];
+  //binary values are retrieved as is instead of as hexadecimal text
+  if (!buf->ctype)
+    buf->ctype = (cdba_prep_get_column_type(stmt, col) == CDBA_TYPE_BLOB ? SQL_C_BINARY : SQL_C_CHAR);
+  //SQLGetData() can only be called once per column, so keep the value in case it is requested again for the same row
+  if (buf->row != stmt->odbc_row) {
+    buf->row = stmt->odbc_row;
+    buf->len = 0;
+    buf->is_null = 0;
+    if (cdba_column_buffer_reserve(buf, STRING_ALLOCATE_INITIAL) != 0) {
+      buf->is_null = 1;
+      return NULL;
+    }
+    //read the value in as many parts as needed, growing the buffer to the total size reported by the driver
+    while (1) {
+      avail = buf->size - buf->len;
+      status = SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), buf->ctype, (SQLCHAR*)buf->data + buf->len, avail, &valuelen);
+      if (status == SQL_SUCCESS) {
+        if (valuelen == SQL_NULL_DATA)
+          buf->is_null = 1;
+        else if (valuelen != SQL_NO_TOTAL)
+          buf->len += valuelen;
+        else if (buf->ctype == SQL_C_CHAR)
+          buf->len += strlen(buf->data + buf->len);
+        break;
+      } else if (status == SQL_SUCCESS_WITH_INFO) {
+        if (valuelen == SQL_NULL_DATA) {
+          buf->is_null = 1;
+          break;
+        }
+        if (valuelen != SQL_NO_TOTAL && (size_t)valuelen < avail) {
+          buf->len += valuelen;
+          break;
+        }
+        //truncated text parts are zero-terminated, binary parts fill the whole buffer
+        part = (buf->ctype == SQL_C_BINARY ? avail : avail - 1);
+        buf->len += part;
+        if (cdba_column_buffer_reserve(buf, (valuelen != SQL_NO_TOTAL ? buf->len + (valuelen - part) + 1 : buf->size * 2)) != 0) {
+          buf->is_null = 1;
+          break;
+        }
+      } else if (status == SQL_NO_DATA) {
+        break;
+      } else {
+        buf->is_null = 1;
+        break;
+      }
+    }
+    if (!buf->is_null)
+      buf->data[buf->len] = 0;
+  }
+  if (buf->is_null)
+    return NULL;
+  if (len)
+    *len = buf->len;
+  return buf->data;
+#else
+  return NULL;
+#endif
+}
+
+DLL_EXPORT_CDBALIB const void* cdba_prep_get_column_blob (cdba_prep_handle stmt, int col, size_t* len)
+{
+#if defined(DB_SQLITE3)
+  const void* result;
+  if (col < 0 || col >= stmt->numcols)
+    return NULL;
+  //SQLite3 returns NULL for empty blobs
+  if ((result = sqlite3_column_blob(stmt->sqlite3_prepstat, col)) == NULL && sqlite3_column_type(stmt->sqlite3_prepstat, col) != SQLITE_NULL)
+    result = "";
+  if (result && len)
+    *len = sqlite3_column_bytes(stmt->sqlite3_prepstat, col);
+  return result;
+#else
+  //binary columns are already retrieved without conversion
+  return cdba_prep_get_column_text_ref(stmt, col, len);
+#endif
+}
+
+//copy part of a value into a buffer
+static size_t cdba_copy_chunk (const char* data, size_t datalen, size_t offset, char* buf, size_t buflen)
+{
+  size_t n;
+  if (!data || offset >= datalen)
+    return 0;
+  n = datalen - offset;
+  if (n > buflen)
+    n = buflen;
+  memcpy(buf, data + offset, n);
+  return n;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_get_column_chunk (cdba_prep_handle stmt, int col, size_t offset, char* buf, size_t buflen, size_t* len)
+{
+  size_t n = 0;
+  if (len)
+    *len = 0;
+  if (col < 0 || col >= stmt->numcols) {
+    cdba_prep_set_error(stmt, "Invalid column index");
+    return -1;
+  }
+#if defined(DB_MYSQL)
+  MYSQL_BIND mysql_bind_var;
+  unsigned long length;
+  if (!stmt->mysql_bind_result || stmt->mysql_bind_vars[col].is_null)
+    return 0;
+  if (stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_STRING && stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_BLOB) {
+    cdba_prep_set_error(stmt, "Not a text or binary column");
+    return -1;
+  }
+  //only the requested part is transferred into the caller's buffer
+  if (offset < stmt->mysql_bind_vars[col].length && buflen > 0) {
+    memset(&mysql_bind_var, 0, sizeof(mysql_bind_var));
+    mysql_bind_var.buffer_type = stmt->mysql_bind_result[col].buffer_type;
+    mysql_bind_var.buffer = buf;
+    mysql_bind_var.buffer_length = buflen;
+    mysql_bind_var.length = &length;
+    if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &mysql_bind_var, col, offset) != 0) {
+      cdba_prep_set_error(stmt, mysql_stmt_error(stmt->mysql_prepstat));
+      return -1;
+    }
+    n = stmt->mysql_bind_vars[col].length - offset;
+    if (n > buflen)
+      n = buflen;
+  }
+#elif defined(DB_FREETDS)
+  return -1;
+#elif defined(DB_SQLITE3)
+  const char* data;
+  if (sqlite3_column_type(stmt->sqlite3_prepstat, col) == SQLITE_BLOB)
+    data = (const char*)sqlite3_column_blob(stmt->sqlite3_prepstat, col);
+  else
+    data = (const char*)sqlite3_column_text(stmt->sqlite3_prepstat, col);
+  n = cdba_copy_chunk(data, sqlite3_column_bytes(stmt->sqlite3_prepstat, col), offset, buf, buflen);
+#elif defined(DB_ODBC)
+  struct cdba_column_buffer_struct* colbuf;
+  SQLRETURN status;
+  SQLLEN valuelen;
+  size_t skip;
+  colbuf = &stmt->colbuf[col];
+  if (colbuf->row == stmt->odbc_row) {
+    //the value was already retrieved by cdba_prep_get_column_text_ref()
+    n = (colbuf->is_null ? 0 : cdba_copy_chunk(colbuf->data, colbuf->len, offset, buf, buflen));
+  } else {
+    //SQLGetData() returns the value in consecutive parts, so chunks can only be read in order
+    if (colbuf->chunkrow != stmt->odbc_row) {
+      colbuf->chunkrow = stmt->odbc_row;
+      colbuf->chunkpos = 0;
+    }
+    if (offset < colbuf->chunkpos) {
+      cdba_prep_set_error(stmt, "Chunks must be read in order");
+      return -1;
+    }
+    while (buflen > 0) {
+      //skip data before offset using the caller's buffer
+      skip = offset - colbuf->chunkpos;
+      valuelen = 0;
+      status = SQLGetData(stmt->odbc_prepstat, col + 1, SQL_C_BINARY, buf, (skip > 0 && skip < buflen ? skip : buflen), &valuelen);
+      if (status == SQL_NO_DATA || valuelen == SQL_NULL_DATA)
+        break;
+      if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
+        cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
+        return -1;
+      }
+      //the value was truncated unless the remaining length fits
+      n = (skip > 0 && skip < buflen ? skip : buflen);
+      if (status == SQL_SUCCESS && valuelen != SQL_NO_TOTAL && (size_t)valuelen < n)
+        n = valuelen;
+      colbuf->chunkpos += n;
+      if (skip == 0)
+        break;
+      n = 0;
+    }
+  }
+#else
+  return -1;
+#endif
+  if (len)
+    *len = n;
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//state of the worker thread running asynchronous operations
+#define CDBA_ASYNC_WORKER_IDLE    0
+#define CDBA_ASYNC_WORKER_QUEUED  1
+#define CDBA_ASYNC_WORKER_RUNNING 2
+#define CDBA_ASYNC_WORKER_DONE    3             //finished, result not collected yet
+
+//maximum time in milliseconds to wait for the worker thread in the continue functions when no descriptor can be polled
+#define CDBA_ASYNC_WORKER_POLL_MS 10
+
+#ifdef _WIN32
+#define CDBA_ASYNC_WORKER_WAIT CDBA_ASYNC_TIMEOUT
+#else
+#define CDBA_ASYNC_WORKER_WAIT CDBA_ASYNC_READ
+#endif
+
+struct cdba_async_worker_struct {
+  ASYNC_THREAD thread;
+  ASYNC_MUTEX lock;
+  ASYNC_COND cond;                              //signaled when the state changes
+  int state;                                    //CDBA_ASYNC_WORKER_*
+  int stop;
+  int op;                                       //CDBA_ASYNC_OP_*
+  char* sql;
+  cdba_prep_handle stmt;
+  cdba_async_callback_fn callback;              //NULL when the result is collected with a continue function
+  void* callbackdata;
+  int status;
+#ifndef _WIN32
+  int pipefd[2];                                //a byte is written when an operation finished
+#endif
+};
+
+static ASYNC_THREAD_FUNCTION(cdba_async_worker_thread, arg)
+{
+  cdba_handle db = (cdba_handle)arg;
+  struct cdba_async_worker_struct* worker = db->async_worker;
+  int status;
+  cdba_async_callback_fn callback;
+  void* callbackdata;
+#if defined(DB_MYSQL)
+  mysql_thread_init();
+#endif
+  ASYNC_MUTEX_LOCK(&worker->lock);
+  while (1) {
+    while (worker->state != CDBA_ASYNC_WORKER_QUEUED && !worker->stop)
+      ASYNC_COND_WAIT(&worker->cond, &worker->lock);
+    if (worker->state != CDBA_ASYNC_WORKER_QUEUED)
+      break;
+    worker->state = CDBA_ASYNC_WORKER_RUNNING;
+    ASYNC_MUTEX_UNLOCK(&worker->lock);
+    //the connection is owned by the worker thread until the operation finished
+    switch (worker->op) {
+      case CDBA_ASYNC_OP_SQL :
+        status = cdba_sql(db, worker->sql);
+        free(worker->sql);
+        worker->sql = NULL;
+        break;
+      case CDBA_ASYNC_OP_EXECUTE :
+        status = cdba_prep_run(worker->stmt);
+        break;
+      case CDBA_ASYNC_OP_FETCH :
+        status = cdba_prep_fetch_row(worker->stmt);
+        break;
+      default :
+        status = -1;
+        break;
+    }
+    ASYNC_MUTEX_LOCK(&worker->lock);
+    if (worker->callback) {
+      //the worker is idle again before calling the callback so it can start the next operation
+      callback = worker->callback;
+      callbackdata = worker->callbackdata;
+      worker->callback = NULL;
+      worker->op = CDBA_ASYNC_OP_NONE;
+      worker->state = CDBA_ASYNC_WORKER_IDLE;
+      ASYNC_MUTEX_UNLOCK(&worker->lock);
+      callback(status, callbackdata);
+      ASYNC_MUTEX_LOCK(&worker->lock);
+    } else {
+      worker->status = status;
+      worker->state = CDBA_ASYNC_WORKER_DONE;
+#ifndef _WIN32
+      //wake up the caller polling the descriptor, the pipe never fills up as it holds at most one byte
+      while (write(worker->pipefd[1], "", 1) < 0 && errno == EINTR) {
+      }
+#endif
+      ASYNC_COND_BROADCAST(&worker->cond);
+    }
+  }
+  ASYNC_MUTEX_UNLOCK(&worker->lock);
+#if defined(DB_MYSQL)
+  mysql_thread_end();
+#endif
+  return 0;
+}
+
+//get the worker thread of a connection, starting it if needed
+static struct cdba_async_worker_struct* cdba_async_worker_get (cdba_handle db)
+{
+  struct cdba_async_worker_struct* worker;
+  if (db->async_worker)
+    return db->async_worker;
+  if ((worker = (struct cdba_async_worker_struct*)malloc(sizeof(struct cdba_async_worker_struct))) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    return NULL;
+  }
+  memset(worker, 0, sizeof(struct cdba_async_worker_struct));
+#ifndef _WIN32
+  if (pipe(worker->pipefd) != 0) {
+    cdba_set_error(db, "Error creating pipe for asynchronous operations");
+    free(worker);
+    return NULL;
+  }
+#endif
+  ASYNC_MUTEX_INIT(&worker->lock);
+  ASYNC_COND_INIT(&worker->cond);
+  db->async_worker = worker;
+  if (ASYNC_THREAD_CREATE(&worker->thread, cdba_async_worker_thread, db) != 0) {
+    db->async_worker = NULL;
+    ASYNC_COND_DESTROY(&worker->cond);
+    ASYNC_MUTEX_DESTROY(&worker->lock);
+#ifndef _WIN32
+    close(worker->pipefd[0]);
+    close(worker->pipefd[1]);
+#endif
+    free(worker);
+    cdba_set_error(db, "Error starting thread for asynchronous operations");
+    return NULL;
+  }
+  return worker;
+}
+
+//stop the worker thread of a connection after the running operation finished
+static void cdba_async_worker_stop (cdba_handle db)
+{
+  struct cdba_async_worker_struct* worker;
+  if ((worker = db->async_worker) == NULL)
+    return;
+  ASYNC_MUTEX_LOCK(&worker->lock);
+  worker->stop = 1;
+  ASYNC_COND_BROADCAST(&worker->cond);
+  ASYNC_MUTEX_UNLOCK(&worker->lock);
+  ASYNC_THREAD_JOIN(worker->thread);
+  ASYNC_COND_DESTROY(&worker->cond);
+  ASYNC_MUTEX_DESTROY(&worker->lock);
+#ifndef _WIN32
+  close(worker->pipefd[0]);
+  close(worker->pipefd[1]);
+#endif
+  free(worker->sql);
+  free(worker);
+  db->async_worker = NULL;
+}
+
+//check that no asynchronous operation is in progress on a connection
+static int cdba_async_check_idle (cdba_handle db)
+{
+  int busy = 0;
+#ifdef CDBA_MYSQL_NONBLOCK
+  if (db->mysql_async_op != CDBA_ASYNC_OP_NONE)
+    busy = 1;
+#endif
+  if (db->async_worker) {
+    ASYNC_MUTEX_LOCK(&db->async_worker->lock);
+    if (db->async_worker->state != CDBA_ASYNC_WORKER_IDLE)
+      busy = 1;
+    ASYNC_MUTEX_UNLOCK(&db->async_worker->lock);
+  }
+  if (busy) {
+    cdba_set_error(db, "Asynchronous operation in progress");
+    return -1;
+  }
+  return 0;
+}
+
+//queue an operation for the worker thread of a connection
+static int cdba_async_worker_queue (cdba_handle db, int op, const char* sql, cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata)
+{
+  struct cdba_async_worker_struct* worker;
+  char* sqlcopy = NULL;
+  if (cdba_async_check_idle(db) != 0)
+    return -1;
+  if ((worker = cdba_async_worker_get(db)) == NULL)
+    return -1;
+  if (sql && (sqlcopy = strdup(sql)) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    return -1;
+  }
+  ASYNC_MUTEX_LOCK(&worker->lock);
+  worker->op = op;
+  worker->sql = sqlcopy;
+  worker->stmt = stmt;
+  worker->callback = callback;
+  worker->callbackdata = callbackdata;
+  worker->state = CDBA_ASYNC_WORKER_QUEUED;
+  ASYNC_COND_BROADCAST(&worker->cond);
+  ASYNC_MUTEX_UNLOCK(&worker->lock);
+  return 0;
+}
+
+//collect the result of an operation run by the worker thread of a connection
+static int cdba_async_worker_cont (cdba_handle db, int op, cdba_prep_handle stmt, int* status)
+{
+  struct cdba_async_worker_struct* worker;
+#ifndef _WIN32
+  char c;
+#endif
+  if ((worker = db->async_worker) == NULL) {
+    cdba_set_error(db, "No asynchronous operation in progress");
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+  ASYNC_MUTEX_LOCK(&worker->lock);
+  if (worker->state == CDBA_ASYNC_WORKER_IDLE || worker->callback || worker->op != op || worker->stmt != stmt) {
+    ASYNC_MUTEX_UNLOCK(&worker->lock);
+    cdba_set_error(db, "No matching asynchronous operation in progress");
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+#ifdef _WIN32
+  //no descriptor to poll, so wait a short time for the operation to finish
+  if (worker->state != CDBA_ASYNC_WORKER_DONE)
+    SleepConditionVariableCS(&worker->cond, &worker->lock, CDBA_ASYNC_WORKER_POLL_MS);
+#endif
+  if (worker->state != CDBA_ASYNC_WORKER_DONE) {
+    ASYNC_MUTEX_UNLOCK(&worker->lock);
+    return CDBA_ASYNC_WORKER_WAIT;
+  }
+#ifndef _WIN32
+  //the byte was written before the state changed to done, so this doesn't block
+  while (read(worker->pipefd[0], &c, 1) < 0 && errno == EINTR) {
+  }
+#endif
+  *status = worker->status;
+  worker->op = CDBA_ASYNC_OP_NONE;
+  worker->stmt = NULL;
+  worker->state = CDBA_ASYNC_WORKER_IDLE;
+  ASYNC_MUTEX_UNLOCK(&worker->lock);
+  return CDBA_ASYNC_DONE;
+}
+
+#ifdef CDBA_MYSQL_NONBLOCK
+//end non-blocking SQL statement
+static int cdba_async_mysql_sql_finish (cdba_handle db, int* status, int result)
+{
+  cdba_stats_record_execute(db, NULL, db->mysql_async_start, 1, (result != 0), (result == 0 ? cdba_stats_rows_affected(db, 0) : 0), 0);
+  db->mysql_async_op = CDBA_ASYNC_OP_NONE;
+  db->mysql_async_result = NULL;
+  *status = result;
+  return CDBA_ASYNC_DONE;
+}
+
+static int cdba_async_mysql_sql_executed (cdba_handle db, int* status, int err);
+
+//move to the result of the next statement of a non-blocking SQL string, the connection is out of sync until all results are read
+static int cdba_async_mysql_sql_next (cdba_handle db, int* status)
+{
+  int ret;
+  int waitstatus;
+  db->mysql_async_result = NULL;
+  if (!mysql_more_results(db->mysql_conn))
+    return cdba_async_mysql_sql_finish(db, status, 0);
+  db->mysql_async_op = CDBA_ASYNC_OP_SQL_NEXT;
+  if ((waitstatus = mysql_next_result_start(&ret, db->mysql_conn)) != 0)
+    return waitstatus;
+  //ret is -1 when there are no more results, above zero when the next statement failed
+  if (ret < 0)
+    return cdba_async_mysql_sql_finish(db, status, 0);
+  return cdba_async_mysql_sql_executed(db, status, ret);
+}
+
+//process the result of a non-blocking SQL statement, any result set is discarded without blocking
+static int cdba_async_mysql_sql_executed (cdba_handle db, int* status, int err)
+{
+  int waitstatus;
+  if (err) {
+    cdba_set_error(db, mysql_error(db->mysql_conn));
+    return cdba_async_mysql_sql_finish(db, status, -1);
+  }
+  if (mysql_field_count(db->mysql_conn) > 0 && (db->mysql_async_result = mysql_use_result(db->mysql_conn)) != NULL) {
+    db->mysql_async_op = CDBA_ASYNC_OP_SQL_RESULT;
+    if ((waitstatus = mysql_free_result_start(db->mysql_async_result)) != 0)
+      return waitstatus;
+  }
+  return cdba_async_mysql_sql_next(db, status);
+}
+
+//end non-blocking buffering of the result of a prepared statement
+static int cdba_async_mysql_store_finish (cdba_prep_handle stmt, int* status, int ret)
+{
+  cdba_handle db = stmt->db;
+  int result;
+  db->mysql_async_op = CDBA_ASYNC_OP_NONE;
+  db->mysql_async_stmt = NULL;
+  result = cdba_prep_mysql_stored(stmt, ret);
+  cdba_stats_record_execute(db, &stmt->stats, db->mysql_async_start, 1, (result < 0), (result >= 0 ? cdba_prep_stats_rows_affected(stmt, 0) : 0), 0);
+  *status = result;
+  return CDBA_ASYNC_DONE;
+}
+
+//end non-blocking execution of a prepared statement
+static int cdba_async_mysql_execute_finish (cdba_prep_handle stmt, int* status, int err)
+{
+  cdba_handle db = stmt->db;
+  int result;
+  int ret;
+  int waitstatus;
+  result = cdba_prep_mysql_executed(stmt, err);
+  //buffer the result without blocking when needed
+  if (result == 0 && cdba_prep_mysql_needs_store(stmt)) {
+    db->mysql_async_op = CDBA_ASYNC_OP_STORE;
+    if ((waitstatus = mysql_stmt_store_result_start(&ret, stmt->mysql_prepstat)) != 0)
+      return waitstatus;
+    return cdba_async_mysql_store_finish(stmt, status, ret);
+  }
+  db->mysql_async_op = CDBA_ASYNC_OP_NONE;
+  db->mysql_async_stmt = NULL;
+  cdba_stats_record_execute(db, &stmt->stats, db->mysql_async_start, 1, (result < 0), (result >= 0 ? cdba_prep_stats_rows_affected(stmt, 0) : 0), 0);
+  *status = result;
+  return CDBA_ASYNC_DONE;
+}
+
+//end non-blocking fetch of a row of a prepared statement
+static int cdba_async_mysql_fetch_finish (cdba_prep_handle stmt, int* status, int ret)
+{
+  cdba_handle db = stmt->db;
+  int result;
+  db->mysql_async_op = CDBA_ASYNC_OP_NONE;
+  db->mysql_async_stmt = NULL;
+  result = cdba_prep_mysql_fetched(ret);
+  cdba_stats_record_fetch(db, &stmt->stats, db->mysql_async_start, (result > 0 ? 1 : 0), (result < 0), 0);
+  *status = result;
+  return CDBA_ASYNC_DONE;
+}
+
+//check that a non-blocking operation of a prepared statement is in progress
+static int cdba_async_mysql_check_stmt (cdba_prep_handle stmt, int op, int* status)
+{
+  if (stmt->db->mysql_async_op != op || stmt->db->mysql_async_stmt != stmt) {
+    cdba_prep_set_error(stmt, "No matching asynchronous operation in progress");
+    *status = -1;
+    return -1;
+  }
+  return 0;
+}
+#endif
+
+DLL_EXPORT_CDBALIB int cdba_get_async_fd (cdba_handle db)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  return (int)mysql_get_socket(db->mysql_conn);
+#elif !defined(_WIN32)
+  struct cdba_async_worker_struct* worker;
+  if ((worker = cdba_async_worker_get(db)) == NULL)
+    return -1;
+  return worker->pipefd[0];
+#else
+  return -1;
+#endif
+}
+
+DLL_EXPORT_CDBALIB unsigned int cdba_get_async_timeout (cdba_handle db)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  return mysql_get_timeout_value_ms(db->mysql_conn);
+#else
+  (void)db;
+  return CDBA_ASYNC_WORKER_POLL_MS;
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_sql_start (cdba_handle db, int* status, const char* sql)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int err;
+  int waitstatus;
+  if (cdba_async_check_idle(db) != 0) {
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+  db->mysql_async_op = CDBA_ASYNC_OP_SQL;
+  db->mysql_async_start = CDBA_STATS_START(db);
+  cdba_mysql_sql_executed(db, sql, strlen(sql));
+  cdba_result_cache_sql_executed(db, sql, strlen(sql));
+  if ((waitstatus = mysql_real_query_start(&err, db->mysql_conn, sql, strlen(sql))) != 0)
+    return waitstatus;
+  return cdba_async_mysql_sql_executed(db, status, err);
+#else
+  if (cdba_async_worker_queue(db, CDBA_ASYNC_OP_SQL, sql, NULL, NULL, NULL) != 0) {
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+  return CDBA_ASYNC_WORKER_WAIT;
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_sql_cont (cdba_handle db, int* status, int ready)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int err;
+  int waitstatus;
+  switch (db->mysql_async_op) {
+    case CDBA_ASYNC_OP_SQL :
+      if ((waitstatus = mysql_real_query_cont(&err, db->mysql_conn, ready)) != 0)
+        return waitstatus;
+      return cdba_async_mysql_sql_executed(db, status, err);
+    case CDBA_ASYNC_OP_SQL_RESULT :
+      if ((waitstatus = mysql_free_result_cont(db->mysql_async_result, ready)) != 0)
+        return waitstatus;
+      return cdba_async_mysql_sql_next(db, status);
+    case CDBA_ASYNC_OP_SQL_NEXT :
+      if ((waitstatus = mysql_next_result_cont(&err, db->mysql_conn, ready)) != 0)
+        return waitstatus;
+      if (err < 0)
+        return cdba_async_mysql_sql_finish(db, status, 0);
+      return cdba_async_mysql_sql_executed(db, status, err);
+  }
+  cdba_set_error(db, "No matching asynchronous operation in progress");
+  *status = -1;
+  return CDBA_ASYNC_DONE;
+#else
+  (void)ready;
+  return cdba_async_worker_cont(db, CDBA_ASYNC_OP_SQL, NULL, status);
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_start (cdba_prep_handle stmt, int* status)
+{
+  *status = -1;
+  if (cdba_async_check_idle(stmt->db) != 0 || cdba_prep_bind_arguments(stmt) != 0)
+    return CDBA_ASYNC_DONE;
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int err;
+  int waitstatus;
+  stmt->row_pending = 0;
+  cdba_arena_recycle(stmt->arena);
+  stmt->db->mysql_async_op = CDBA_ASYNC_OP_EXECUTE;
+  stmt->db->mysql_async_stmt = stmt;
+  stmt->db->mysql_async_start = CDBA_STATS_START(stmt->db);
+  cdba_result_cache_statement_executed(stmt);
+  if ((waitstatus = mysql_stmt_execute_start(&err, stmt->mysql_prepstat)) != 0)
+    return waitstatus;
+  return cdba_async_mysql_execute_finish(stmt, status, err);
+#else
+  if (cdba_async_worker_queue(stmt->db, CDBA_ASYNC_OP_EXECUTE, NULL, stmt, NULL, NULL) != 0)
+    return CDBA_ASYNC_DONE;
+  return CDBA_ASYNC_WORKER_WAIT;
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_cont (cdba_prep_handle stmt, int* status, int ready)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int err;
+  int ret;
+  int waitstatus;
+  if (stmt->db->mysql_async_op == CDBA_ASYNC_OP_STORE && stmt->db->mysql_async_stmt == stmt) {
+    if ((waitstatus = mysql_stmt_store_result_cont(&ret, stmt->mysql_prepstat, ready)) != 0)
+      return waitstatus;
+    return cdba_async_mysql_store_finish(stmt, status, ret);
+  }
+  if (cdba_async_mysql_check_stmt(stmt, CDBA_ASYNC_OP_EXECUTE, status) != 0)
+    return CDBA_ASYNC_DONE;
+  if ((waitstatus = mysql_stmt_execute_cont(&err, stmt->mysql_prepstat, ready)) != 0)
+    return waitstatus;
+  return cdba_async_mysql_execute_finish(stmt, status, err);
+#else
+  (void)ready;
+  return cdba_async_worker_cont(stmt->db, CDBA_ASYNC_OP_EXECUTE, stmt, status);
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_start (cdba_prep_handle stmt, int* status)
+{
+  if (cdba_async_check_idle(stmt->db) != 0) {
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int ret;
+  int waitstatus;
+  //return row left over by cdba_prep_fetch_batch()
+  if (stmt->row_pending) {
+    *status = cdba_prep_fetch_row(stmt);
+    return CDBA_ASYNC_DONE;
+  }
+  cdba_arena_recycle(stmt->arena);
+  stmt->db->mysql_async_op = CDBA_ASYNC_OP_FETCH;
+  stmt->db->mysql_async_stmt = stmt;
+  stmt->db->mysql_async_start = CDBA_STATS_START(stmt->db);
+  if ((waitstatus = mysql_stmt_fetch_start(&ret, stmt->mysql_prepstat)) != 0)
+    return waitstatus;
+  return cdba_async_mysql_fetch_finish(stmt, status, ret);
+#else
+  if (cdba_async_worker_queue(stmt->db, CDBA_ASYNC_OP_FETCH, NULL, stmt, NULL, NULL) != 0) {
+    *status = -1;
+    return CDBA_ASYNC_DONE;
+  }
+  return CDBA_ASYNC_WORKER_WAIT;
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_cont (cdba_prep_handle stmt, int* status, int ready)
+{
+#if defined(CDBA_MYSQL_NONBLOCK)
+  int ret;
+  int waitstatus;
+  if (cdba_async_mysql_check_stmt(stmt, CDBA_ASYNC_OP_FETCH, status) != 0)
+    return CDBA_ASYNC_DONE;
+  if ((waitstatus = mysql_stmt_fetch_cont(&ret, stmt->mysql_prepstat, ready)) != 0)
+    return waitstatus;
+  return cdba_async_mysql_fetch_finish(stmt, status, ret);
+#else
+  (void)ready;
+  return cdba_async_worker_cont(stmt->db, CDBA_ASYNC_OP_FETCH, stmt, status);
+#endif
+}
+
+DLL_EXPORT_CDBALIB int cdba_sql_async (cdba_handle db, const char* sql, cdba_async_callback_fn callback, void* callbackdata)
+{
+  if (!callback)
+    return -1;
+  return cdba_async_worker_queue(db, CDBA_ASYNC_OP_SQL, sql, NULL, callback, callbackdata);
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_async (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata)
+{
+  if (!callback || cdba_async_check_idle(stmt->db) != 0 || cdba_prep_bind_arguments(stmt) != 0)
+    return -1;
+  return cdba_async_worker_queue(stmt->db, CDBA_ASYNC_OP_EXECUTE, NULL, stmt, callback, callbackdata);
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_row_async (cdba_prep_handle stmt, cdba_async_callback_fn callback, void* callbackdata)
+{
+  if (!callback)
+    return -1;
+  return cdba_async_worker_queue(stmt->db, CDBA_ASYNC_OP_FETCH, NULL, stmt, callback, callbackdata);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//execute prepared statement and pass each row to the callback
+static int cdba_prep_foreach_rows (cdba_prep_handle stmt, cdba_row_callback_fn callback, void* callbackdata)
+{
+  int status;
+  int rows = 0;
+  if (cdba_prep_execute_bound(stmt) != 0)
+    return -1;
+  while ((status = cdba_prep_fetch_row(stmt)) > 0) {
+    rows++;
+    //discard the remaining rows when the callback stops the iteration
+    if (callback(&stmt->rowview, callbackdata) != 0) {
+      cdba_prep_reset(stmt);
+      break;
+    }
+  }
+  return (status < 0 ? -1 : rows);
+}
+
+//pass the rows of a query to the callback from the result cache or execute it and record its result
+static int cdba_result_cache_foreach (cdba_prep_handle stmt, cdba_row_callback_fn callback, void* callbackdata)
+{
+  cdba_handle db = stmt->db;
+  struct cdba_result_cache_entry_struct* entry;
+  struct cdba_row_struct row;
+  uint64_t generation;
+  uint32_t hash;
+  size_t keylen;
+  size_t i;
+  int status;
+  int rows = 0;
+  int stopped = 0;
+  //results of statements with streamed arguments are not cached
+  if ((keylen = cdba_result_cache_key(stmt)) == 0)
+    return cdba_prep_foreach_rows(stmt, callback, callbackdata);
+  hash = cdba_result_cache_hash(db->rescache_key, keylen);
+  //serve the cached result
+  if ((entry = cdba_result_cache_find(db, hash, keylen)) != NULL) {
+    db->rescache_stats.hits++;
+    if (db->rescache_mru != entry) {
+      cdba_result_cache_lru_unlink(db, entry);
+      cdba_result_cache_lru_push(db, entry);
+    }
+    //the callback may change the cache, so the entry is kept until the iteration is done
+    entry->refs++;
+    row = stmt->rowview;
+    row.cacheentry = entry;
+    for (i = 0; i < entry->numrows; i++) {
+      row.cachevalues = entry->values + i * entry->numcols;
+      rows++;
+      if (callback(&row, callbackdata) != 0)
+        break;
+    }
+    if (--entry->refs == 0 && entry->removed)
+      cdba_result_cache_entry_free(entry);
+    return rows;
+  }
+  //execute the query and record the rows passed to the callback, the key is copied to the entry as the callback may use the cache
+  db->rescache_stats.misses++;
+  generation = db->rescache_generation;
+  if (cdba_prep_execute_bound(stmt) != 0)
+    return -1;
+  entry = cdba_result_cache_entry_create(stmt, hash, keylen);
+  while ((status = cdba_prep_fetch_row(stmt)) > 0) {
+    rows++;
+    if (entry)
+      cdba_result_cache_record_row(entry, &stmt->rowview, db->rescache_stats.capacity);
+    if (callback(&stmt->rowview, callbackdata) != 0) {
+      cdba_prep_reset(stmt);
+      stopped = 1;
+      break;
+    }
+  }
+  //only complete results not affected by writes done meanwhile are cached
+  cdba_result_cache_apply_writes(db);
+  if (entry) {
+    if (status >= 0 && !stopped && !entry->failed && generation == db->rescache_generation && db->rescache_stats.capacity > 0)
+      cdba_result_cache_insert(db, entry);
+    else
+      cdba_result_cache_entry_free(entry);
+  }
+  return (status < 0 ? -1 : rows);
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_foreach (cdba_prep_handle stmt, cdba_row_callback_fn callback, void* callbackdata)
+{
+  if (!callback)
+    return -1;
+  if (stmt->db->rescache_stats.capacity > 0 && cdba_prep_sql_kind(stmt) == CDBA_SQL_READ)
+    return cdba_result_cache_foreach(stmt, callback, callbackdata);
+  return cdba_prep_foreach_rows(stmt, callback, callbackdata);
+}
+
+DLL_EXPORT_CDBALIB int cdba_query_foreach (cdba_handle db, const char* sql, cdba_row_callback_fn callback, void* callbackdata)
+{
+  cdba_prep_handle stmt;
+  int result;
+  if ((stmt = cdba_prepare_cached(db, sql)) == NULL)
+    return -1;
+  if ((result = cdba_prep_foreach(stmt, callback, callbackdata)) < 0 && stmt->errmsg)
+    cdba_set_error(db, stmt->errmsg);
+  cdba_prep_close(stmt);
+  return result;
+}
+
+//get a cached value as an integer
+static db_int cdba_result_cache_get_int (const struct cdba_result_cache_entry_struct* entry, const struct cdba_result_cache_value_struct* value)
+{
+  if (value->offset == CDBA_NTS)
+    return 0;
+  if (value->type == CDBA_TYPE_INT)
+    return value->value.intval;
+  if (value->type == CDBA_TYPE_FLOAT)
+    return (db_int)value->value.floatval;
+  return strtoll(entry->data + value->offset, NULL, 10);
+}
+
+//get a cached value as a floating point number
+static db_flt cdba_result_cache_get_float (const struct cdba_result_cache_entry_struct* entry, const struct cdba_result_cache_value_struct* value)
+{
+  if (value->offset == CDBA_NTS)
+    return 0;
+  if (value->type == CDBA_TYPE_FLOAT)
+    return value->value.floatval;
+  if (value->type == CDBA_TYPE_INT)
+    return (db_flt)value->value.intval;
+  return strtod(entry->data + value->offset, NULL);
+}
+
+DLL_EXPORT_CDBALIB int cdba_row_get_column_count (cdba_row row)
+{
+  if (row->cacheentry)
+    return row->cacheentry->numcols;
+#if defined(DB_MYSQL)
+  if (!row->stmt)
+    return row->mysql_numfields;
+#endif
+  return row->stmt->numcols;
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_row_get_type (cdba_row row, int col)
+{
+  if (row->cacheentry)
+    return row->cachevalues[col].type;
+#if defined(DB_MYSQL)
+  if (!row->stmt)
+    return cdba_mysql_column_type(&row->mysql_fields[col]);
+#endif
+  return cdba_prep_get_column_type(row->stmt, col);
+}
+
+DLL_EXPORT_CDBALIB int cdba_row_is_null (cdba_row row, int col)
+{
+  cdba_prep_handle stmt = row->stmt;
+  if (row->cacheentry)
+    return (row->cachevalues[col].offset == CDBA_NTS);
+#if defined(DB_MYSQL)
+  if (!stmt)
+    return (row->mysql_row[col] == NULL);
+  return (stmt->mysql_bind_vars[col].is_null || stmt->mysql_bind_result[col].buffer_type == MYSQL_TYPE_NULL);
+#elif defined(DB_FREETDS)
+  return 1;
+#elif defined(DB_SQLITE3)
+  return (sqlite3_column_type(stmt->sqlite3_prepstat, col) == SQLITE_NULL);
+#elif defined(DB_ODBC)
+  return (cdba_prep_get_column_text_ref(stmt, col, NULL) == NULL);
+#else
+  return 1;
+#endif
+}
+
+DLL_EXPORT_CDBALIB db_int cdba_row_get_int (cdba_row row, int col)
+{
+  cdba_prep_handle stmt = row->stmt;
+  if (row->cacheentry)
+    return cdba_result_cache_get_int(row->cacheentry, &row->cachevalues[col]);
+#if defined(DB_MYSQL)
+  //values of text protocol results are strings
+  if (!stmt)
+    return (row->mysql_row[col] ? strtoll(row->mysql_row[col], NULL, 10) : 0);
+  //numeric values are already in the result bindings
+  if (stmt->mysql_bind_vars[col].is_null)
+    return 0;
+  if (stmt->mysql_bind_result[col].buffer_type == MYSQL_TYPE_LONGLONG)
+    return stmt->mysql_bind_vars[col].value.intval;
+  if (stmt->mysql_bind_result[col].buffer_type == MYSQL_TYPE_DOUBLE)
+    return (db_int)stmt->mysql_bind_vars[col].value.floatval;
+  return cdba_prep_get_column_int(stmt, col);
+#elif defined(DB_FREETDS)
+  return 0;
+#elif defined(DB_SQLITE3)
+  return sqlite3_column_int64(stmt->sqlite3_prepstat, col);
+#elif defined(DB_ODBC)
+  //SQLGetData() can only be called once per column, so values are converted from the text kept for the current row
+  const char* value;
+  if ((value = cdba_prep_get_column_text_ref(stmt, col, NULL)) == NULL)
+    return 0;
+  return strtoll(value, NULL, 10);
+#else
+  return 0;
+#endif
+}
+
+DLL_EXPORT_CDBALIB db_flt cdba_row_get_float (cdba_row row, int col)
+{
+  cdba_prep_handle stmt = row->stmt;
+  if (row->cacheentry)
+    return cdba_result_cache_get_float(row->cacheentry, &row->cachevalues[col]);
+#if defined(DB_MYSQL)
+  if (!stmt)
+    return (row->mysql_row[col] ? strtod(row->mysql_row[col], NULL) : 0);
+  if (stmt->mysql_bind_vars[col].is_null)
+    return 0;
+  if (stmt->mysql_bind_result[col].buffer_type == MYSQL_TYPE_DOUBLE)
+    return stmt->mysql_bind_vars[col].value.floatval;
+  if (stmt->mysql_bind_result[col].buffer_type == MYSQL_TYPE_LONGLONG)
+    return (db_flt)stmt->mysql_bind_vars[col].value.intval;
+  return cdba_prep_get_column_float(stmt, col);
+#elif defined(DB_FREETDS)
+  return 0;
+#elif defined(DB_SQLITE3)
+  return sqlite3_column_double(stmt->sqlite3_prepstat, col);
+#elif defined(DB_ODBC)
+  const char* value;
+  if ((value = cdba_prep_get_column_text_ref(stmt, col, NULL)) == NULL)
+    return 0;
+  return strtod(value, NULL);
+#else
+  return 0;
+#endif
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_row_get_text (cdba_row row, int col, size_t* len)
+{
+  if (row->cacheentry) {
+    if (len)
+      *len = row->cachevalues[col].len;
+    return (row->cachevalues[col].offset == CDBA_NTS ? NULL : row->cacheentry->data + row->cachevalues[col].offset);
+  }
+#if defined(DB_MYSQL)
+  if (!row->stmt) {
+    if (len)
+      *len = (row->mysql_row[col] ? row->mysql_lengths[col] : 0);
+    return row->mysql_row[col];
+  }
+#endif
+  return cdba_prep_get_column_text_ref(row->stmt, col, len);
+}
+
+DLL_EXPORT_CDBALIB const void* cdba_row_get_blob (cdba_row row, int col, size_t* len)
+{
+  //cached values are kept the same way as text
+  if (row->cacheentry)
+    return cdba_row_get_text(row, col, len);
+#if defined(DB_MYSQL)
+  if (!row->stmt)
+    return cdba_row_get_text(row, col, len);
+#endif
+  return cdba_prep_get_column_blob(row->stmt, col, len);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+struct cdba_multi_struct {
+#ifdef CDBA_DRIVER
+  const struct cdba_driver_struct* driver;   //must be the first member
+#endif
+  cdba_handle db;
+  int state;                                  //CDBA_MULTI_STATE_*
+  int status;                                 //status of the current statement (0 on success or negative on error)
+  char* errmsg;                               //error message of the current statement
+  db_int rowsaffected;
+#if defined(DB_MYSQL)
+  MYSQL_RES* mysql_result;
+  struct cdba_row_struct rowview;
+#else
+  char* sql;                                  //copy of the SQL statements
+  char* sqlnext;                              //statements not executed yet
+  cdba_prep_handle stmt;                      //statement of the current result
+#endif
+};
+
+#define CDBA_MULTI_STATE_START    0           //no result retrieved yet
+#define CDBA_MULTI_STATE_RESULT   1           //positioned on a result
+#define CDBA_MULTI_STATE_DONE     2           //no more results
+
+//remember error of the current statement, no more results follow a failed statement
+static void cdba_multi_set_error (cdba_multi_handle multi, const char* errmsg)
+{
+  free(multi->errmsg);
+  multi->errmsg = (errmsg ? strdup(errmsg) : NULL);
+  multi->status = -1;
+  multi->state = CDBA_MULTI_STATE_DONE;
+}
+
+DLL_EXPORT_CDBALIB cdba_multi_handle cdba_multiple_sql_open (cdba_handle db, const char* sql)
+{
+  struct cdba_multi_struct* multi;
+  if (!sql) {
+    cdba_set_error(db, "No SQL statement");
+    return NULL;
+  }
+  if ((multi = (struct cdba_multi_struct*)malloc(sizeof(struct cdba_multi_struct))) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    return NULL;
+  }
+#ifdef CDBA_DRIVER
+  multi->driver = &CDBA_DRIVER_TABLE;
+#endif
+  multi->db = db;
+  multi->state = CDBA_MULTI_STATE_START;
+  multi->status = 0;
+  multi->errmsg = NULL;
+  multi->rowsaffected = 0;
+#if defined(DB_MYSQL)
+  multi->mysql_result = NULL;
+#ifdef CDBA_DRIVER
+  multi->rowview.driver = &CDBA_DRIVER_TABLE;
+#endif
+  multi->rowview.stmt = NULL;
+  multi->rowview.cacheentry = NULL;
+  multi->rowview.cachevalues = NULL;
+  multi->rowview.mysql_row = NULL;
+  multi->rowview.mysql_lengths = NULL;
+  multi->rowview.mysql_fields = NULL;
+  multi->rowview.mysql_numfields = 0;
+  //all statements are sent in one round trip, a failure is the error of the first statement
+  uint64_t start = CDBA_STATS_START(db);
+  int status = mysql_real_query(db->mysql_conn, sql, strlen(sql));
+  cdba_stats_record_execute(db, NULL, start, 1, (status != 0), 0, 0);
+  cdba_mysql_sql_executed(db, sql, strlen(sql));
+  cdba_result_cache_sql_executed(db, sql, strlen(sql));
+  if (status != 0) {
+    cdba_multi_set_error(multi, mysql_error(db->mysql_conn));
+    multi->state = CDBA_MULTI_STATE_START;
+  }
+#else
+  //statements are prepared and executed one by one as the results are retrieved
+  if ((multi->sql = strdup(sql)) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    free(multi);
+    return NULL;
+  }
+  multi->sqlnext = multi->sql;
+  multi->stmt = NULL;
+#endif
+  return multi;
+}
+
+#if !defined(DB_MYSQL)
+//prepare and execute the next statement, returns zero if there are no more statements
+static int cdba_multi_execute_next (cdba_multi_handle multi)
+{
+  char* sql;
+  size_t len;
+  //skip spaces and empty statements
+  while (*multi->sqlnext == ' ' || *multi->sqlnext == '\t' || *multi->sqlnext == '\r' || *multi->sqlnext == '\n' || *multi->sqlnext == ';')
+    multi->sqlnext++;
+  if (!*multi->sqlnext)
+    return 0;
+  sql = multi->sqlnext;
+#if defined(DB_SQLITE3)
+  //SQLite3 only prepares the first statement and keeps its text, which tells where the next one starts
+  multi->stmt = cdba_prep_create(multi->db, sql, 0);
+  if (multi->stmt && !multi->stmt->sqlite3_prepstat) {
+    //only comments are left
+    cdba_prep_close(multi->stmt);
+    multi->stmt = NULL;
+    return 0;
+  }
+  len = (multi->stmt ? strlen(sqlite3_sql(multi->stmt->sqlite3_prepstat)) : strlen(sql));
+#else
+  char c;
+  len = cdba_sql_statement_length(sql);
+  c = sql[len];
+  sql[len] = 0;
+  multi->stmt = cdba_prep_create(multi->db, sql, 0);
+  sql[len] = c;
+#endif
+  multi->sqlnext = sql + len;
+  if (!multi->stmt) {
+    cdba_multi_set_error(multi, multi->db->errmsg);
+    return 1;
   }
-#elif defined(DB_ODBC)
-  SQLRETURN odbcstatus;
-  //bind arguments
-  for (i = 0; i < stmt->numargs; i++) {
-    type = va_arg(argp, int);
-    switch (type) {
-      case CDBA_TYPE_NULL :
-        stmt->odbc_bind_len[i] = SQL_NULL_DATA;
-        odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_LONGVARCHAR, 1, 1, NULL, 0, &stmt->odbc_bind_len[i]);
-        break;
-      case CDBA_TYPE_INT :
-        {
-          //SQLBIGINT val = va_arg(argp, db_int);
-          SQLINTEGER val = va_arg(argp, db_int);
-          //stmt->odbc_bind_len[i] = sizeof(val);
-          //odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_SBIGINT, SQL_BIGINT, 0, 0, &val, 0, NULL);
-          odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &val, 0, NULL);
-        }
-        break;
-      case CDBA_TYPE_FLOAT :
-        {
-          SQLDOUBLE val = va_arg(argp, db_flt);
-          //stmt->odbc_bind_len[i] = sizeof(val);
-          odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, &val, 0, NULL);
-        }
-        break;
-      case CDBA_TYPE_TEXT :
-        {
-          SQLCHAR* val = va_arg(argp, char*);
-          stmt->odbc_bind_len[i] = (val ? SQL_NTS : SQL_NULL_DATA);
-          odbcstatus = SQLBindParameter(stmt->odbc_prepstat, i + 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_LONGVARCHAR, 12, 12, (val ? val : NULL), (val ? strlen(val) : 0), &stmt->odbc_bind_len[i]);
-        }
-        break;
-      default :
-        cdba_prep_set_error(stmt, "Unknown database type");
-        va_end(argp);
-        return -1;
+#if defined(DB_SQLITE3)
+  //sqlite3_changes() isn't updated by statements other than INSERT, UPDATE and DELETE, so check if the statement changed anything first
+  uint64_t changes = cdba_stats_total_changes(multi->db);
+#endif
+  if (cdba_prep_execute_bound(multi->stmt) != 0) {
+    cdba_multi_set_error(multi, multi->stmt->errmsg);
+    return 1;
+  }
+  if (multi->stmt->numcols == 0) {
+#if defined(DB_SQLITE3)
+    //the total also counts rows changed by triggers
+    multi->rowsaffected = (cdba_stats_total_changes(multi->db) != changes ? cdba_prep_get_rows_affected(multi->stmt) : 0);
+#else
+    multi->rowsaffected = cdba_prep_get_rows_affected(multi->stmt);
+#endif
+  }
+  return 1;
+}
+#endif
+
+DLL_EXPORT_CDBALIB int cdba_multi_next_result (cdba_multi_handle multi)
+{
+#if defined(DB_MYSQL)
+  int status;
+  MYSQL* conn = multi->db->mysql_conn;
+  if (multi->state == CDBA_MULTI_STATE_START) {
+    multi->state = CDBA_MULTI_STATE_RESULT;
+    //the error of the first statement was already reported by mysql_real_query()
+    if (multi->status != 0) {
+      multi->state = CDBA_MULTI_STATE_DONE;
+      return 1;
+    }
+  } else {
+    if (multi->state == CDBA_MULTI_STATE_DONE)
+      return 0;
+    //discard rows not fetched
+    mysql_free_result(multi->mysql_result);
+    multi->mysql_result = NULL;
+    multi->rowview.mysql_row = NULL;
+    multi->rowview.mysql_numfields = 0;
+    multi->rowsaffected = 0;
+    if ((status = mysql_next_result(conn)) < 0) {
+      multi->state = CDBA_MULTI_STATE_DONE;
+      return 0;
+    }
+    if (status > 0) {
+      cdba_stats_record_execute(multi->db, NULL, 0, 0, 1, 0, 0);
+      cdba_multi_set_error(multi, mysql_error(conn));
+      return 1;
     }
   }
-  odbcstatus = SQLExecute(stmt->odbc_prepstat);
-  if (odbcstatus != SQL_SUCCESS && odbcstatus != SQL_SUCCESS_WITH_INFO) {
-    cdba_set_odbc_error(stmt->db, stmt->odbc_prepstat, SQL_HANDLE_STMT);
-    /////cdba_set_odbc_error(NULL, stmt->odbc_prepstat, SQL_HANDLE_STMT);
-    va_end(argp);
-    return -2;
+  if ((multi->mysql_result = mysql_use_result(conn)) != NULL) {
+    multi->rowview.mysql_fields = mysql_fetch_fields(multi->mysql_result);
+    multi->rowview.mysql_numfields = mysql_num_fields(multi->mysql_result);
+  } else if (mysql_field_count(conn) == 0) {
+    multi->rowsaffected = mysql_affected_rows(conn);
+    cdba_stats_record_execute(multi->db, NULL, 0, 0, 0, multi->rowsaffected, 0);
+  } else {
+    cdba_multi_set_error(multi, mysql_error(conn));
   }
-  status = odbcstatus;
+  return 1;
 #else
+  if (multi->state == CDBA_MULTI_STATE_DONE)
+    return 0;
+  if (multi->stmt) {
+    cdba_prep_close(multi->stmt);
+    multi->stmt = NULL;
+  }
+  multi->rowsaffected = 0;
+  if (!cdba_multi_execute_next(multi)) {
+    multi->state = CDBA_MULTI_STATE_DONE;
+    return 0;
+  }
+  if (multi->status == 0)
+    multi->state = CDBA_MULTI_STATE_RESULT;
+  return 1;
 #endif
-  va_end(argp);
-  return status;
 }
 
-DLL_EXPORT_CDBALIB db_int cdba_prep_get_rows_affected (cdba_prep_handle stmt)
+DLL_EXPORT_CDBALIB int cdba_multi_get_status (cdba_multi_handle multi)
+{
+  return multi->status;
+}
+
+DLL_EXPORT_CDBALIB const char* cdba_multi_get_error (cdba_multi_handle multi)
+{
+  return multi->errmsg;
+}
+
+DLL_EXPORT_CDBALIB int cdba_multi_get_column_count (cdba_multi_handle multi)
 {
 #if defined(DB_MYSQL)
-  return mysql_stmt_affected_rows(stmt->mysql_prepstat);
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  return sqlite3_changes(sqlite3_db_handle(stmt->sqlite3_prepstat));
-#elif defined(DB_ODBC)
-  SQLLEN rows = 0;
-  SQLRowCount(stmt->odbc_prepstat, &rows);
-  return (db_int)rows;
+  return multi->rowview.mysql_numfields;
 #else
+  return (multi->stmt && multi->status == 0 ? multi->stmt->numcols : 0);
 #endif
 }
 
-DLL_EXPORT_CDBALIB db_int cdba_prep_get_insert_id (cdba_prep_handle stmt)
+DLL_EXPORT_CDBALIB const char* cdba_multi_get_column_name (cdba_multi_handle multi, int col)
 {
+  if (col < 0 || col >= cdba_multi_get_column_count(multi))
+    return NULL;
 #if defined(DB_MYSQL)
-  return mysql_stmt_insert_id(stmt->mysql_prepstat);
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  return sqlite3_last_insert_rowid(sqlite3_db_handle(stmt->sqlite3_prepstat));
-#elif defined(DB_ODBC)
+  return multi->rowview.mysql_fields[col].name;
 #else
+  return cdba_prep_get_column_name_ref(multi->stmt, col, NULL);
 #endif
 }
 
-DLL_EXPORT_CDBALIB int cdba_prep_fetch_row (cdba_prep_handle stmt)
+DLL_EXPORT_CDBALIB db_int cdba_multi_get_rows_affected (cdba_multi_handle multi)
+{
+  return multi->rowsaffected;
+}
+
+DLL_EXPORT_CDBALIB int cdba_multi_fetch_row (cdba_multi_handle multi)
 {
+  if (multi->state != CDBA_MULTI_STATE_RESULT || cdba_multi_get_column_count(multi) == 0)
+    return 0;
 #if defined(DB_MYSQL)
-  int status;
-	status = mysql_stmt_fetch(stmt->mysql_prepstat);
-	if (status == 0 || status == MYSQL_DATA_TRUNCATED)
-    return 1;
-  return (status == MYSQL_NO_DATA ? 0 : -1);
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  int status;
-  int i;
-  if (stmt->sqlite3_first_step_status != -1) {
-    status = stmt->sqlite3_first_step_status;
-    stmt->sqlite3_first_step_status = -1;
-  } else {
-    status = SQLITE_ERROR;
-    i = 0;
-    while (i++ < RETRY_ATTEMPTS && ((status = sqlite3_step(stmt->sqlite3_prepstat)) == SQLITE_BUSY || status == SQLITE_LOCKED)) {
-      WAIT_BEFORE_RETRY(RETRY_WAIT_TIME)
+  uint64_t start = CDBA_STATS_START(multi->db);
+  if ((multi->rowview.mysql_row = mysql_fetch_row(multi->mysql_result)) == NULL) {
+    if (mysql_errno(multi->db->mysql_conn) != 0) {
+      cdba_stats_record_fetch(multi->db, NULL, start, 0, 1, 0);
+      cdba_multi_set_error(multi, mysql_error(multi->db->mysql_conn));
+      return -1;
     }
+    return 0;
   }
-  if (status == SQLITE_ROW)
-    return 1;
-  return (status == SQLITE_DONE || status == SQLITE_OK ? 0 : -1);
-#elif defined(DB_ODBC)
-  SQLRETURN status;
-  status = SQLFetch(stmt->odbc_prepstat);
-  return (status == SQL_SUCCESS || status == SQL_SUCCESS_WITH_INFO ? 1 : 0);
+  multi->rowview.mysql_lengths = mysql_fetch_lengths(multi->mysql_result);
+  cdba_stats_record_fetch(multi->db, NULL, start, 1, 0, 0);
+  return 1;
 #else
+  int status;
+  if ((status = cdba_prep_fetch_row(multi->stmt)) < 0) {
+    cdba_multi_set_error(multi, multi->stmt->errmsg);
+    return -1;
+  }
+  return status;
 #endif
 }
 
-DLL_EXPORT_CDBALIB int cdba_prep_get_column_count (cdba_prep_handle stmt)
+DLL_EXPORT_CDBALIB cdba_row cdba_multi_get_row (cdba_multi_handle multi)
 {
-  return stmt->numcols;
+#if defined(DB_MYSQL)
+  return &multi->rowview;
+#else
+  return (multi->stmt ? &multi->stmt->rowview : NULL);
+#endif
 }
 
-DLL_EXPORT_CDBALIB db_int cdba_prep_get_column_type (cdba_prep_handle stmt, int col)
+DLL_EXPORT_CDBALIB void cdba_multi_close (cdba_multi_handle multi)
 {
+  if (!multi)
+    return;
 #if defined(DB_MYSQL)
-  switch (stmt->mysql_result_metadata->fields[col].type) {
-    case MYSQL_TYPE_NULL :
-      return CDBA_TYPE_NULL;
-    case MYSQL_TYPE_BIT :
-#ifdef MYSQL_TYPE_BOOL
-    case MYSQL_TYPE_BOOL :
+  //the results of all statements must be read before the connection can be used again
+  if (multi->state != CDBA_MULTI_STATE_DONE && multi->status == 0) {
+    if (multi->state == CDBA_MULTI_STATE_START)
+      multi->mysql_result = mysql_use_result(multi->db->mysql_conn);
+    mysql_free_result(multi->mysql_result);
+    multi->mysql_result = NULL;
+    while (mysql_next_result(multi->db->mysql_conn) == 0)
+      mysql_free_result(mysql_use_result(multi->db->mysql_conn));
+  }
+  mysql_free_result(multi->mysql_result);
+#else
+  if (multi->stmt)
+    cdba_prep_close(multi->stmt);
+  free(multi->sql);
 #endif
-    case MYSQL_TYPE_DECIMAL :
-    case MYSQL_TYPE_NEWDECIMAL :
-    case MYSQL_TYPE_TINY :
-    case MYSQL_TYPE_SHORT :
-    case MYSQL_TYPE_INT24 :
-    case MYSQL_TYPE_LONG :
-    case MYSQL_TYPE_LONGLONG :
-    case MYSQL_TYPE_TIMESTAMP :
-    case MYSQL_TYPE_TIMESTAMP2 :
-    case MYSQL_TYPE_DATE :
-    case MYSQL_TYPE_TIME :
-    case MYSQL_TYPE_DATETIME :
-    case MYSQL_TYPE_YEAR :
-      return CDBA_TYPE_INT;
-    case MYSQL_TYPE_FLOAT :
-    case MYSQL_TYPE_DOUBLE :
-      return CDBA_TYPE_FLOAT;
-    case MYSQL_TYPE_VARCHAR :
-    case MYSQL_TYPE_VAR_STRING :
-    case MYSQL_TYPE_STRING :
-    case MYSQL_TYPE_TINY_BLOB :
-    case MYSQL_TYPE_MEDIUM_BLOB :
-    case MYSQL_TYPE_LONG_BLOB :
-    case MYSQL_TYPE_BLOB :
-      return CDBA_TYPE_TEXT;
-      //return CDBA_TYPE_BLOB;
-    default :
-      return CDBA_TYPE_NULL;
+  free(multi->errmsg);
+  free(multi);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+//get column number of a mapping entry, returns -1 and sets the statement error if the column doesn't exist
+static int cdba_prep_mapping_column (cdba_prep_handle stmt, const cdba_field_mapping* field)
+{
+  int col;
+  if (field->name) {
+    if ((col = cdba_prep_get_column_index(stmt, field->name)) < 0)
+      cdba_prep_set_error(stmt, "Unknown column in mapping");
+    return col;
   }
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  int type;
-  type = sqlite3_column_type(stmt->sqlite3_prepstat, col);
-  switch (type) {
-    case SQLITE_NULL :
-      return CDBA_TYPE_NULL;
-    case SQLITE_INTEGER :
-      return CDBA_TYPE_INT;
-    case SQLITE_FLOAT :
-      return CDBA_TYPE_FLOAT;
-    case SQLITE_TEXT :
-      return CDBA_TYPE_TEXT;
-/*
-    case SQLITE_BLOB :
-      return CDBA_TYPE_BLOB;
-*/
-    default :
-      return CDBA_TYPE_NULL;
+  if (field->col < 0 || field->col >= stmt->numcols) {
+    cdba_prep_set_error(stmt, "Invalid column number in mapping");
+    return -1;
   }
-#elif defined(DB_ODBC)
-  SQLRETURN status;
-  SQLSMALLINT type;
-  status = SQLDescribeCol(stmt->odbc_prepstat, col + 1, NULL, 0, NULL, &type, NULL, NULL, NULL);
-  if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO)
-    return CDBA_TYPE_NULL;
-  switch (type) {
-    case SQL_DECIMAL :
-    case SQL_SMALLINT :
-    case SQL_INTEGER :
-    case SQL_BIT :
-    case SQL_TINYINT :
-    case SQL_BIGINT :
-      return CDBA_TYPE_INT;
-    case SQL_NUMERIC :
-    case SQL_REAL :
-    case SQL_FLOAT :
-    case SQL_DOUBLE :
-      return CDBA_TYPE_FLOAT;
-    case SQL_CHAR :
-    case SQL_VARCHAR :
-    case SQL_LONGVARCHAR :
-      return CDBA_TYPE_TEXT;
-/*
-    case SQL_BINARY :
-    case SQL_VARBINARY :
-    case SQL_LONGVARBINARY :
-      return CDBA_TYPE_BLOB;
-*/
-/*
-    case SQL_TYPE_TIME :
-    case SQL_TYPE_TIMESTAMP :
-    case SQL_TYPE_UTCDATETIME :
-    case SQL_TYPE_UTCTIME :
-*/
-/*
-    case SQL_WCHAR :
-    case SQL_WVARCHAR :
-    case SQL_WLONGVARCHAR :
-*/
-    default :
-      return CDBA_TYPE_NULL;
+  return field->col;
+}
+
+//copy the values of the current row into the struct members described by the mapping
+static int cdba_prep_row_into (cdba_prep_handle stmt, void* data, const cdba_field_mapping* mapping)
+{
+  const cdba_field_mapping* field;
+  const char* value;
+  size_t len;
+  int col;
+  for (field = mapping; field->type != CDBA_TYPE_NULL; field++) {
+    if ((col = cdba_prep_mapping_column(stmt, field)) < 0)
+      return -1;
+    switch (field->type) {
+      case CDBA_TYPE_INT :
+        *(db_int*)((char*)data + field->offset) = cdba_row_get_int(&stmt->rowview, col);
+        break;
+      case CDBA_TYPE_FLOAT :
+        *(db_flt*)((char*)data + field->offset) = cdba_row_get_float(&stmt->rowview, col);
+        break;
+      case CDBA_TYPE_TEXT :
+        value = cdba_row_get_text(&stmt->rowview, col, &len);
+        if (field->size == 0) {
+          //pointer member referencing the value kept by the prepared statement
+          *(const char**)((char*)data + field->offset) = value;
+        } else {
+          //character array member, NULL values are stored as empty strings and long values are truncated
+          if (!value)
+            len = 0;
+          else if (len >= field->size)
+            len = field->size - 1;
+          if (len > 0)
+            memcpy((char*)data + field->offset, value, len);
+          ((char*)data + field->offset)[len] = 0;
+        }
+        break;
+      default :
+        cdba_prep_set_error(stmt, "Unsupported type in mapping");
+        return -1;
+    }
   }
-#else
-#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_into (cdba_prep_handle stmt, void* data, const cdba_field_mapping* mapping)
+{
+  int status;
+  if ((status = cdba_prep_fetch_row(stmt)) <= 0)
+    return status;
+  if (cdba_prep_row_into(stmt, data, mapping) != 0)
+    return -1;
+  return status;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_fetch_into_array (cdba_prep_handle stmt, void* data, size_t rowsize, size_t maxrows, const cdba_field_mapping* mapping)
+{
+  size_t rows = 0;
+  int status = 0;
+  while (rows < maxrows && (status = cdba_prep_fetch_row(stmt)) > 0) {
+    if (cdba_prep_row_into(stmt, (char*)data + rows * rowsize, mapping) != 0)
+      return -1;
+    rows++;
+  }
+  if (rows < maxrows && status < 0)
+    return -1;
+  return rows;
+}
+
+DLL_EXPORT_CDBALIB int cdba_prep_execute_from (cdba_prep_handle stmt, const void* data, const cdba_field_mapping* mapping)
+{
+  const cdba_field_mapping* field;
+  const char* value;
+  int status;
+  for (field = mapping; field->type != CDBA_TYPE_NULL; field++) {
+    if (field->name) {
+      cdba_prep_set_error(stmt, "Arguments can only be mapped by number");
+      return -1;
+    }
+    switch (field->type) {
+      case CDBA_TYPE_INT :
+        status = cdba_prep_bind_int(stmt, field->col, *(const db_int*)((const char*)data + field->offset));
+        break;
+      case CDBA_TYPE_FLOAT :
+        status = cdba_prep_bind_float(stmt, field->col, *(const db_flt*)((const char*)data + field->offset));
+        break;
+      case CDBA_TYPE_TEXT :
+        if (field->size == 0) {
+          value = *(const char* const*)((const char*)data + field->offset);
+          status = cdba_prep_bind_text(stmt, field->col, value, CDBA_NTS);
+        } else {
+          //character array member, which is not required to be zero-terminated when completely filled
+          const char* end;
+          value = (const char*)data + field->offset;
+          end = (const char*)memchr(value, 0, field->size);
+          status = cdba_prep_bind_text(stmt, field->col, value, (end ? (size_t)(end - value) : field->size));
+        }
+        break;
+      default :
+        cdba_prep_set_error(stmt, "Unsupported type in mapping");
+        return -1;
+    }
+    if (status != 0)
+      return -1;
+  }
+  return cdba_prep_execute_bound(stmt);
 }
 
-DLL_EXPORT_CDBALIB char* cdba_prep_get_column_name (cdba_prep_handle stmt, int col)
+////////////////////////////////////////////////////////////////////////
+
+//loading methods reported in the bulk loader statistics
+#define CDBA_BULK_METHOD_LOAD_DATA "load data local infile"
+#define CDBA_BULK_METHOD_MULTI_ROW "multi-row insert"
+#define CDBA_BULK_METHOD_ARRAY     "array insert"
+
+//file name passed to LOAD DATA LOCAL INFILE for the rows of a bulk loader
+#define CDBA_MYSQL_BULK_FILENAME "cdba_bulk_load"
+
+//maximum number of arguments of a SQLite3 statement (limit of older versions)
+#define CDBA_SQLITE3_MAX_VARIABLES 999
+
+struct cdba_bulk_column_struct {
+  db_int type;
+  void* values;                                 //db_int or db_flt for each row, or pointer to text and binary values (set when sending)
+  size_t* textpos;                              //position of text and binary values in the text buffer
+  size_t* lengths;                              //length of text and binary values
+  char* nulls;                                  //non-zero for NULL values
+};
+
+struct cdba_bulk_load_handle_struct {
+#ifdef CDBA_DRIVER
+  const struct cdba_driver_struct* driver;   //must be the first member
+#endif
+  cdba_handle db;
+  char* table;
+  char* columnlist;                             //column names separated by commas
+  int numcols;
+  struct cdba_bulk_column_struct* columns;
+  cdba_param_column* params;                    //columns passed to cdba_prep_execute_batch()
+  size_t allocrows;                             //number of rows the column arrays have room for
+  size_t chunkrows;
+  int commit;
+  size_t rows;                                  //number of rows buffered
+  char* text;                                   //text and binary values of the buffered rows
+  size_t textsize;
+  size_t textlen;
+  cdba_prep_handle stmt;                        //single row INSERT statement
+  cdba_bulk_stats stats;
+  uint64_t start;
+#if defined(DB_MYSQL)
+  int mysql_infile;                             //zero when LOAD DATA LOCAL INFILE is not allowed
+  char* mysql_data;                             //buffered rows as tab separated text
+  size_t mysql_datasize;
+  size_t mysql_datalen;
+  size_t mysql_datapos;
+#elif defined(DB_SQLITE3)
+  cdba_prep_handle sqlite3_multistmt;           //multi-row INSERT statement
+  size_t sqlite3_multirows;                     //number of rows inserted by sqlite3_multistmt
+#endif
+};
+
+static void cdba_bulk_load_free (cdba_bulk_handle bulk)
 {
+  int i;
+  if (bulk->columns) {
+    for (i = 0; i < bulk->numcols; i++) {
+      free(bulk->columns[i].values);
+      free(bulk->columns[i].textpos);
+      free(bulk->columns[i].lengths);
+      free(bulk->columns[i].nulls);
+    }
+    free(bulk->columns);
+  }
+  if (bulk->stmt)
+    cdba_prep_close(bulk->stmt);
 #if defined(DB_MYSQL)
-  const char* colname = stmt->mysql_result_metadata->fields[col].name;
-  return (colname ? strdup(colname) : NULL);
-#elif defined(DB_FREETDS)
+  free(bulk->mysql_data);
 #elif defined(DB_SQLITE3)
-  const char* colname = sqlite3_column_name(stmt->sqlite3_prepstat, col);
-  return (colname ? strdup(colname) : NULL);
-#elif defined(DB_ODBC)
-  SQLRETURN status;
-  SQLCHAR* colname;
-  SQLSMALLINT colnamelen;
-  colnamelen = 0;
-  status = SQLDescribeCol(stmt->odbc_prepstat, col + 1, NULL, 0, &colnamelen, NULL, NULL, NULL, NULL);
-  if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO)
-    return NULL;
-  if ((colname = (SQLCHAR*)malloc(sizeof(SQLCHAR) * ++colnamelen)) == NULL)
-    return NULL;
-  status = SQLDescribeCol(stmt->odbc_prepstat, col + 1, colname, colnamelen, &colnamelen, NULL, NULL, NULL, NULL);
-  if (status != SQL_SUCCESS && status != SQL_SUCCESS_WITH_INFO) {
-    free(colname);
+  if (bulk->sqlite3_multistmt)
+    cdba_prep_close(bulk->sqlite3_multistmt);
+#endif
+  free(bulk->params);
+  free(bulk->text);
+  free(bulk->table);
+  free(bulk->columnlist);
+  free(bulk);
+}
+
+//make sure the column arrays have room for the given number of rows
+static int cdba_bulk_load_reserve (cdba_bulk_handle bulk, size_t rows)
+{
+  struct cdba_bulk_column_struct* column;
+  void* p;
+  int i;
+  if (rows <= bulk->allocrows)
+    return 0;
+  for (i = 0; i < bulk->numcols; i++) {
+    column = &bulk->columns[i];
+    if ((p = realloc(column->values, rows * (column->type == CDBA_TYPE_INT ? sizeof(db_int) : (column->type == CDBA_TYPE_FLOAT ? sizeof(db_flt) : sizeof(const char*))))) == NULL)
+      break;
+    column->values = p;
+    if ((p = realloc(column->nulls, rows)) == NULL)
+      break;
+    column->nulls = (char*)p;
+    if (column->type == CDBA_TYPE_TEXT || column->type == CDBA_TYPE_BLOB) {
+      if ((p = realloc(column->textpos, rows * sizeof(size_t))) == NULL)
+        break;
+      column->textpos = (size_t*)p;
+      if ((p = realloc(column->lengths, rows * sizeof(size_t))) == NULL)
+        break;
+      column->lengths = (size_t*)p;
+    }
+  }
+  if (i < bulk->numcols) {
+    cdba_set_error(bulk->db, "Memory allocation error");
+    return -1;
+  }
+  bulk->allocrows = rows;
+  return 0;
+}
+
+//copy a text or binary value of the row being appended into the text buffer
+static int cdba_bulk_load_store_text (cdba_bulk_handle bulk, struct cdba_bulk_column_struct* column, const char* value, size_t len)
+{
+  char* text;
+  size_t size;
+  if (bulk->textlen + len > bulk->textsize) {
+    size = (bulk->textsize > 0 ? bulk->textsize : 4096);
+    while (size < bulk->textlen + len)
+      size *= 2;
+    if ((text = (char*)realloc(bulk->text, size)) == NULL) {
+      cdba_set_error(bulk->db, "Memory allocation error");
+      return -1;
+    }
+    bulk->text = text;
+    bulk->textsize = size;
+  }
+  if (len > 0)
+    memcpy(bulk->text + bulk->textlen, value, len);
+  column->textpos[bulk->rows] = bulk->textlen;
+  column->lengths[bulk->rows] = len;
+  bulk->textlen += len;
+  return 0;
+}
+
+//prepare an INSERT statement for the given number of rows
+static cdba_prep_handle cdba_bulk_load_prepare_insert (cdba_bulk_handle bulk, size_t rows)
+{
+  cdba_prep_handle stmt;
+  char* sql;
+  char* p;
+  size_t row;
+  int i;
+  if ((sql = (char*)malloc(strlen(bulk->table) + strlen(bulk->columnlist) + 24 + rows * (bulk->numcols * 2 + 2))) == NULL) {
+    cdba_set_error(bulk->db, "Memory allocation error");
     return NULL;
   }
-  return colname;
-#else
-  return NULL;
-#endif
-  return NULL;
+  p = sql + sprintf(sql, "INSERT INTO %s (%s) VALUES ", bulk->table, bulk->columnlist);
+  for (row = 0; row < rows; row++) {
+    if (row > 0)
+      *p++ = ',';
+    *p++ = '(';
+    for (i = 0; i < bulk->numcols; i++) {
+      if (i > 0)
+        *p++ = ',';
+      *p++ = '?';
+    }
+    *p++ = ')';
+  }
+  *p = 0;
+  stmt = cdba_create_preparedstatement(bulk->db, sql);
+  free(sql);
+  return stmt;
 }
 
-DLL_EXPORT_CDBALIB db_int cdba_prep_get_column_int (cdba_prep_handle stmt, int col)
+//insert buffered rows with a single row INSERT statement executed for multiple rows at once
+static int cdba_bulk_load_send_batch (cdba_bulk_handle bulk, size_t first, size_t rows)
 {
+  struct cdba_bulk_column_struct* column;
+  size_t size;
+  int i;
+  if (!bulk->stmt && (bulk->stmt = cdba_bulk_load_prepare_insert(bulk, 1)) == NULL)
+    return -1;
+  for (i = 0; i < bulk->numcols; i++) {
+    column = &bulk->columns[i];
+    size = (column->type == CDBA_TYPE_INT ? sizeof(db_int) : (column->type == CDBA_TYPE_FLOAT ? sizeof(db_flt) : sizeof(const char*)));
+    bulk->params[i].type = column->type;
+    bulk->params[i].values = (const char*)column->values + first * size;
+    bulk->params[i].lengths = (column->lengths ? column->lengths + first : NULL);
+    bulk->params[i].nulls = column->nulls + first;
+  }
+  if (cdba_prep_execute_batch(bulk->stmt, rows, bulk->params, NULL, NULL, NULL) != 0) {
+    if (cdba_prep_get_error(bulk->stmt))
+      cdba_set_error(bulk->db, cdba_prep_get_error(bulk->stmt));
+    return -1;
+  }
+  return 0;
+}
+
 #if defined(DB_MYSQL)
-  MYSQL_BIND bindarg;
-  long long result = 0;
-  memset(&bindarg, 0, sizeof(MYSQL_BIND));
-  bindarg.buffer_type = MYSQL_TYPE_LONGLONG;
-  bindarg.buffer = &result;
-  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &bindarg, col, 0) != 0)
-    return 0;
-  return result;
-#elif defined(DB_FREETDS)
+static int cdba_mysql_local_infile_init (void** ptr, const char* filename, void* userdata)
+{
+  cdba_handle db = (cdba_handle)userdata;
+  *ptr = db;
+  //only the rows of a bulk load in progress are served, local files are never read
+  if (!db->mysql_bulk || strcmp(filename, CDBA_MYSQL_BULK_FILENAME) != 0)
+    return 1;
+  db->mysql_bulk->mysql_datapos = 0;
+  return 0;
+}
+
+static int cdba_mysql_local_infile_read (void* ptr, char* buf, unsigned int buflen)
+{
+  struct cdba_bulk_load_handle_struct* bulk = ((cdba_handle)ptr)->mysql_bulk;
+  size_t n;
+  if (!bulk)
+    return -1;
+  n = bulk->mysql_datalen - bulk->mysql_datapos;
+  if (n > buflen)
+    n = buflen;
+  memcpy(buf, bulk->mysql_data + bulk->mysql_datapos, n);
+  bulk->mysql_datapos += n;
+  return (int)n;
+}
+
+static void cdba_mysql_local_infile_end (void* ptr)
+{
+  (void)ptr;
+}
+
+static int cdba_mysql_local_infile_error (void* ptr, char* errmsg, unsigned int errmsglen)
+{
+  (void)ptr;
+  snprintf(errmsg, errmsglen, "Loading local files is not allowed");
+  return 2000;      //CR_UNKNOWN_ERROR
+}
+
+static void cdba_mysql_set_local_infile_handler (cdba_handle db)
+{
+  mysql_set_local_infile_handler(db->mysql_conn, cdba_mysql_local_infile_init, cdba_mysql_local_infile_read, cdba_mysql_local_infile_end, cdba_mysql_local_infile_error, db);
+}
+
+//convert the buffered rows to the default LOAD DATA format: tab separated fields, one row per line, \N for NULL and special characters escaped with a backslash
+static int cdba_bulk_load_mysql_format (cdba_bulk_handle bulk)
+{
+  struct cdba_bulk_column_struct* column;
+  const char* text;
+  const char* end;
+  char* data;
+  char* p;
+  size_t size;
+  size_t row;
+  int i;
+  //escaped values take at most twice their length, numbers at most 32 characters and the separators one character each
+  size = bulk->textlen * 2 + bulk->rows * bulk->numcols * 33 + 1;
+  if (size > bulk->mysql_datasize) {
+    if ((data = (char*)realloc(bulk->mysql_data, size)) == NULL) {
+      cdba_set_error(bulk->db, "Memory allocation error");
+      return -1;
+    }
+    bulk->mysql_data = data;
+    bulk->mysql_datasize = size;
+  }
+  p = bulk->mysql_data;
+  for (row = 0; row < bulk->rows; row++) {
+    for (i = 0; i < bulk->numcols; i++) {
+      column = &bulk->columns[i];
+      if (i > 0)
+        *p++ = '\t';
+      if (column->nulls[row]) {
+        *p++ = '\\';
+        *p++ = 'N';
+        continue;
+      }
+      switch (column->type) {
+        case CDBA_TYPE_INT :
+          p += sprintf(p, "%lld", (long long)((db_int*)column->values)[row]);
+          break;
+        case CDBA_TYPE_FLOAT :
+          p += sprintf(p, "%.17g", (double)((db_flt*)column->values)[row]);
+          break;
+        default :
+          text = bulk->text + column->textpos[row];
+          end = text + column->lengths[row];
+          for (; text < end; text++) {
+            switch (*text) {
+              case '\\' : *p++ = '\\'; *p++ = '\\'; break;
+              case '\t' : *p++ = '\\'; *p++ = 't'; break;
+              case '\n' : *p++ = '\\'; *p++ = 'n'; break;
+              case '\r' : *p++ = '\\'; *p++ = 'r'; break;
+              case 0    : *p++ = '\\'; *p++ = '0'; break;
+              default   : *p++ = *text; break;
+            }
+          }
+          break;
+      }
+    }
+    *p++ = '\n';
+  }
+  bulk->mysql_datalen = p - bulk->mysql_data;
+  return 0;
+}
+
+static int cdba_bulk_load_mysql_send (cdba_bulk_handle bulk)
+{
+  char* sql;
+  int status;
+  unsigned int err;
+  if (bulk->mysql_infile) {
+    if (cdba_bulk_load_mysql_format(bulk) != 0)
+      return -1;
+    if ((sql = (char*)malloc(strlen(bulk->table) + strlen(bulk->columnlist) + strlen(CDBA_MYSQL_BULK_FILENAME) + 64)) == NULL) {
+      cdba_set_error(bulk->db, "Memory allocation error");
+      return -1;
+    }
+    //binary character set: values are loaded without conversion
+    sprintf(sql, "LOAD DATA LOCAL INFILE '" CDBA_MYSQL_BULK_FILENAME "' INTO TABLE %s CHARACTER SET binary (%s)", bulk->table, bulk->columnlist);
+    bulk->db->mysql_bulk = bulk;
+    status = cdba_sql(bulk->db, sql);
+    bulk->db->mysql_bulk = NULL;
+    free(sql);
+    if (status == 0) {
+      bulk->stats.method = CDBA_BULK_METHOD_LOAD_DATA;
+      return 0;
+    }
+    //fall back to batch execution when the client or the server doesn't allow loading local data (ER_NOT_ALLOWED_COMMAND, CR_LOAD_DATA_LOCAL_INFILE_REJECTED, ER_CLIENT_LOCAL_FILES_DISABLED)
+    err = mysql_errno(bulk->db->mysql_conn);
+    if (err != 1148 && err != 2068 && err != 3948)
+      return -1;
+    bulk->mysql_infile = 0;
+  }
+  bulk->stats.method = CDBA_BULK_METHOD_ARRAY;
+  return cdba_bulk_load_send_batch(bulk, 0, bulk->rows);
+}
 #elif defined(DB_SQLITE3)
-  return sqlite3_column_int64(stmt->sqlite3_prepstat, col);
-#elif defined(DB_ODBC)
-  SQLLEN value_size;
-  SQLINTEGER value = -1;
-  if (SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_INTEGER, (SQLCHAR*)&value, (SQLLEN)sizeof(value), &value_size) == SQL_SUCCESS) {
-    if (value_size == SQL_NULL_DATA || value_size == SQL_NO_TOTAL)
-      value = 0;
+//insert the buffered rows with a multi-row INSERT statement, the rows that don't fill it are inserted one by one
+static int cdba_bulk_load_sqlite3_send (cdba_bulk_handle bulk)
+{
+  struct cdba_bulk_column_struct* column;
+  sqlite3_stmt* stmt;
+  size_t row = 0;
+  size_t r;
+  int arg;
+  int i;
+  int status;
+  uint64_t start;
+  uint64_t retries;
+  bulk->stats.method = CDBA_BULK_METHOD_MULTI_ROW;
+  if (bulk->sqlite3_multirows > 1 && bulk->rows >= bulk->sqlite3_multirows) {
+    if (!bulk->sqlite3_multistmt && (bulk->sqlite3_multistmt = cdba_bulk_load_prepare_insert(bulk, bulk->sqlite3_multirows)) == NULL)
+      return -1;
+    stmt = bulk->sqlite3_multistmt->sqlite3_prepstat;
+    for (; row + bulk->sqlite3_multirows <= bulk->rows; row += bulk->sqlite3_multirows) {
+      start = CDBA_STATS_START(bulk->db);
+      retries = bulk->db->busystats.retries;
+      sqlite3_reset(stmt);
+      arg = 1;
+      for (r = row; r < row + bulk->sqlite3_multirows; r++) {
+        for (i = 0; i < bulk->numcols; i++) {
+          column = &bulk->columns[i];
+          if (column->nulls[r])
+            sqlite3_bind_null(stmt, arg++);
+          else if (column->type == CDBA_TYPE_INT)
+            sqlite3_bind_int64(stmt, arg++, ((db_int*)column->values)[r]);
+          else if (column->type == CDBA_TYPE_FLOAT)
+            sqlite3_bind_double(stmt, arg++, ((db_flt*)column->values)[r]);
+          else if (column->type == CDBA_TYPE_TEXT)
+            sqlite3_bind_text(stmt, arg++, bulk->text + column->textpos[r], (int)column->lengths[r], SQLITE_STATIC);
+          else
+            sqlite3_bind_blob(stmt, arg++, bulk->text + column->textpos[r], (int)column->lengths[r], SQLITE_STATIC);
+        }
+      }
+      status = cdba_sqlite3_step(bulk->db, stmt);
+      cdba_stats_record_execute(bulk->db, &bulk->sqlite3_multistmt->stats, start, bulk->sqlite3_multirows, (status != SQLITE_DONE), (status == SQLITE_DONE ? (uint64_t)sqlite3_changes(bulk->db->sqlite3_conn) : 0), bulk->db->busystats.retries - retries);
+      if (status != SQLITE_DONE) {
+        cdba_set_error(bulk->db, sqlite3_errmsg(bulk->db->sqlite3_conn));
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        return -1;
+      }
+    }
+    //the bindings refer to the text buffer
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
   }
-  return value;
-#else
+  if (row < bulk->rows)
+    return cdba_bulk_load_send_batch(bulk, row, bulk->rows - row);
   return 0;
-#endif
 }
+#endif
 
-DLL_EXPORT_CDBALIB double cdba_prep_get_column_float (cdba_prep_handle stmt, int col)
+//send the buffered rows to the database as one chunk, the rows are discarded even when this fails
+static int cdba_bulk_load_send (cdba_bulk_handle bulk)
 {
-#if defined(DB_MYSQL)
-  MYSQL_BIND bindarg;
-  double result = 0;
-  memset(&bindarg, 0, sizeof(MYSQL_BIND));
-  bindarg.buffer_type = MYSQL_TYPE_DOUBLE;
-  bindarg.buffer = &result;
-  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &bindarg, col, 0) != 0)
+  struct cdba_bulk_column_struct* column;
+  size_t row;
+  int i;
+  int status;
+  if (bulk->rows == 0)
     return 0;
-  return result;
+  //text and binary values can be referenced now the text buffer doesn't move anymore
+  for (i = 0; i < bulk->numcols; i++) {
+    column = &bulk->columns[i];
+    if (column->type == CDBA_TYPE_TEXT || column->type == CDBA_TYPE_BLOB) {
+      for (row = 0; row < bulk->rows; row++)
+        ((const char**)column->values)[row] = (column->nulls[row] ? NULL : bulk->text + column->textpos[row]);
+    }
+  }
+  if (bulk->commit)
+    cdba_begin_transaction(bulk->db);
+#if defined(DB_MYSQL)
+  status = cdba_bulk_load_mysql_send(bulk);
 #elif defined(DB_FREETDS)
+  cdba_set_error(bulk->db, "Not supported");
+  status = -1;
 #elif defined(DB_SQLITE3)
-  return sqlite3_column_double(stmt->sqlite3_prepstat, col);
+  status = cdba_bulk_load_sqlite3_send(bulk);
 #elif defined(DB_ODBC)
-  SQLLEN value_size;
-  SQLDOUBLE value = -1;
-  if (SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_DOUBLE, (SQLCHAR*)&value, (SQLLEN)sizeof(value), &value_size) == SQL_SUCCESS) {
-    if (value_size == SQL_NULL_DATA || value_size == SQL_NO_TOTAL)
-      value = 0;
-  }
-  return value;
+  bulk->stats.method = CDBA_BULK_METHOD_ARRAY;
+  status = cdba_bulk_load_send_batch(bulk, 0, bulk->rows);
 #else
-  return 0;
+  status = -1;
 #endif
+  if (bulk->commit) {
+    if (status == 0)
+      cdba_commit_transaction(bulk->db);
+    else
+      cdba_rollback_transaction(bulk->db);
+  }
+  //some methods insert the rows without going through cdba_sql() or a prepared statement
+  cdba_result_cache_table_written(bulk->db, bulk->table);
+  if (status == 0) {
+    bulk->stats.rows += bulk->rows;
+    bulk->stats.chunks++;
+  }
+  bulk->rows = 0;
+  bulk->textlen = 0;
+  return status;
 }
 
-DLL_EXPORT_CDBALIB char* cdba_prep_get_column_text (cdba_prep_handle stmt, int col)
+DLL_EXPORT_CDBALIB cdba_bulk_handle cdba_bulk_load_open (cdba_handle db, const char* table, int numcolumns, const char* const* columns, const db_int* types)
 {
-  char* result = NULL;
-#if defined(DB_MYSQL)
-  MYSQL_BIND mysql_bind_var;
-  if (stmt->mysql_bind_result[col].buffer_type != MYSQL_TYPE_STRING)
-    return strdup("ERROR (not a string)");
-    //return NULL;
-  if (stmt->mysql_bind_vars[col].is_null || (result = (char*)malloc(stmt->mysql_bind_vars[col].length + 1)) == NULL)
-    return NULL;
-  memset(&mysql_bind_var, 0, sizeof(mysql_bind_var));
-  mysql_bind_var.buffer_type = MYSQL_TYPE_STRING;
-  mysql_bind_var.buffer = result;
-  mysql_bind_var.buffer_length = stmt->mysql_bind_vars[col].length + 1;
-  mysql_bind_var.length = &(stmt->mysql_bind_vars[col].length);
-  mysql_bind_var.is_null = &(stmt->mysql_bind_vars[col].is_null);
-  if (mysql_stmt_fetch_column(stmt->mysql_prepstat, &mysql_bind_var, col, 0) != 0) {
-    free(result);
+  struct cdba_bulk_load_handle_struct* bulk;
+  size_t len;
+  int i;
+  if (!table || !*table || numcolumns <= 0 || !columns || !types) {
+    cdba_set_error(db, "Missing table or columns");
     return NULL;
   }
-  //result[stmt->mysql_bind_vars[col].length] = 0;
-#elif defined(DB_FREETDS)
-#elif defined(DB_SQLITE3)
-  if ((result = (char*)sqlite3_column_text(stmt->sqlite3_prepstat, col)) != NULL)
-    result = strdup(result);
-#elif defined(DB_ODBC)
-#define STRING_ALLOCATE_INITIAL 256 *0+2
-#define STRING_ALLOCATE_STEP 2048
-  RETCODE status;
-  SQLLEN len;
-  status = SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_C_CHAR, (SQLCHAR*)&result, 0, &len);
-  if (status == SQL_SUCCESS) {
-    if (len == SQL_NULL_DATA) {
-      free(result);
-      return NULL;
-    }
-    return strdup("");
-  } else if (status == SQL_SUCCESS_WITH_INFO) {
-    if ((result = (char*)malloc(++len)) == NULL)
-      return NULL;
-    status = SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_C_CHAR, (SQLCHAR*)result, len, &len);
-    if (status != SQL_SUCCESS) {
-      free(result);
+  len = 0;
+  for (i = 0; i < numcolumns; i++) {
+    if (!columns[i] || !*columns[i] || (types[i] != CDBA_TYPE_INT && types[i] != CDBA_TYPE_FLOAT && types[i] != CDBA_TYPE_TEXT && types[i] != CDBA_TYPE_BLOB)) {
+      cdba_set_error(db, "Invalid column name or type");
       return NULL;
     }
-  } else {
-    free(result);
+    len += strlen(columns[i]) + 1;
+  }
+  if ((bulk = (struct cdba_bulk_load_handle_struct*)malloc(sizeof(struct cdba_bulk_load_handle_struct))) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
     return NULL;
   }
-/*
-  RETCODE status;
-  SQLLEN len;
-  int pos = 0;
-  if ((result = (char*)malloc(STRING_ALLOCATE_INITIAL)) == NULL) {
+  memset(bulk, 0, sizeof(struct cdba_bulk_load_handle_struct));
+#ifdef CDBA_DRIVER
+  bulk->driver = &CDBA_DRIVER_TABLE;
+#endif
+  bulk->db = db;
+  bulk->numcols = numcolumns;
+  bulk->commit = 1;
+  bulk->start = cdba_get_time_us();
+#if defined(DB_MYSQL)
+  bulk->mysql_infile = 1;
+  bulk->stats.method = CDBA_BULK_METHOD_LOAD_DATA;
+#elif defined(DB_SQLITE3)
+  bulk->sqlite3_multirows = CDBA_SQLITE3_MAX_VARIABLES / numcolumns;
+  if (bulk->sqlite3_multirows > CDBA_BULK_DEFAULT_CHUNK_ROWS)
+    bulk->sqlite3_multirows = CDBA_BULK_DEFAULT_CHUNK_ROWS;
+  bulk->stats.method = CDBA_BULK_METHOD_MULTI_ROW;
+#else
+  bulk->stats.method = CDBA_BULK_METHOD_ARRAY;
+#endif
+  if ((bulk->table = strdup(table)) == NULL || (bulk->columnlist = (char*)malloc(len)) == NULL || (bulk->columns = (struct cdba_bulk_column_struct*)malloc(sizeof(struct cdba_bulk_column_struct) * numcolumns)) == NULL || (bulk->params = (cdba_param_column*)malloc(sizeof(cdba_param_column) * numcolumns)) == NULL) {
+    cdba_set_error(db, "Memory allocation error");
+    cdba_bulk_load_free(bulk);
     return NULL;
   }
-  status = SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_C_CHAR, (SQLCHAR*)result, STRING_ALLOCATE_INITIAL, &len);
-  if (status == SQL_SUCCESS) {
-    if (len == SQL_NULL_DATA) {
-      free(result);
-      return NULL;
-    }
-  } else if (status == SQL_SUCCESS_WITH_INFO) {
-    do {
-      pos += (len != SQL_NO_TOTAL ? len : strlen(result + pos));
-      if ((result = (char*)realloc(result, pos + STRING_ALLOCATE_STEP)) == NULL) {
-        free(result);
-        return NULL;
-      }
-    } while ((status = SQLGetData(stmt->odbc_prepstat, (SQLUSMALLINT)(col + 1), SQL_C_CHAR, (SQLCHAR*)result + pos, STRING_ALLOCATE_STEP, &len)) == SQL_SUCCESS_WITH_INFO);
-  } else {
-    free(result);
+  memset(bulk->columns, 0, sizeof(struct cdba_bulk_column_struct) * numcolumns);
+  bulk->columnlist[0] = 0;
+  for (i = 0; i < numcolumns; i++) {
+    if (i > 0)
+      strcat(bulk->columnlist, ",");
+    strcat(bulk->columnlist, columns[i]);
+    bulk->columns[i].type = types[i];
+  }
+  if (cdba_bulk_load_reserve(bulk, CDBA_BULK_DEFAULT_CHUNK_ROWS) != 0) {
+    cdba_bulk_load_free(bulk);
     return NULL;
   }
-*/
-#else
+  bulk->chunkrows = CDBA_BULK_DEFAULT_CHUNK_ROWS;
+  return bulk;
+}
+
+DLL_EXPORT_CDBALIB int cdba_bulk_load_set_chunk_size (cdba_bulk_handle bulk, size_t rows, int commit)
+{
+#if defined(DB_SQLITE3)
+  size_t multirows;
 #endif
-  return result;
+  if (rows == 0)
+    rows = CDBA_BULK_DEFAULT_CHUNK_ROWS;
+  if (cdba_bulk_load_send(bulk) != 0)
+    return -1;
+  if (cdba_bulk_load_reserve(bulk, rows) != 0)
+    return -1;
+  bulk->chunkrows = rows;
+  bulk->commit = commit;
+#if defined(DB_SQLITE3)
+  //the multi-row statement never inserts more rows than a chunk contains
+  multirows = CDBA_SQLITE3_MAX_VARIABLES / bulk->numcols;
+  if (multirows > rows)
+    multirows = rows;
+  if (bulk->sqlite3_multirows != multirows) {
+    bulk->sqlite3_multirows = multirows;
+    if (bulk->sqlite3_multistmt) {
+      cdba_prep_close(bulk->sqlite3_multistmt);
+      bulk->sqlite3_multistmt = NULL;
+    }
+  }
+#endif
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_bulk_load_append_va (cdba_bulk_handle bulk, va_list argp)
+{
+  struct cdba_bulk_column_struct* column;
+  const char* value;
+  size_t len;
+  size_t textlen = bulk->textlen;
+  int type;
+  int i;
+  for (i = 0; i < bulk->numcols; i++) {
+    column = &bulk->columns[i];
+    type = va_arg(argp, int);
+    if (type != CDBA_TYPE_NULL && type != column->type) {
+      cdba_set_error(bulk->db, (type == CDBA_TYPE_INT || type == CDBA_TYPE_FLOAT || type == CDBA_TYPE_TEXT || type == CDBA_TYPE_BLOB ? "Argument type doesn't match column type" : "Unknown database type"));
+      bulk->textlen = textlen;
+      return -1;
+    }
+    column->nulls[bulk->rows] = 0;
+    switch (type) {
+      case CDBA_TYPE_INT :
+        ((db_int*)column->values)[bulk->rows] = va_arg(argp, db_int);
+        break;
+      case CDBA_TYPE_FLOAT :
+        ((db_flt*)column->values)[bulk->rows] = va_arg(argp, db_flt);
+        break;
+      case CDBA_TYPE_TEXT :
+      case CDBA_TYPE_BLOB :
+        value = va_arg(argp, const char*);
+        len = (type == CDBA_TYPE_BLOB ? va_arg(argp, size_t) : (value ? strlen(value) : 0));
+        if (!value) {
+          column->nulls[bulk->rows] = 1;
+        } else if (cdba_bulk_load_store_text(bulk, column, value, len) != 0) {
+          bulk->textlen = textlen;
+          return -1;
+        }
+        break;
+      default :
+        column->nulls[bulk->rows] = 1;
+        break;
+    }
+  }
+  if (++bulk->rows >= bulk->chunkrows)
+    return cdba_bulk_load_send(bulk);
+  return 0;
+}
+
+DLL_EXPORT_CDBALIB int cdba_bulk_load_append (cdba_bulk_handle bulk, ...)
+{
+  int status;
+  va_list argp;
+  va_start(argp, bulk);
+  status = cdba_bulk_load_append_va(bulk, argp);
+  va_end(argp);
+  return status;
+}
+
+DLL_EXPORT_CDBALIB void cdba_bulk_load_get_stats (cdba_bulk_handle bulk, cdba_bulk_stats* stats)
+{
+  *stats = bulk->stats;
+  stats->elapsed_us = cdba_get_time_us() - bulk->start;
+  stats->rows_per_second = (stats->elapsed_us > 0 ? (double)stats->rows * 1000000 / stats->elapsed_us : 0);
+}
+
+DLL_EXPORT_CDBALIB int cdba_bulk_load_finish (cdba_bulk_handle bulk, cdba_bulk_stats* stats)
+{
+  int status;
+  if (!bulk)
+    return -1;
+  status = cdba_bulk_load_send(bulk);
+  if (stats)
+    cdba_bulk_load_get_stats(bulk, stats);
+  cdba_bulk_load_free(bulk);
+  return status;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1625,6 +7386,26 @@ DLL_EXPORT_CDBALIB const char* cdba_get_version_string ()
   return CDBALIB_VERSION_STRING;
 }
 
+////////////////////////////////////////////////////////////////////////
+
+#ifdef CDBA_DRIVER
+#define CDBA_DRIVER_ENTRY(ret, name, params, handle, args) name,
+#define CDBA_DRIVER_ENTRY_VOID(name, params, handle, args) name,
+
+DLL_EXPORT_CDBA_DRIVER const struct cdba_driver_struct CDBA_DRIVER_TABLE = {
+  CDBA_DRIVER_NAME,
+  cdba_library_initialize,
+  cdba_library_cleanup,
+  cdba_library_get_name,
+  cdba_library_get_version,
+  cdba_library_thread_init,
+  cdba_library_thread_end,
+  cdba_open,
+  cdba_free,
+  CDBA_DRIVER_FUNCTIONS(CDBA_DRIVER_ENTRY, CDBA_DRIVER_ENTRY_VOID)
+};
+#endif
+
 
 
 /*
@@ -0,0 +1,841 @@
+#include "cdbaconfig.h"
+#include "cdbalib.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#if defined(DB_MYSQL)
+#ifdef _WIN32
+#include <mariadb/mysql.h>
+#else
+#include <mysql.h>
+#endif
+#elif defined(DB_SQLITE3)
+#include <sqlite3.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define BENCH_DEFAULT_OPS 10000
+#define BENCH_DEFAULT_ROWS 1000
+#define BENCH_TEXT_SIZE 64
+
+#define BENCH_TABLE "cdbalib_bench"
+#define BENCH_SQL_DROP "DROP TABLE IF EXISTS " BENCH_TABLE
+#define BENCH_SQL_CREATE "CREATE TABLE " BENCH_TABLE " (id INTEGER NOT NULL PRIMARY KEY, ival INTEGER, fval DOUBLE PRECISION, tval VARCHAR(64))"
+#define BENCH_SQL_INSERT "INSERT INTO " BENCH_TABLE " (id, ival, fval, tval) VALUES (?, ?, ?, ?)"
+#define BENCH_SQL_SELECT "SELECT id, ival, fval, tval FROM " BENCH_TABLE " WHERE id = ?"
+#define BENCH_SQL_SCAN "SELECT id, ival, fval, tval FROM " BENCH_TABLE " ORDER BY id"
+#define BENCH_SQL_UPDATE "UPDATE " BENCH_TABLE " SET ival = ival + 1 WHERE id = 1"
+#define BENCH_SQL_MULTIPLE "UPDATE " BENCH_TABLE " SET ival = ival + 1 WHERE id = 1; UPDATE " BENCH_TABLE " SET ival = ival - 1 WHERE id = 1; SELECT 1"
+
+////////////////////////////////////////////////////////////////////////
+
+//count allocations by replacing the C library allocation functions (only possible with glibc)
+#if defined(__GLIBC__)
+#define BENCH_COUNT_ALLOCATIONS
+extern void* __libc_malloc (size_t size);
+extern void* __libc_calloc (size_t nmemb, size_t size);
+extern void* __libc_realloc (void* ptr, size_t size);
+
+static uint64_t bench_allocations = 0;
+
+void* malloc (size_t size)
+{
+  bench_allocations++;
+  return __libc_malloc(size);
+}
+
+void* calloc (size_t nmemb, size_t size)
+{
+  bench_allocations++;
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc (void* ptr, size_t size)
+{
+  bench_allocations++;
+  return __libc_realloc(ptr, size);
+}
+#endif
+
+//get monotonic time in nanoseconds
+static uint64_t bench_get_time_ns ()
+{
+#ifdef _WIN32
+  static LARGE_INTEGER frequency = {0};
+  LARGE_INTEGER counter;
+  if (!frequency.QuadPart)
+    QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 + (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+struct bench_settings_struct {
+  char* file;
+  char* host;
+  db_int port;
+  char* login;
+  char* password;
+  char* database;
+};
+
+struct cdba_config_settings_mapping_struct bench_settings_mapping[] = {
+  {"file",     offsetof(struct bench_settings_struct, file),     cfg_txt},
+  {"host",     offsetof(struct bench_settings_struct, host),     cfg_txt},
+  {"port",     offsetof(struct bench_settings_struct, port),     cfg_int},
+  {"login",    offsetof(struct bench_settings_struct, login),    cfg_txt},
+  {"password", offsetof(struct bench_settings_struct, password), cfg_txt},
+  {"database", offsetof(struct bench_settings_struct, database), cfg_txt},
+  {NULL, 0, cfg_skip}
+};
+
+typedef struct bench_context_struct {
+  cdba_handle db;
+  cdba_prep_handle stmt;
+#if defined(DB_SQLITE3)
+  sqlite3* raw;
+  sqlite3_stmt* rawstmt;
+#elif defined(DB_MYSQL)
+  MYSQL* raw;
+  MYSQL_STMT* rawstmt;
+  MYSQL_BIND rawparams[4];
+  MYSQL_BIND rawresults[4];
+  long long rawid;
+  long long rawival;
+  double rawfval;
+  unsigned long rawtvallen;
+  long long rawresid;
+  long long rawresival;
+  double rawresfval;
+  char rawrestval[BENCH_TEXT_SIZE];
+  unsigned long rawrestvallen;
+#endif
+  size_t rows;
+  db_int nextid;
+  db_int checksum;                    //sum of values read, keeps column reads from being optimized away
+  char text[BENCH_TEXT_SIZE];
+} bench_context;
+
+typedef int (*bench_fn) (bench_context* ctx);
+typedef int (*bench_op_fn) (bench_context* ctx, size_t i);
+
+//deterministic values for the row with the specified id, the text value is stored in ctx->text
+static void bench_row_values (bench_context* ctx, db_int id, db_int* ival, db_flt* fval)
+{
+  *ival = (id * 7919) % 1000003;
+  *fval = (db_flt)id / 7;
+  snprintf(ctx->text, sizeof(ctx->text), "text value %" PRId64, (int64_t)id);
+}
+
+//deterministic pseudo-random existing id for the i-th lookup
+static db_int bench_select_id (bench_context* ctx, size_t i)
+{
+  return (db_int)((i * 7919) % ctx->rows) + 1;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static int bench_cdba_exec (bench_context* ctx, const char* sql)
+{
+  return cdba_sql(ctx->db, sql);
+}
+
+static int bench_cdba_close (bench_context* ctx)
+{
+  cdba_prep_close(ctx->stmt);
+  ctx->stmt = NULL;
+  return 0;
+}
+
+static int bench_cdba_prepare_op (bench_context* ctx, size_t i)
+{
+  cdba_prep_handle stmt;
+  (void)i;
+  if ((stmt = cdba_create_preparedstatement(ctx->db, BENCH_SQL_SELECT)) == NULL)
+    return -1;
+  cdba_prep_close(stmt);
+  return 0;
+}
+
+static int bench_cdba_insert_setup (bench_context* ctx)
+{
+  return ((ctx->stmt = cdba_create_preparedstatement(ctx->db, BENCH_SQL_INSERT)) == NULL ? -1 : 0);
+}
+
+static int bench_cdba_insert_op (bench_context* ctx, size_t i)
+{
+  db_int id = ctx->nextid++;
+  db_int ival;
+  db_flt fval;
+  (void)i;
+  bench_row_values(ctx, id, &ival, &fval);
+  if (cdba_prep_execute(ctx->stmt, CDBA_TYPE_INT, id, CDBA_TYPE_INT, ival, CDBA_TYPE_FLOAT, fval, CDBA_TYPE_TEXT, ctx->text) != 0)
+    return -1;
+  cdba_prep_reset(ctx->stmt);
+  return 0;
+}
+
+static int bench_cdba_transaction_setup (bench_context* ctx)
+{
+  cdba_begin_transaction(ctx->db);
+  return bench_cdba_insert_setup(ctx);
+}
+
+static int bench_cdba_transaction_cleanup (bench_context* ctx)
+{
+  bench_cdba_close(ctx);
+  cdba_commit_transaction(ctx->db);
+  return 0;
+}
+
+static void bench_cdba_read_row (bench_context* ctx)
+{
+  char* text;
+  ctx->checksum += cdba_prep_get_column_int(ctx->stmt, 0) + cdba_prep_get_column_int(ctx->stmt, 1) + (db_int)cdba_prep_get_column_float(ctx->stmt, 2);
+  if ((text = cdba_prep_get_column_text(ctx->stmt, 3)) != NULL) {
+    ctx->checksum += strlen(text);
+    cdba_free(text);
+  }
+}
+
+static void bench_cdba_read_row_ref (bench_context* ctx)
+{
+  size_t len;
+  ctx->checksum += cdba_prep_get_column_int(ctx->stmt, 0) + cdba_prep_get_column_int(ctx->stmt, 1) + (db_int)cdba_prep_get_column_float(ctx->stmt, 2);
+  if (cdba_prep_get_column_text_ref(ctx->stmt, 3, &len))
+    ctx->checksum += len;
+}
+
+static int bench_cdba_select_setup (bench_context* ctx)
+{
+  return ((ctx->stmt = cdba_create_preparedstatement(ctx->db, BENCH_SQL_SELECT)) == NULL ? -1 : 0);
+}
+
+static int bench_cdba_select_op (bench_context* ctx, size_t i)
+{
+  if (cdba_prep_execute(ctx->stmt, CDBA_TYPE_INT, bench_select_id(ctx, i)) != 0 || cdba_prep_fetch_row(ctx->stmt) <= 0)
+    return -1;
+  bench_cdba_read_row(ctx);
+  cdba_prep_reset(ctx->stmt);
+  return 0;
+}
+
+static int bench_cdba_scan_setup (bench_context* ctx)
+{
+  return ((ctx->stmt = cdba_create_preparedstatement(ctx->db, BENCH_SQL_SCAN)) == NULL ? -1 : 0);
+}
+
+static int bench_cdba_scan_op (bench_context* ctx, size_t i)
+{
+  int status;
+  (void)i;
+  if (cdba_prep_execute(ctx->stmt) != 0)
+    return -1;
+  while ((status = cdba_prep_fetch_row(ctx->stmt)) > 0)
+    bench_cdba_read_row(ctx);
+  cdba_prep_reset(ctx->stmt);
+  return status;
+}
+
+static int bench_cdba_scan_ref_op (bench_context* ctx, size_t i)
+{
+  int status;
+  (void)i;
+  if (cdba_prep_execute(ctx->stmt) != 0)
+    return -1;
+  while ((status = cdba_prep_fetch_row(ctx->stmt)) > 0)
+    bench_cdba_read_row_ref(ctx);
+  cdba_prep_reset(ctx->stmt);
+  return status;
+}
+
+static int bench_cdba_multiple_sql_op (bench_context* ctx, size_t i)
+{
+  (void)i;
+  return cdba_multiple_sql(ctx->db, BENCH_SQL_MULTIPLE);
+}
+
+static int bench_cdba_sql_op (bench_context* ctx, size_t i)
+{
+  (void)i;
+  return cdba_sql(ctx->db, BENCH_SQL_UPDATE);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#if defined(DB_SQLITE3)
+#define BENCH_RAW_API "SQLite3 C API"
+
+static int bench_raw_connect (bench_context* ctx, struct bench_settings_struct* settings)
+{
+  if (sqlite3_open_v2(settings->file, &ctx->raw, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK) {
+    sqlite3_close(ctx->raw);
+    ctx->raw = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+static void bench_raw_disconnect (bench_context* ctx)
+{
+  sqlite3_close(ctx->raw);
+}
+
+static int bench_raw_exec (bench_context* ctx, const char* sql)
+{
+  return (sqlite3_exec(ctx->raw, sql, NULL, NULL, NULL) == SQLITE_OK ? 0 : -1);
+}
+
+static int bench_raw_close (bench_context* ctx)
+{
+  sqlite3_finalize(ctx->rawstmt);
+  ctx->rawstmt = NULL;
+  return 0;
+}
+
+static int bench_raw_prepare (bench_context* ctx, const char* sql)
+{
+  return (sqlite3_prepare_v2(ctx->raw, sql, -1, &ctx->rawstmt, NULL) == SQLITE_OK ? 0 : -1);
+}
+
+static int bench_raw_prepare_op (bench_context* ctx, size_t i)
+{
+  sqlite3_stmt* stmt;
+  (void)i;
+  if (sqlite3_prepare_v2(ctx->raw, BENCH_SQL_SELECT, -1, &stmt, NULL) != SQLITE_OK)
+    return -1;
+  sqlite3_finalize(stmt);
+  return 0;
+}
+
+static int bench_raw_insert_setup (bench_context* ctx)
+{
+  return bench_raw_prepare(ctx, BENCH_SQL_INSERT);
+}
+
+static int bench_raw_insert_op (bench_context* ctx, size_t i)
+{
+  int status;
+  db_int id = ctx->nextid++;
+  db_int ival;
+  db_flt fval;
+  (void)i;
+  bench_row_values(ctx, id, &ival, &fval);
+  sqlite3_bind_int64(ctx->rawstmt, 1, id);
+  sqlite3_bind_int64(ctx->rawstmt, 2, ival);
+  sqlite3_bind_double(ctx->rawstmt, 3, fval);
+  sqlite3_bind_text(ctx->rawstmt, 4, ctx->text, -1, SQLITE_STATIC);
+  status = sqlite3_step(ctx->rawstmt);
+  sqlite3_reset(ctx->rawstmt);
+  return (status == SQLITE_DONE ? 0 : -1);
+}
+
+static void bench_raw_read_row (bench_context* ctx)
+{
+  ctx->checksum += sqlite3_column_int64(ctx->rawstmt, 0) + sqlite3_column_int64(ctx->rawstmt, 1) + (db_int)sqlite3_column_double(ctx->rawstmt, 2);
+  if (sqlite3_column_text(ctx->rawstmt, 3))
+    ctx->checksum += sqlite3_column_bytes(ctx->rawstmt, 3);
+}
+
+static int bench_raw_select_setup (bench_context* ctx)
+{
+  return bench_raw_prepare(ctx, BENCH_SQL_SELECT);
+}
+
+static int bench_raw_select_op (bench_context* ctx, size_t i)
+{
+  int status;
+  sqlite3_bind_int64(ctx->rawstmt, 1, bench_select_id(ctx, i));
+  if ((status = sqlite3_step(ctx->rawstmt)) == SQLITE_ROW)
+    bench_raw_read_row(ctx);
+  sqlite3_reset(ctx->rawstmt);
+  return (status == SQLITE_ROW ? 0 : -1);
+}
+
+static int bench_raw_scan_setup (bench_context* ctx)
+{
+  return bench_raw_prepare(ctx, BENCH_SQL_SCAN);
+}
+
+static int bench_raw_scan_op (bench_context* ctx, size_t i)
+{
+  int status;
+  (void)i;
+  while ((status = sqlite3_step(ctx->rawstmt)) == SQLITE_ROW)
+    bench_raw_read_row(ctx);
+  sqlite3_reset(ctx->rawstmt);
+  return (status == SQLITE_DONE ? 0 : -1);
+}
+
+#elif defined(DB_MYSQL)
+#define BENCH_RAW_API "MySQL C API"
+
+static int bench_raw_connect (bench_context* ctx, struct bench_settings_struct* settings)
+{
+  if ((ctx->raw = mysql_init(NULL)) == NULL)
+    return -1;
+  if (mysql_real_connect(ctx->raw, settings->host, settings->login, settings->password, settings->database, settings->port, NULL, CLIENT_MULTI_STATEMENTS) == NULL) {
+    mysql_close(ctx->raw);
+    ctx->raw = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+static void bench_raw_disconnect (bench_context* ctx)
+{
+  mysql_close(ctx->raw);
+}
+
+static int bench_raw_exec (bench_context* ctx, const char* sql)
+{
+  int status;
+  MYSQL_RES* res;
+  if (mysql_real_query(ctx->raw, sql, strlen(sql)) != 0)
+    return -1;
+  //discard all results
+  do {
+    if ((res = mysql_store_result(ctx->raw)) != NULL)
+      mysql_free_result(res);
+  } while ((status = mysql_next_result(ctx->raw)) == 0);
+  return (status > 0 ? -1 : 0);
+}
+
+static int bench_raw_close (bench_context* ctx)
+{
+  mysql_stmt_close(ctx->rawstmt);
+  ctx->rawstmt = NULL;
+  return 0;
+}
+
+static int bench_raw_prepare (bench_context* ctx, const char* sql)
+{
+  if ((ctx->rawstmt = mysql_stmt_init(ctx->raw)) == NULL)
+    return -1;
+  if (mysql_stmt_prepare(ctx->rawstmt, sql, strlen(sql)) != 0) {
+    bench_raw_close(ctx);
+    return -1;
+  }
+  return 0;
+}
+
+static int bench_raw_prepare_op (bench_context* ctx, size_t i)
+{
+  MYSQL_STMT* stmt;
+  int status;
+  (void)i;
+  if ((stmt = mysql_stmt_init(ctx->raw)) == NULL)
+    return -1;
+  status = mysql_stmt_prepare(stmt, BENCH_SQL_SELECT, strlen(BENCH_SQL_SELECT));
+  mysql_stmt_close(stmt);
+  return (status == 0 ? 0 : -1);
+}
+
+static int bench_raw_insert_setup (bench_context* ctx)
+{
+  if (bench_raw_prepare(ctx, BENCH_SQL_INSERT) != 0)
+    return -1;
+  memset(ctx->rawparams, 0, sizeof(ctx->rawparams));
+  ctx->rawparams[0].buffer_type = MYSQL_TYPE_LONGLONG;
+  ctx->rawparams[0].buffer = &ctx->rawid;
+  ctx->rawparams[1].buffer_type = MYSQL_TYPE_LONGLONG;
+  ctx->rawparams[1].buffer = &ctx->rawival;
+  ctx->rawparams[2].buffer_type = MYSQL_TYPE_DOUBLE;
+  ctx->rawparams[2].buffer = &ctx->rawfval;
+  ctx->rawparams[3].buffer_type = MYSQL_TYPE_STRING;
+  ctx->rawparams[3].buffer = ctx->text;
+  ctx->rawparams[3].length = &ctx->rawtvallen;
+  return (mysql_stmt_bind_param(ctx->rawstmt, ctx->rawparams) ? -1 : 0);
+}
+
+static int bench_raw_insert_op (bench_context* ctx, size_t i)
+{
+  db_int ival;
+  db_flt fval;
+  (void)i;
+  ctx->rawid = ctx->nextid++;
+  bench_row_values(ctx, ctx->rawid, &ival, &fval);
+  ctx->rawival = ival;
+  ctx->rawfval = fval;
+  ctx->rawtvallen = strlen(ctx->text);
+  return (mysql_stmt_execute(ctx->rawstmt) == 0 ? 0 : -1);
+}
+
+static int bench_raw_bind_result (bench_context* ctx)
+{
+  memset(ctx->rawresults, 0, sizeof(ctx->rawresults));
+  ctx->rawresults[0].buffer_type = MYSQL_TYPE_LONGLONG;
+  ctx->rawresults[0].buffer = &ctx->rawresid;
+  ctx->rawresults[1].buffer_type = MYSQL_TYPE_LONGLONG;
+  ctx->rawresults[1].buffer = &ctx->rawresival;
+  ctx->rawresults[2].buffer_type = MYSQL_TYPE_DOUBLE;
+  ctx->rawresults[2].buffer = &ctx->rawresfval;
+  ctx->rawresults[3].buffer_type = MYSQL_TYPE_STRING;
+  ctx->rawresults[3].buffer = ctx->rawrestval;
+  ctx->rawresults[3].buffer_length = sizeof(ctx->rawrestval);
+  ctx->rawresults[3].length = &ctx->rawrestvallen;
+  return (mysql_stmt_bind_result(ctx->rawstmt, ctx->rawresults) ? -1 : 0);
+}
+
+static void bench_raw_read_row (bench_context* ctx)
+{
+  ctx->checksum += ctx->rawresid + ctx->rawresival + (db_int)ctx->rawresfval + ctx->rawrestvallen;
+}
+
+static int bench_raw_select_setup (bench_context* ctx)
+{
+  if (bench_raw_prepare(ctx, BENCH_SQL_SELECT) != 0)
+    return -1;
+  memset(ctx->rawparams, 0, sizeof(ctx->rawparams));
+  ctx->rawparams[0].buffer_type = MYSQL_TYPE_LONGLONG;
+  ctx->rawparams[0].buffer = &ctx->rawid;
+  if (mysql_stmt_bind_param(ctx->rawstmt, ctx->rawparams))
+    return -1;
+  return bench_raw_bind_result(ctx);
+}
+
+static int bench_raw_select_op (bench_context* ctx, size_t i)
+{
+  int status;
+  ctx->rawid = bench_select_id(ctx, i);
+  if (mysql_stmt_execute(ctx->rawstmt) != 0)
+    return -1;
+  if ((status = mysql_stmt_fetch(ctx->rawstmt)) == 0 || status == MYSQL_DATA_TRUNCATED)
+    bench_raw_read_row(ctx);
+  mysql_stmt_free_result(ctx->rawstmt);
+  return (status == 0 || status == MYSQL_DATA_TRUNCATED ? 0 : -1);
+}
+
+static int bench_raw_scan_setup (bench_context* ctx)
+{
+  if (bench_raw_prepare(ctx, BENCH_SQL_SCAN) != 0)
+    return -1;
+  return bench_raw_bind_result(ctx);
+}
+
+static int bench_raw_scan_op (bench_context* ctx, size_t i)
+{
+  int status;
+  (void)i;
+  if (mysql_stmt_execute(ctx->rawstmt) != 0)
+    return -1;
+  while ((status = mysql_stmt_fetch(ctx->rawstmt)) == 0 || status == MYSQL_DATA_TRUNCATED)
+    bench_raw_read_row(ctx);
+  mysql_stmt_free_result(ctx->rawstmt);
+  return (status == MYSQL_NO_DATA ? 0 : -1);
+}
+#endif
+
+#if defined(DB_SQLITE3) || defined(DB_MYSQL)
+#define BENCH_RAW(setup, op, cleanup) {setup, op, cleanup}
+
+static int bench_raw_transaction_setup (bench_context* ctx)
+{
+  if (bench_raw_exec(ctx, "BEGIN") != 0)
+    return -1;
+  return bench_raw_insert_setup(ctx);
+}
+
+static int bench_raw_transaction_cleanup (bench_context* ctx)
+{
+  bench_raw_close(ctx);
+  return bench_raw_exec(ctx, "COMMIT");
+}
+
+static int bench_raw_multiple_sql_op (bench_context* ctx, size_t i)
+{
+  (void)i;
+  return bench_raw_exec(ctx, BENCH_SQL_MULTIPLE);
+}
+
+static int bench_raw_sql_op (bench_context* ctx, size_t i)
+{
+  (void)i;
+  return bench_raw_exec(ctx, BENCH_SQL_UPDATE);
+}
+#else
+#define BENCH_RAW(setup, op, cleanup) {NULL, NULL, NULL}
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+struct bench_impl_struct {
+  bench_fn setup;
+  bench_op_fn op;
+  bench_fn cleanup;
+};
+
+struct bench_api_struct {
+  const char* name;
+  int (*exec) (bench_context* ctx, const char* sql);
+  struct bench_impl_struct fill;      //used to fill the table before each benchmark
+};
+
+struct bench_definition_struct {
+  const char* name;
+  size_t divisor;                     //run only 1/divisor of the operations (for operations that process all rows)
+  struct bench_impl_struct cdba;
+  struct bench_impl_struct raw;
+};
+
+static const struct bench_api_struct bench_cdba_api = {"cdbalib", bench_cdba_exec, {bench_cdba_transaction_setup, bench_cdba_insert_op, bench_cdba_transaction_cleanup}};
+#if defined(DB_SQLITE3) || defined(DB_MYSQL)
+static const struct bench_api_struct bench_raw_api = {"raw", bench_raw_exec, {bench_raw_transaction_setup, bench_raw_insert_op, bench_raw_transaction_cleanup}};
+#endif
+
+static const struct bench_definition_struct bench_definitions[] = {
+  {"prepare",      1,   {NULL, bench_cdba_prepare_op, NULL},                                                  BENCH_RAW(NULL, bench_raw_prepare_op, NULL)},
+  {"insert",       1,   {bench_cdba_insert_setup, bench_cdba_insert_op, bench_cdba_close},                    BENCH_RAW(bench_raw_insert_setup, bench_raw_insert_op, bench_raw_close)},
+  {"insert_txn",   1,   {bench_cdba_transaction_setup, bench_cdba_insert_op, bench_cdba_transaction_cleanup}, BENCH_RAW(bench_raw_transaction_setup, bench_raw_insert_op, bench_raw_transaction_cleanup)},
+  {"select",       1,   {bench_cdba_select_setup, bench_cdba_select_op, bench_cdba_close},                    BENCH_RAW(bench_raw_select_setup, bench_raw_select_op, bench_raw_close)},
+  {"scan",         100, {bench_cdba_scan_setup, bench_cdba_scan_op, bench_cdba_close},                        BENCH_RAW(bench_raw_scan_setup, bench_raw_scan_op, bench_raw_close)},
+  {"scan_ref",     100, {bench_cdba_scan_setup, bench_cdba_scan_ref_op, bench_cdba_close},                    BENCH_RAW(bench_raw_scan_setup, bench_raw_scan_op, bench_raw_close)},
+  {"multiple_sql", 1,   {NULL, bench_cdba_multiple_sql_op, NULL},                                             BENCH_RAW(NULL, bench_raw_multiple_sql_op, NULL)},
+  {"sql",          1,   {NULL, bench_cdba_sql_op, NULL},                                                      BENCH_RAW(NULL, bench_raw_sql_op, NULL)},
+  {NULL, 0, {NULL, NULL, NULL}, {NULL, NULL, NULL}}
+};
+
+struct bench_result_struct {
+  size_t ops;
+  uint64_t total_ns;
+  uint64_t p50_ns;
+  uint64_t p99_ns;
+  double allocs_per_op;               //negative if allocations can't be counted
+};
+
+static int bench_compare_latency (const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*)a;
+  uint64_t y = *(const uint64_t*)b;
+  return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+//recreate and fill the table
+static int bench_reset_table (bench_context* ctx, const struct bench_api_struct* api)
+{
+  size_t i;
+  int status = 0;
+  if (api->exec(ctx, BENCH_SQL_DROP) != 0 || api->exec(ctx, BENCH_SQL_CREATE) != 0)
+    return -1;
+  ctx->nextid = 1;
+  if (api->fill.setup(ctx) != 0)
+    return -1;
+  for (i = 0; i < ctx->rows && status == 0; i++)
+    status = api->fill.op(ctx, i);
+  if (api->fill.cleanup(ctx) != 0)
+    return -1;
+  return status;
+}
+
+//run operations with a warm-up of 10% that is not measured
+static int bench_run (bench_context* ctx, const struct bench_api_struct* api, const struct bench_impl_struct* impl, size_t ops, uint64_t* latencies, struct bench_result_struct* result)
+{
+  size_t i;
+  size_t warmup;
+  uint64_t start;
+  uint64_t end;
+#ifdef BENCH_COUNT_ALLOCATIONS
+  uint64_t allocations;
+#endif
+  if (bench_reset_table(ctx, api) != 0)
+    return -1;
+  if (impl->setup && impl->setup(ctx) != 0)
+    return -1;
+  warmup = ops / 10;
+  for (i = 0; i < warmup; i++) {
+    if (impl->op(ctx, i) != 0) {
+      if (impl->cleanup)
+        impl->cleanup(ctx);
+      return -1;
+    }
+  }
+#ifdef BENCH_COUNT_ALLOCATIONS
+  allocations = bench_allocations;
+#endif
+  result->total_ns = 0;
+  for (i = 0; i < ops; i++) {
+    start = bench_get_time_ns();
+    if (impl->op(ctx, warmup + i) != 0) {
+      if (impl->cleanup)
+        impl->cleanup(ctx);
+      return -1;
+    }
+    end = bench_get_time_ns();
+    latencies[i] = end - start;
+    result->total_ns += latencies[i];
+  }
+#ifdef BENCH_COUNT_ALLOCATIONS
+  result->allocs_per_op = (double)(bench_allocations - allocations) / ops;
+#else
+  result->allocs_per_op = -1;
+#endif
+  if (impl->cleanup && impl->cleanup(ctx) != 0)
+    return -1;
+  qsort(latencies, ops, sizeof(uint64_t), bench_compare_latency);
+  result->ops = ops;
+  result->p50_ns = latencies[(ops - 1) * 50 / 100];
+  result->p99_ns = latencies[(ops - 1) * 99 / 100];
+  return 0;
+}
+
+static void bench_print_result (const char* name, const char* apiname, const struct bench_result_struct* result, const struct bench_result_struct* baseline)
+{
+  char allocs[16];
+  char overhead[16];
+  if (result->allocs_per_op < 0)
+    strcpy(allocs, "n/a");
+  else
+    snprintf(allocs, sizeof(allocs), "%.2f", result->allocs_per_op);
+  if (baseline && baseline->p50_ns)
+    snprintf(overhead, sizeof(overhead), "%+.1f%%", ((double)result->p50_ns / baseline->p50_ns - 1) * 100);
+  else
+    strcpy(overhead, "-");
+  printf("%-14s %-8s %8lu %12.1f %10.2f %10.2f %10s %9s\n", name, apiname, (unsigned long)result->ops, (result->total_ns ? (double)result->ops * 1000000000 / result->total_ns : 0), (double)result->p50_ns / 1000, (double)result->p99_ns / 1000, allocs, overhead);
+}
+
+static void show_help ()
+{
+  printf(
+    "Usage:  cdbalib_bench [-h] [-n ops] [-r rows] [config]\n"
+    "Parameters:\n"
+    "  -h           \tdisplay command line help\n"
+    "  -n ops       \tnumber of measured operations per benchmark (default: %i)\n"
+    "  -r rows      \tnumber of rows in the benchmark table (default: %i)\n"
+    "  config       \tdatabase settings as passed to cdba_open()"
+#if defined(DB_SQLITE3)
+    " (default: file=:memory:)"
+#endif
+    "\n"
+    "Description:\n"
+    "Runs reproducible microbenchmarks through CDBALIB and through the native driver API and reports operations per second, median and 99th percentile latency, allocations per operation and the overhead of CDBALIB compared to the native API.\n"
+    "Note: the benchmark table " BENCH_TABLE " is dropped and recreated.\n"
+    "Version: " CDBALIB_VERSION_STRING "\n"
+    "\n", BENCH_DEFAULT_OPS, BENCH_DEFAULT_ROWS);
+}
+
+int main (int argc, char *argv[])
+{
+  int i;
+  size_t ops = BENCH_DEFAULT_OPS;
+  size_t n;
+  const char* config = NULL;
+  struct bench_settings_struct settings = {NULL, NULL, 0, NULL, NULL, NULL};
+  const struct bench_definition_struct* bench;
+  struct bench_result_struct cdbaresult;
+  struct bench_result_struct rawresult;
+  int hasraw;
+  uint64_t* latencies;
+  cdba_library_handle dblib;
+  bench_context ctx;
+  char* s;
+  int status = 0;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.rows = BENCH_DEFAULT_ROWS;
+  //process command line parameters
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-h") == 0) {
+      show_help();
+      return 0;
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      ops = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      ctx.rows = strtoul(argv[++i], NULL, 10);
+    } else if (!config) {
+      config = argv[i];
+    } else {
+      fprintf(stderr, "Invalid command line parameter: %s\n", argv[i]);
+      return 1;
+    }
+  }
+#if defined(DB_SQLITE3)
+  if (!config)
+    config = "file=:memory:";
+#endif
+  if (!config || ops < 1 || ctx.rows < 1) {
+    show_help();
+    return 1;
+  }
+  if (cdba_config_parse(&settings, config, bench_settings_mapping) != NULL) {
+    fprintf(stderr, "Invalid database settings: %s\n", config);
+    return 1;
+  }
+  if ((latencies = (uint64_t*)malloc(ops * sizeof(uint64_t))) == NULL) {
+    fprintf(stderr, "Memory allocation error\n");
+    return 1;
+  }
+
+  //open database connections
+  if ((dblib = cdba_library_initialize()) == NULL) {
+    fprintf(stderr, "Error initializing database\n");
+    return 1;
+  }
+  if ((ctx.db = cdba_open(dblib, config)) == NULL) {
+    fprintf(stderr, "Error opening %s database\n", cdba_library_get_name(dblib));
+    return 1;
+  }
+#if defined(DB_SQLITE3) || defined(DB_MYSQL)
+  if (bench_raw_connect(&ctx, &settings) != 0) {
+    fprintf(stderr, "Error opening %s database with " BENCH_RAW_API "\n", cdba_library_get_name(dblib));
+    return 1;
+  }
+#endif
+  s = cdba_library_get_version(dblib);
+  printf("cdbalib %s, %s %s, %lu operations, %lu rows, settings: %s\n", cdba_get_version_string(), cdba_library_get_name(dblib), (s ? s : "(unknown)"), (unsigned long)ops, (unsigned long)ctx.rows, config);
+  cdba_free(s);
+  printf("%-14s %-8s %8s %12s %10s %10s %10s %9s\n", "benchmark", "api", "ops", "ops/s", "p50 us", "p99 us", "allocs/op", "overhead");
+
+  //run benchmarks, native API first so CDBALIB can be compared against it
+  for (bench = bench_definitions; bench->name; bench++) {
+    if ((n = ops / bench->divisor) < 1)
+      n = 1;
+    hasraw = 0;
+#if defined(DB_SQLITE3) || defined(DB_MYSQL)
+    if (bench->raw.op) {
+      if (bench_run(&ctx, &bench_raw_api, &bench->raw, n, latencies, &rawresult) != 0) {
+        fprintf(stderr, "Error running benchmark %s with " BENCH_RAW_API "\n", bench->name);
+        status = 2;
+        continue;
+      }
+      hasraw = 1;
+    }
+#endif
+    if (bench_run(&ctx, &bench_cdba_api, &bench->cdba, n, latencies, &cdbaresult) != 0) {
+      fprintf(stderr, "Error running benchmark %s: %s\n", bench->name, (ctx.stmt && cdba_prep_get_error(ctx.stmt) ? cdba_prep_get_error(ctx.stmt) : cdba_get_error(ctx.db)));
+      status = 2;
+      continue;
+    }
+    bench_print_result(bench->name, bench_cdba_api.name, &cdbaresult, (hasraw ? &rawresult : NULL));
+    if (hasraw)
+      bench_print_result(bench->name, "raw", &rawresult, NULL);
+  }
+  //checksum of all values read, differs when rows are not read back as expected
+  printf("checksum: %" PRId64 "\n", (int64_t)ctx.checksum);
+
+  //clean up
+  bench_cdba_exec(&ctx, BENCH_SQL_DROP);
+#if defined(DB_SQLITE3) || defined(DB_MYSQL)
+  bench_raw_disconnect(&ctx);
+#endif
+  cdba_close(ctx.db);
+  cdba_library_cleanup(dblib);
+  free(latencies);
+  free(settings.file);
+  free(settings.host);
+  free(settings.login);
+  free(settings.password);
+  free(settings.database);
+  return status;
+}
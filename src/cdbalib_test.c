@@ -33,6 +33,15 @@ void print_row (cdba_prep_handle stmt, int cols)
           }
         }
         break;
+      case CDBA_TYPE_BLOB :
+        {
+          size_t len;
+          if (!cdba_prep_get_column_blob(stmt, i, &len))
+            printf("NULL");
+          else
+            printf("(%lu bytes)", (unsigned long)len);
+        }
+        break;
       case CDBA_TYPE_NULL :
         printf("NULL");
       default :
@@ -42,11 +51,32 @@ void print_row (cdba_prep_handle stmt, int cols)
   printf("\n");
 }
 
+int count_rows (cdba_row row, void* callbackdata)
+{
+  (void)row;
+  (void)callbackdata;
+  return 0;
+}
+
+void check_rows (cdba_handle db, const char* sql, int expected, const char* description)
+{
+  int rows = cdba_query_foreach(db, sql, count_rows, NULL);
+  if (rows != expected)
+    fprintf(stderr, "Result cache error (%s): %s returned %i rows instead of %i\n", description, sql, rows, expected);
+}
+
+void run_sql (cdba_handle db, const char* sql)
+{
+  if (cdba_sql(db, sql) != 0)
+    fprintf(stderr, "Error executing query: %s\n", cdba_get_error(db));
+}
+
 int main (int argc, char *argv[], char *envp[])
 {
   cdba_library_handle dblib;
   cdba_handle db;
   cdba_prep_handle stmt;
+  cdba_result_cache_stats rescachestats;
   char* s;
 
   //show version
@@ -172,6 +202,45 @@ int main (int argc, char *argv[], char *envp[])
 
   cdba_prep_close(stmt);
 
+  //cached results must be removed when the tables they were read from are written
+  printf("[Result cache]\n");
+  run_sql(db, "DELETE FROM test1 WHERE intval > 4");
+  cdba_set_result_cache(db, 65536, 0);
+  run_sql(db, "CREATE VIEW test1view AS SELECT * FROM test1 WHERE intval > 0");
+  run_sql(db, "CREATE TABLE test2 (intval INTEGER)");
+#if defined(DB_SQLITE3)
+  run_sql(db, "CREATE TRIGGER test1insert AFTER INSERT ON test1 BEGIN INSERT INTO test2 (intval) VALUES (NEW.intval); END");
+#endif
+  check_rows(db, "SELECT intval FROM test1", 4, "cached");
+  check_rows(db, "SELECT intval FROM test1", 4, "cached");
+  cdba_get_result_cache_stats(db, &rescachestats);
+  if (rescachestats.hits != 1)
+    fprintf(stderr, "Result cache error: %lu hits instead of 1\n", (unsigned long)rescachestats.hits);
+  run_sql(db, "DELETE FROM test1 WHERE intval > 3");
+  check_rows(db, "SELECT intval FROM test1", 3, "DML");
+  run_sql(db, "INSERT INTO \"TEST1\" (intval) VALUES (6)");
+  check_rows(db, "SELECT intval FROM test1", 4, "quoted identifier");
+  run_sql(db, "WITH n (v) AS (SELECT 7) INSERT INTO test1 (intval) SELECT v FROM n");
+  check_rows(db, "SELECT intval FROM test1", 5, "CTE");
+  check_rows(db, "SELECT intval FROM test1view", 5, "view");
+  run_sql(db, "DELETE FROM test1 WHERE intval > 2");
+  check_rows(db, "SELECT intval FROM test1view", 2, "view");
+#if defined(DB_SQLITE3)
+  check_rows(db, "SELECT intval FROM test2", 2, "trigger");
+  run_sql(db, "INSERT INTO test1 (intval) VALUES (8)");
+  check_rows(db, "SELECT intval FROM test2", 3, "trigger");
+#else
+  run_sql(db, "INSERT INTO test1 (intval) VALUES (8)");
+#endif
+  cdba_begin_transaction(db);
+  run_sql(db, "INSERT INTO test1 (intval) VALUES (9)");
+  check_rows(db, "SELECT intval FROM test1", 4, "transaction");
+  cdba_rollback_transaction(db);
+  check_rows(db, "SELECT intval FROM test1", 3, "ROLLBACK");
+  cdba_set_result_cache(db, 0, 0);
+  run_sql(db, "DROP VIEW test1view");
+  run_sql(db, "DROP TABLE test2");
+
   if (cdba_sql(db, "DROP TABLE test1") != 0) {
     fprintf(stderr, "Error executing query: %s\n", cdba_get_error(db));
   }
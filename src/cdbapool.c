@@ -0,0 +1,382 @@
+#include "cdbapool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#define POOL_MUTEX CRITICAL_SECTION
+#define POOL_MUTEX_INIT(m) InitializeCriticalSection(m)
+#define POOL_MUTEX_DESTROY(m) DeleteCriticalSection(m)
+#define POOL_MUTEX_LOCK(m) EnterCriticalSection(m)
+#define POOL_MUTEX_UNLOCK(m) LeaveCriticalSection(m)
+#define POOL_COND CONDITION_VARIABLE
+#define POOL_COND_INIT(c) InitializeConditionVariable(c)
+#define POOL_COND_DESTROY(c)
+#define POOL_COND_SIGNAL(c) WakeConditionVariable(c)
+#else
+#define POOL_MUTEX pthread_mutex_t
+#define POOL_MUTEX_INIT(m) pthread_mutex_init(m, NULL)
+#define POOL_MUTEX_DESTROY(m) pthread_mutex_destroy(m)
+#define POOL_MUTEX_LOCK(m) pthread_mutex_lock(m)
+#define POOL_MUTEX_UNLOCK(m) pthread_mutex_unlock(m)
+#define POOL_COND pthread_cond_t
+#define POOL_COND_INIT(c) cdba_pool_cond_init(c)
+#define POOL_COND_DESTROY(c) pthread_cond_destroy(c)
+#define POOL_COND_SIGNAL(c) pthread_cond_signal(c)
+
+//initialize condition using the monotonic clock for timed waits, so they aren't affected by changes of the system time
+static void cdba_pool_cond_init (pthread_cond_t* cond)
+{
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+#endif
+
+//get monotonic time in microseconds
+static uint64_t cdba_pool_get_time_us ()
+{
+#ifdef _WIN32
+  return (uint64_t)GetTickCount64() * 1000;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+//wait for condition with timeout in milliseconds (negative to wait forever), returns non-zero on timeout
+static int cdba_pool_cond_wait (POOL_COND* cond, POOL_MUTEX* mutex, int64_t timeout_ms)
+{
+#ifdef _WIN32
+  if (!SleepConditionVariableCS(cond, mutex, (timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms)))
+    return (GetLastError() == ERROR_TIMEOUT ? 1 : 0);
+  return 0;
+#else
+  struct timespec ts;
+  if (timeout_ms < 0)
+    return (pthread_cond_wait(cond, mutex) == 0 ? 0 : 1);
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += timeout_ms / 1000;
+  ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+  return (pthread_cond_timedwait(cond, mutex, &ts) == ETIMEDOUT ? 1 : 0);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+struct cdba_pool_connection_struct {
+  cdba_handle db;
+  uint64_t idle_since;
+};
+
+struct cdba_pool_struct {
+  cdba_library_handle dblib;
+  char* configtext;
+  unsigned int minsize;
+  unsigned int maxsize;
+  uint64_t idle_timeout_us;
+  char* validation_sql;
+  uint64_t validation_idle_us;
+  POOL_MUTEX lock;
+  POOL_COND available;
+  struct cdba_pool_connection_struct* idle;   //stack of idle connections, the most recently used one is on top
+  unsigned int idlecount;
+  cdba_handle* busy;                          //connections that are checked out
+  unsigned int busycount;
+  unsigned int size;                          //number of connections, including those being opened
+  cdba_pool_stats stats;
+  cdba_stats dbstats;                         //execution statistics of connections, added when connections are returned
+};
+
+//add execution statistics of a connection to the pool totals and reset them (must be called with lock held)
+static void cdba_pool_collect_stats (cdba_pool pool, cdba_handle db)
+{
+  cdba_stats stats;
+  int i;
+  cdba_get_stats(db, &stats);
+  cdba_reset_stats(db);
+  pool->dbstats.prepares += stats.prepares;
+  pool->dbstats.executions += stats.executions;
+  pool->dbstats.rows_fetched += stats.rows_fetched;
+  pool->dbstats.rows_affected += stats.rows_affected;
+  pool->dbstats.errors += stats.errors;
+  pool->dbstats.busy_retries += stats.busy_retries;
+  pool->dbstats.execute_us += stats.execute_us;
+  if (stats.execute_max_us > pool->dbstats.execute_max_us)
+    pool->dbstats.execute_max_us = stats.execute_max_us;
+  pool->dbstats.fetch_us += stats.fetch_us;
+  if (stats.fetch_max_us > pool->dbstats.fetch_max_us)
+    pool->dbstats.fetch_max_us = stats.fetch_max_us;
+  for (i = 0; i < CDBA_STATS_HISTOGRAM_BUCKETS; i++)
+    pool->dbstats.histogram[i] += stats.histogram[i];
+}
+
+DLL_EXPORT_CDBALIB cdba_pool cdba_pool_create (cdba_library_handle dblib, const char* configtext, unsigned int minsize, unsigned int maxsize)
+{
+  struct cdba_pool_struct* pool;
+  cdba_handle db;
+  if (!dblib || maxsize == 0 || minsize > maxsize)
+    return NULL;
+  if ((pool = (struct cdba_pool_struct*)malloc(sizeof(struct cdba_pool_struct))) == NULL)
+    return NULL;
+  memset(pool, 0, sizeof(struct cdba_pool_struct));
+  pool->dblib = dblib;
+  pool->minsize = minsize;
+  pool->maxsize = maxsize;
+  if ((pool->configtext = strdup(configtext ? configtext : "")) == NULL || (pool->idle = (struct cdba_pool_connection_struct*)malloc(sizeof(struct cdba_pool_connection_struct) * maxsize)) == NULL || (pool->busy = (cdba_handle*)malloc(sizeof(cdba_handle) * maxsize)) == NULL) {
+    free(pool->idle);
+    free(pool->configtext);
+    free(pool);
+    return NULL;
+  }
+  POOL_MUTEX_INIT(&pool->lock);
+  POOL_COND_INIT(&pool->available);
+  //open minimum number of connections
+  while (pool->size < minsize) {
+    if ((db = cdba_open(dblib, pool->configtext)) == NULL) {
+      cdba_pool_destroy(pool);
+      return NULL;
+    }
+    pool->idle[pool->idlecount].db = db;
+    pool->idle[pool->idlecount].idle_since = cdba_pool_get_time_us();
+    pool->idlecount++;
+    pool->size++;
+    pool->stats.opened++;
+  }
+  return pool;
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_destroy (cdba_pool pool)
+{
+  if (!pool)
+    return;
+  while (pool->idlecount > 0)
+    cdba_close(pool->idle[--pool->idlecount].db);
+  //connections that weren't checked in are closed as well
+  while (pool->busycount > 0)
+    cdba_close(pool->busy[--pool->busycount]);
+  POOL_COND_DESTROY(&pool->available);
+  POOL_MUTEX_DESTROY(&pool->lock);
+  free(pool->validation_sql);
+  free(pool->configtext);
+  free(pool->idle);
+  free(pool->busy);
+  free(pool);
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_set_idle_timeout (cdba_pool pool, unsigned int idle_ms)
+{
+  POOL_MUTEX_LOCK(&pool->lock);
+  pool->idle_timeout_us = (uint64_t)idle_ms * 1000;
+  POOL_MUTEX_UNLOCK(&pool->lock);
+}
+
+DLL_EXPORT_CDBALIB int cdba_pool_set_validation (cdba_pool pool, const char* sql, unsigned int idle_ms)
+{
+  char* newsql = NULL;
+  if (sql && (newsql = strdup(sql)) == NULL)
+    return -1;
+  POOL_MUTEX_LOCK(&pool->lock);
+  free(pool->validation_sql);
+  pool->validation_sql = newsql;
+  pool->validation_idle_us = (uint64_t)idle_ms * 1000;
+  POOL_MUTEX_UNLOCK(&pool->lock);
+  return 0;
+}
+
+//remove the least recently used connection if it was idle for too long (must be called with lock held), returns the connection to be closed or NULL
+static cdba_handle cdba_pool_evict_idle (cdba_pool pool, uint64_t now)
+{
+  unsigned int i;
+  cdba_handle db;
+  if (pool->idle_timeout_us == 0 || pool->idlecount == 0 || pool->size <= pool->minsize)
+    return NULL;
+  //the least recently used connection is at the bottom of the stack
+  if (now - pool->idle[0].idle_since < pool->idle_timeout_us)
+    return NULL;
+  db = pool->idle[0].db;
+  for (i = 1; i < pool->idlecount; i++)
+    pool->idle[i - 1] = pool->idle[i];
+  pool->idlecount--;
+  pool->size--;
+  pool->stats.evicted++;
+  pool->stats.closed++;
+  return db;
+}
+
+//remove a connection from the list of checked out connections (must be called with lock held), returns non-zero if it wasn't checked out from this pool
+static int cdba_pool_remove_busy (cdba_pool pool, cdba_handle db)
+{
+  unsigned int i;
+  for (i = 0; i < pool->busycount; i++) {
+    if (pool->busy[i] == db) {
+      pool->busy[i] = pool->busy[--pool->busycount];
+      return 0;
+    }
+  }
+  return -1;
+}
+
+DLL_EXPORT_CDBALIB cdba_handle cdba_pool_checkout (cdba_pool pool, int timeout_ms)
+{
+  cdba_handle db = NULL;
+  cdba_handle evicted;
+  uint64_t start;
+  uint64_t now;
+  uint64_t idle_since;
+  uint64_t waited;
+  int64_t remaining;
+  int waiting = 0;
+  char* validation_sql;
+  if (!pool)
+    return NULL;
+  start = cdba_pool_get_time_us();
+  POOL_MUTEX_LOCK(&pool->lock);
+  while (!db) {
+    now = cdba_pool_get_time_us();
+    if ((evicted = cdba_pool_evict_idle(pool, now)) != NULL) {
+      //close connections without holding the lock
+      POOL_MUTEX_UNLOCK(&pool->lock);
+      cdba_close(evicted);
+      POOL_MUTEX_LOCK(&pool->lock);
+      continue;
+    }
+    if (pool->idlecount > 0) {
+      //reuse the most recently used idle connection
+      pool->idlecount--;
+      db = pool->idle[pool->idlecount].db;
+      idle_since = pool->idle[pool->idlecount].idle_since;
+      if (pool->validation_sql && now - idle_since >= pool->validation_idle_us) {
+        validation_sql = strdup(pool->validation_sql);
+        POOL_MUTEX_UNLOCK(&pool->lock);
+        if (!validation_sql || cdba_sql(db, validation_sql) != 0) {
+          POOL_MUTEX_LOCK(&pool->lock);
+          cdba_pool_collect_stats(pool, db);
+          POOL_MUTEX_UNLOCK(&pool->lock);
+          cdba_close(db);
+          db = NULL;
+        }
+        free(validation_sql);
+        POOL_MUTEX_LOCK(&pool->lock);
+        if (!db) {
+          pool->size--;
+          pool->stats.validation_failures++;
+          pool->stats.closed++;
+          continue;
+        }
+      }
+    } else if (pool->size < pool->maxsize) {
+      //reserve a place in the pool and open a new connection without holding the lock
+      pool->size++;
+      POOL_MUTEX_UNLOCK(&pool->lock);
+      db = cdba_open(pool->dblib, pool->configtext);
+      POOL_MUTEX_LOCK(&pool->lock);
+      if (!db) {
+        pool->size--;
+        POOL_COND_SIGNAL(&pool->available);
+        break;
+      }
+      pool->stats.opened++;
+    } else {
+      //wait for a connection to be checked in
+      remaining = -1;
+      if (timeout_ms >= 0) {
+        remaining = (int64_t)timeout_ms - (int64_t)((now - start) / 1000);
+        if (remaining <= 0) {
+          pool->stats.timeouts++;
+          break;
+        }
+      }
+      if (!waiting) {
+        waiting = 1;
+        pool->stats.waits++;
+      }
+      cdba_pool_cond_wait(&pool->available, &pool->lock, remaining);
+    }
+  }
+  if (db) {
+    pool->busy[pool->busycount++] = db;
+    pool->stats.checkouts++;
+    if (waiting) {
+      waited = cdba_pool_get_time_us() - start;
+      pool->stats.total_wait_us += waited;
+      if (waited > pool->stats.max_wait_us)
+        pool->stats.max_wait_us = waited;
+    }
+  }
+  POOL_MUTEX_UNLOCK(&pool->lock);
+  return db;
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_checkin (cdba_pool pool, cdba_handle db)
+{
+  if (!pool || !db)
+    return;
+  POOL_MUTEX_LOCK(&pool->lock);
+  //ignore connections that are not checked out from this pool, e.g. when checked in twice
+  if (cdba_pool_remove_busy(pool, db) != 0) {
+    POOL_MUTEX_UNLOCK(&pool->lock);
+    return;
+  }
+  cdba_pool_collect_stats(pool, db);
+  pool->idle[pool->idlecount].db = db;
+  pool->idle[pool->idlecount].idle_since = cdba_pool_get_time_us();
+  pool->idlecount++;
+  POOL_COND_SIGNAL(&pool->available);
+  POOL_MUTEX_UNLOCK(&pool->lock);
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_discard (cdba_pool pool, cdba_handle db)
+{
+  if (!pool || !db)
+    return;
+  POOL_MUTEX_LOCK(&pool->lock);
+  if (cdba_pool_remove_busy(pool, db) != 0) {
+    POOL_MUTEX_UNLOCK(&pool->lock);
+    return;
+  }
+  cdba_pool_collect_stats(pool, db);
+  POOL_MUTEX_UNLOCK(&pool->lock);
+  cdba_close(db);
+  POOL_MUTEX_LOCK(&pool->lock);
+  pool->size--;
+  pool->stats.closed++;
+  POOL_COND_SIGNAL(&pool->available);
+  POOL_MUTEX_UNLOCK(&pool->lock);
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_get_stats (cdba_pool pool, cdba_pool_stats* stats)
+{
+  if (!pool || !stats)
+    return;
+  POOL_MUTEX_LOCK(&pool->lock);
+  *stats = pool->stats;
+  stats->size = pool->size;
+  stats->idle = pool->idlecount;
+  POOL_MUTEX_UNLOCK(&pool->lock);
+}
+
+DLL_EXPORT_CDBALIB void cdba_pool_get_db_stats (cdba_pool pool, cdba_stats* stats)
+{
+  if (!pool || !stats)
+    return;
+  POOL_MUTEX_LOCK(&pool->lock);
+  *stats = pool->dbstats;
+  POOL_MUTEX_UNLOCK(&pool->lock);
+}